@@ -0,0 +1,129 @@
+// Gradiente de una formula con N variables: diferencias finitas centradas
+// (2N+1 pasadas completas por Tokenizer, Parser y Evaluator), modo directo
+// con DualEvaluator (N pasadas sobre la posfija) y modo inverso con
+// GradientEvaluator (un barrido del Tree). Termina con codigo 1 si los
+// modos directo e inverso no coinciden.
+#include "autodiff.hpp"
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const double kStep = 1e-6;
+
+std::string variable(std::size_t i) {
+    return "x" + std::to_string(i);
+}
+
+// Suma de terminos que acoplan cada variable con la siguiente.
+std::string formula(std::size_t n) {
+    std::string text;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::string a = variable(i);
+        std::string b = variable((i + 1) % n);
+        text += (i ? " + " : "") + std::string("sin(") + a + ") * " + b + " + " + a + "^2 / (1 + " + b + "^2)";
+    }
+    return text;
+}
+
+double evaluateText(const std::string& text, SymbolTable& symbols) {
+    Tokenizer tokenizer;
+    Parser parser;
+    return Evaluator().evalPostfix(parser.toPostfix(tokenizer.tokenize(text)), symbols);
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    for (std::size_t n = 1; n <= 64; n *= 2) {
+        std::string text = formula(n);
+        SymbolTable symbols;
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < n; ++i) {
+            names.push_back(variable(i));
+            symbols.set(names.back(), 0.3 + 0.1 * static_cast<double>(i));
+        }
+        Parser parser;
+        TokenList postfix = parser.toPostfix(Tokenizer().tokenize(text));
+        Tree tree = parser.buildTreeFromPostfix(postfix);
+
+        const std::size_t repetitions = 2000 / n + 1;
+        std::vector<double> finite(n), forward(n);
+        GradientEvaluator::Result reverse;
+
+        bench::Timer fdTimer;
+        for (std::size_t r = 0; r < repetitions; ++r) {
+            bench::keep(evaluateText(text, symbols));
+            for (std::size_t i = 0; i < n; ++i) {
+                double original = symbols.get(names[i]);
+                symbols.set(names[i], original + kStep);
+                double plus = evaluateText(text, symbols);
+                symbols.set(names[i], original - kStep);
+                double minus = evaluateText(text, symbols);
+                symbols.set(names[i], original);
+                finite[i] = (plus - minus) / (2.0 * kStep);
+            }
+        }
+        double fdSeconds = fdTimer.seconds();
+
+        DualEvaluator dual;
+        bench::Timer forwardTimer;
+        for (std::size_t r = 0; r < repetitions; ++r) {
+            for (std::size_t i = 0; i < n; ++i) {
+                forward[i] = dual.evalPostfix(postfix, symbols, names[i]).derivative;
+            }
+        }
+        double forwardSeconds = forwardTimer.seconds();
+
+        GradientEvaluator gradients;
+        bench::Timer reverseTimer;
+        for (std::size_t r = 0; r < repetitions; ++r) {
+            reverse = gradients.evaluate(tree, symbols, names);
+        }
+        double reverseSeconds = reverseTimer.seconds();
+
+        double worstModes = 0.0;
+        double worstFinite = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            double scale = 1.0 + std::fabs(reverse.partials[i]);
+            worstModes = std::max(worstModes, std::fabs(forward[i] - reverse.partials[i]) / scale);
+            worstFinite = std::max(worstFinite, std::fabs(finite[i] - reverse.partials[i]) / scale);
+        }
+        ok &= worstModes <= 1e-12 && worstFinite <= 1e-6;
+
+        std::cout << "N = " << n << std::scientific << std::setprecision(2) << " (directo vs inverso " << worstModes << ", dif. finitas vs inverso "
+                  << worstFinite << ")" << std::fixed << std::endl;
+        bench::report("  diferencias finitas", fdSeconds, repetitions);
+        bench::report("  modo directo (duales)", forwardSeconds, repetitions);
+        bench::report("  modo inverso (Tree)", reverseSeconds, repetitions);
+    }
+
+    // Una suma larga da un arbol tan profundo como terminos tiene: la cinta y
+    // las variables se arman sin recursion.
+    const std::size_t terms = 100000;
+    std::string deep = "x";
+    for (std::size_t i = 1; i < terms; ++i) {
+        deep += " + x";
+    }
+    Parser parser;
+    Tree tree = parser.buildTreeFromPostfix(parser.toPostfix(Tokenizer().tokenize(deep)));
+    SymbolTable symbols;
+    symbols.set("x", 0.5);
+    GradientEvaluator gradients;
+    std::vector<std::string> names = gradients.variablesOf(tree);
+    bool deepOk = names.size() == 1 && names[0] == "x" &&
+                  gradients.evaluate(tree, symbols, names).partials[0] == static_cast<double>(terms);
+    std::cout << (deepOk ? "ok    " : "FALLA ") << "gradiente de una suma de " << terms << " terminos" << std::endl;
+    ok &= deepOk;
+    return ok ? 0 : 1;
+}
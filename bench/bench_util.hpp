@@ -0,0 +1,44 @@
+#ifndef EDACAL_BENCH_UTIL_HPP
+#define EDACAL_BENCH_UTIL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace edacal {
+namespace bench {
+
+class Timer {
+public:
+    Timer() : start_(std::chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+        return elapsed.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Evita que el compilador descarte resultados que no se usan.
+template <typename T>
+inline void keep(const T& value) {
+    volatile T sink = value;
+    (void)sink;
+}
+
+inline void report(const std::string& label, double seconds, std::size_t operations) {
+    double nsPerOp = operations ? seconds * 1e9 / static_cast<double>(operations) : 0.0;
+    std::cout << std::left << std::setw(40) << label
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << seconds * 1e3 << " ms"
+              << std::setw(12) << nsPerOp << " ns/op" << std::endl;
+}
+
+} // namespace bench
+} // namespace edacal
+
+#endif
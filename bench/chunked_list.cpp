@@ -0,0 +1,171 @@
+// ChunkedList (bloques de varios elementos) frente a LinkedList (un nodo por
+// elemento): construccion, recorrido, copia y concatenacion, con tokens y
+// con doubles. Verifica contra un std::vector que push_front, pop_front,
+// splice_back y append conserven el orden.
+#include "bench_util.hpp"
+#include "chunked_list.hpp"
+#include "linked_list.hpp"
+#include "token.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kElements = 1 << 20;
+const std::size_t kRounds = 8;
+
+Token makeToken(std::size_t i) {
+    return i % 2 == 0 ? Token(TokenType::NUMBER, "", static_cast<double>(i)) : Token(TokenType::PLUS, "+");
+}
+
+double valueOf(const Token& token) { return token.value; }
+double valueOf(double value) { return value; }
+
+template <typename List, typename Make>
+void compare(const std::string& label, Make make) {
+    std::cout << label << " (" << kElements << " elementos)" << std::endl;
+    double sum = 0.0;
+    {
+        bench::Timer timer;
+        for (std::size_t round = 0; round < kRounds; ++round) {
+            List list;
+            for (std::size_t i = 0; i < kElements; ++i) {
+                list.push_back(make(i));
+            }
+            bench::keep(list.size());
+        }
+        bench::report("  construccion", timer.seconds(), kRounds * kElements);
+    }
+    List list;
+    for (std::size_t i = 0; i < kElements; ++i) {
+        list.push_back(make(i));
+    }
+    {
+        bench::Timer timer;
+        for (std::size_t round = 0; round < kRounds; ++round) {
+            for (auto it = list.cbegin(); it != list.cend(); ++it) {
+                sum += valueOf(*it);
+            }
+        }
+        bench::report("  recorrido", timer.seconds(), kRounds * kElements);
+    }
+    {
+        bench::Timer timer;
+        List copy = list;
+        bench::report("  copia", timer.seconds(), kElements);
+        bench::keep(copy.size());
+    }
+    bench::keep(sum);
+}
+
+template <typename List>
+bool sameSequence(const List& list, const std::vector<double>& expected) {
+    if (list.size() != expected.size()) {
+        return false;
+    }
+    std::size_t i = 0;
+    for (auto it = list.begin(); it != list.end(); ++it, ++i) {
+        if (*it != expected[i]) {
+            return false;
+        }
+    }
+    return i == expected.size();
+}
+
+bool checkOperations() {
+    bool ok = true;
+    ChunkedList<double, 4> list;
+    std::vector<double> expected;
+    for (int i = 0; i < 10; ++i) {
+        list.push_back(i);
+        expected.push_back(i);
+    }
+    for (int i = 1; i <= 6; ++i) {
+        list.push_front(-i);
+        expected.insert(expected.begin(), -i);
+    }
+    ok &= sameSequence(list, expected);
+    for (int i = 0; i < 7; ++i) {
+        ok &= list.front() == expected.front();
+        list.pop_front();
+        expected.erase(expected.begin());
+    }
+    ok &= sameSequence(list, expected);
+
+    ChunkedList<double, 4> other;
+    other.reserve(9);
+    for (int i = 100; i < 109; ++i) {
+        other.push_back(i);
+        expected.push_back(i);
+    }
+    list.splice_back(other);
+    ok &= other.empty() && other.begin() == other.end() && sameSequence(list, expected);
+    list.push_back(200);
+    expected.push_back(200);
+    ChunkedList<double, 4> tail;
+    tail.push_back(300);
+    expected.push_back(300);
+    list.append(std::move(tail));
+    ok &= sameSequence(list, expected);
+
+    ChunkedList<double, 4> copy = list;
+    list.clear();
+    ok &= list.empty() && sameSequence(copy, expected);
+    while (!copy.empty()) {
+        copy.pop_front();
+    }
+    copy.push_front(1);
+    ok &= copy.size() == 1 && copy.front() == 1;
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    compare<LinkedList<Token>>("tokens, LinkedList", makeToken);
+    compare<TokenList>("tokens, ChunkedList<Token, 16>", makeToken);
+    auto makeDouble = [](std::size_t i) { return static_cast<double>(i); };
+    compare<LinkedList<double>>("doubles, LinkedList", makeDouble);
+    compare<ChunkedList<double, 64>>("doubles, ChunkedList<double, 64>", makeDouble);
+
+    std::cout << "concatenar 1024 listas de 1024 tokens" << std::endl;
+    {
+        std::vector<LinkedList<Token>> parts(1024);
+        for (auto& part : parts) {
+            for (std::size_t i = 0; i < 1024; ++i) {
+                part.push_back(makeToken(i));
+            }
+        }
+        bench::Timer timer;
+        LinkedList<Token> all;
+        for (auto& part : parts) {
+            for (auto it = part.begin(); it != part.end(); ++it) {
+                all.push_back(std::move(*it));
+            }
+        }
+        bench::report("  LinkedList, push_back(&&) por elemento", timer.seconds(), parts.size());
+    }
+    {
+        std::vector<TokenList> parts(1024);
+        for (auto& part : parts) {
+            for (std::size_t i = 0; i < 1024; ++i) {
+                part.push_back(makeToken(i));
+            }
+        }
+        bench::Timer timer;
+        TokenList all;
+        for (auto& part : parts) {
+            all.append(std::move(part));
+        }
+        bench::report("  ChunkedList, append(&&)", timer.seconds(), parts.size());
+    }
+
+    bool ok = checkOperations();
+    std::cout << std::endl << (ok ? "ok    " : "FALLA ") << "orden tras push_front/pop_front/splice_back/append"
+              << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+// Derivadas simbolicas: nodos del grafo con hash-consing frente a nodos del
+// Tree expandido, incluidas derivadas de orden alto, y evaluaciones/s del
+// arbol derivado compilado a posfija frente al modo inverso sobre el arbol
+// original. Termina con codigo 1 si el valor no coincide con el de
+// GradientEvaluator.
+#include "autodiff.hpp"
+#include "bench_util.hpp"
+#include "derivative.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kEvaluations = 20000;
+
+std::size_t countNodes(const Tree::Node* node) {
+    return node ? 1 + countNodes(node->left) + countNodes(node->right) : 0;
+}
+
+std::string nested(const std::string& fn, std::size_t depth) {
+    std::string text = "x";
+    for (std::size_t i = 0; i < depth; ++i) {
+        text = fn + "(" + text + " + " + std::to_string(i + 1) + ")";
+    }
+    return text;
+}
+
+} // namespace
+
+int main() {
+    Tokenizer tokenizer;
+    Parser parser;
+    Optimizer optimizer;
+    Evaluator evaluator;
+    Differentiator differentiator;
+    GradientEvaluator gradients;
+    SymbolTable symbols;
+    symbols.set("x", 0.7);
+    symbols.set("y", 1.3);
+    bool ok = true;
+
+    std::vector<std::string> formulas = {
+        "x^3 * sin(x) / (1 + x^2)",
+        "x * sin(x) * exp(x) * sqrt(x) * log(x) * cos(x) * (x + y) ^ 2.5",
+        nested("sin", 8),
+        nested("sqrt", 8) + " * " + nested("exp", 2),
+    };
+
+    for (const std::string& text : formulas) {
+        std::cout << text << std::endl;
+        Tree tree = parser.buildTreeFromPostfix(parser.toPostfix(tokenizer.tokenize(text)));
+        std::cout << "  nodos originales: " << countNodes(tree.getRoot()) << std::endl;
+
+        Differentiator::Stats stats;
+        Tree derivative = differentiator.differentiate(tree, "x", stats);
+        std::cout << "  d/dx: grafo " << stats.graphNodes << " nodos, Tree " << stats.treeNodes << " nodos" << std::endl;
+
+        optimizer.lowerIntegerPowers(derivative);
+        TokenList compiled = optimizer.toPostfix(derivative);
+        double symbolic = evaluator.evalPostfix(compiled, symbols);
+        double reverse = gradients.evaluate(tree, symbols, std::vector<std::string>(1, "x")).partials[0];
+        bool match = std::fabs(symbolic - reverse) <= 1e-9 * (1.0 + std::fabs(reverse));
+        ok &= match;
+        std::cout << "  " << (match ? "ok    " : "FALLA ") << "simbolica = modo inverso" << std::endl;
+
+        {
+            bench::Timer timer;
+            double sum = 0.0;
+            for (std::size_t i = 0; i < kEvaluations; ++i) {
+                sum += evaluator.evalPostfix(compiled, symbols);
+            }
+            bench::keep(sum);
+            bench::report("  d/dx compilada (Evaluator)", timer.seconds(), kEvaluations);
+        }
+        {
+            std::vector<std::string> variables(1, "x");
+            bench::Timer timer;
+            double sum = 0.0;
+            for (std::size_t i = 0; i < kEvaluations; ++i) {
+                sum += gradients.evaluate(tree, symbols, variables).partials[0];
+            }
+            bench::keep(sum);
+            bench::report("  modo inverso sobre el original", timer.seconds(), kEvaluations);
+        }
+    }
+
+    std::cout << std::endl << "derivadas sucesivas de x^3 * sin(x) / (1 + x^2):" << std::endl;
+    Tree current = parser.buildTreeFromPostfix(parser.toPostfix(tokenizer.tokenize("x^3 * sin(x) / (1 + x^2)")));
+    for (int order = 1; order <= 6; ++order) {
+        Differentiator::Stats stats;
+        current = differentiator.differentiate(current, "x", stats);
+        std::cout << "  orden " << order << ": grafo " << stats.graphNodes << " nodos, Tree " << stats.treeNodes
+                  << " nodos" << std::endl;
+    }
+
+    // Una suma larga da un arbol (y una derivada) tan profundo como terminos
+    // tiene: el grafo, la derivada y la expansion no usan recursion.
+    const std::size_t terms = 50000;
+    std::string deep = "x * y";
+    for (std::size_t i = 1; i < terms; ++i) {
+        deep += " + x * y";
+    }
+    Tree deepTree = parser.buildTreeFromPostfix(parser.toPostfix(tokenizer.tokenize(deep)));
+    double deepValue = evaluator.evalPostfix(optimizer.toPostfix(differentiator.differentiate(deepTree, "x")), symbols);
+    double deepReverse = gradients.evaluate(deepTree, symbols, std::vector<std::string>(1, "x")).partials[0];
+    bool deepMatch = std::fabs(deepValue - deepReverse) <= 1e-9 * std::fabs(deepReverse);
+    ok &= deepMatch;
+    std::cout << std::endl << (deepMatch ? "ok    " : "FALLA ") << "d/dx de una suma de " << terms << " terminos"
+              << std::endl;
+
+    return ok ? 0 : 1;
+}
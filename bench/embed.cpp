@@ -0,0 +1,371 @@
+// libedacal dentro del proceso (API C de include/edacal.h) frente a hablarle
+// al binario por tuberias: un proceso EdaCal por evaluacion, o uno solo que
+// recibe `x = ...`, `y = ...` y la formula por la entrada estandar y
+// devuelve el texto `ans -> ...`. Dentro del proceso mide compilar una vez y
+// evaluar con variables ligadas, y compilar y evaluar cada vez. Verifica que
+// los resultados sean identicos bit a bit a Evaluator (y a los de la tuberia
+// hasta los 12 decimales que imprime el REPL), los errores estructurados y
+// que contextos en hilos distintos den lo mismo que en uno solo.
+// Uso: embed [evaluaciones] [ruta de EdaCal]
+#include "bench_util.hpp"
+#include "edacal.h"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace edacal;
+
+namespace {
+
+const char* const kFormula = "x * x + sin(y) - 1 / (z + 3)";
+const double kZ = 0.5;
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+std::string number(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return buffer;
+}
+
+// Valores de la evaluacion i, iguales en todos los caminos.
+double xAt(std::size_t i) {
+    return 0.5 + static_cast<double>(i % 1000) / 640.0;
+}
+
+double yAt(std::size_t i) {
+    return -1.0 + static_cast<double>(i % 777) / 300.0;
+}
+
+double reference(std::size_t i) {
+    SymbolTable symbols;
+    symbols.set("x", xAt(i));
+    symbols.set("y", yAt(i));
+    symbols.set("z", kZ);
+    return Evaluator().evalPostfix(Parser().toPostfix(Tokenizer().tokenize(kFormula)), symbols);
+}
+
+// El REPL imprime con 12 decimales.
+bool closeToPrinted(double printed, double exact) {
+    return std::fabs(printed - exact) <= 1e-12 + 1e-15 * std::fabs(exact);
+}
+
+struct Child {
+    pid_t pid;
+    int in;
+    int out;
+    std::string pending;
+};
+
+bool spawn(const std::string& path, Child& child) {
+    int toChild[2];
+    int fromChild[2];
+    if (::pipe(toChild) != 0 || ::pipe(fromChild) != 0) {
+        return false;
+    }
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::dup2(toChild[0], 0);
+        ::dup2(fromChild[1], 1);
+        ::close(toChild[0]);
+        ::close(toChild[1]);
+        ::close(fromChild[0]);
+        ::close(fromChild[1]);
+        ::execl(path.c_str(), path.c_str(), static_cast<char*>(nullptr));
+        ::_exit(127);
+    }
+    ::close(toChild[0]);
+    ::close(fromChild[1]);
+    child.pid = pid;
+    child.in = toChild[1];
+    child.out = fromChild[0];
+    child.pending.clear();
+    return pid > 0;
+}
+
+bool writeAll(int fd, const std::string& text) {
+    std::size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t n = ::write(fd, text.data() + sent, text.size() - sent);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Siguiente linea de la salida del hijo; false al llegar al final.
+bool readLine(Child& child, std::string& line) {
+    char buffer[4096];
+    for (;;) {
+        std::size_t newline = child.pending.find('\n');
+        if (newline != std::string::npos) {
+            line = child.pending.substr(0, newline);
+            child.pending.erase(0, newline + 1);
+            return true;
+        }
+        ssize_t n = ::read(child.out, buffer, sizeof(buffer));
+        if (n <= 0) {
+            return false;
+        }
+        child.pending.append(buffer, static_cast<std::size_t>(n));
+    }
+}
+
+void finish(Child& child) {
+    ::close(child.in);
+    ::close(child.out);
+    int status;
+    ::waitpid(child.pid, &status, 0);
+}
+
+// Numero despues del ultimo "-> " de una respuesta del REPL.
+bool parseAnswer(const std::string& line, double& value) {
+    std::size_t arrow = line.rfind("-> ");
+    if (arrow == std::string::npos) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtod(line.c_str() + arrow + 3, &end);
+    return end != line.c_str() + arrow + 3;
+}
+
+std::string request(std::size_t i) {
+    return "x = " + number(xAt(i)) + "\ny = " + number(yAt(i)) + "\n" + kFormula + "\n";
+}
+
+// Un proceso por evaluacion: arranque, script y lectura hasta el final.
+double perProcess(const std::string& path, std::size_t count, bool& ok) {
+    bench::Timer timer;
+    for (std::size_t i = 0; i < count; ++i) {
+        Child child;
+        if (!spawn(path, child)) {
+            ok = false;
+            return 0.0;
+        }
+        ok &= writeAll(child.in, "z = " + number(kZ) + "\n" + request(i));
+        ::close(child.in);
+        std::string line;
+        double value = 0.0;
+        bool answered = false;
+        while (readLine(child, line)) {
+            answered |= line.find("ans -> ") != std::string::npos && parseAnswer(line, value);
+        }
+        ::close(child.out);
+        int status;
+        ::waitpid(child.pid, &status, 0);
+        ok &= answered && closeToPrinted(value, reference(i));
+    }
+    return timer.seconds();
+}
+
+// Un solo proceso: cada evaluacion espera sus tres respuestas.
+double longLived(const std::string& path, std::size_t count, bool& ok) {
+    Child child;
+    if (!spawn(path, child)) {
+        ok = false;
+        return 0.0;
+    }
+    std::string line;
+    ok &= writeAll(child.in, "z = " + number(kZ) + "\n") && readLine(child, line) && readLine(child, line);
+    bench::Timer timer;
+    for (std::size_t i = 0; i < count && ok; ++i) {
+        ok &= writeAll(child.in, request(i));
+        double value = 0.0;
+        ok &= readLine(child, line) && readLine(child, line) && readLine(child, line) && parseAnswer(line, value);
+        ok &= closeToPrinted(value, reference(i));
+    }
+    double seconds = timer.seconds();
+    finish(child);
+    return seconds;
+}
+
+// Compila una vez y evalua `count` veces con x e y ligadas; suma los
+// resultados y cuenta los que difieren de Evaluator si `check`.
+double inProcess(std::size_t count, bool check, bool& ok, double& sum) {
+    edacal_context* context = edacal_context_new();
+    edacal_set(context, "z", kZ);
+    edacal_error error;
+    edacal_expr* expr = edacal_compile(context, kFormula, &error);
+    double x = 0.0;
+    double y = 0.0;
+    edacal_bind(expr, "x", &x);
+    edacal_bind(expr, "y", &y);
+    sum = 0.0;
+    bench::Timer timer;
+    for (std::size_t i = 0; i < count; ++i) {
+        x = xAt(i);
+        y = yAt(i);
+        double value = 0.0;
+        ok &= edacal_eval(expr, &value, nullptr) == EDACAL_OK;
+        sum += value;
+        if (check) {
+            ok &= sameBits(value, reference(i));
+        }
+    }
+    double seconds = timer.seconds();
+    edacal_expr_free(expr);
+    edacal_context_free(context);
+    return seconds;
+}
+
+// Como lo haria quien solo tiene el texto: compilar y evaluar cada vez.
+// Compara con Evaluator una de cada 1024 para no medir tambien a Evaluator.
+double recompiling(std::size_t count, bool& ok) {
+    edacal_context* context = edacal_context_new();
+    edacal_set(context, "z", kZ);
+    bench::Timer timer;
+    for (std::size_t i = 0; i < count; ++i) {
+        edacal_set(context, "x", xAt(i));
+        edacal_set(context, "y", yAt(i));
+        edacal_expr* expr = edacal_compile(context, kFormula, nullptr);
+        double value = 0.0;
+        ok &= expr && edacal_eval(expr, &value, nullptr) == EDACAL_OK && (i % 1024 || sameBits(value, reference(i)));
+        edacal_expr_free(expr);
+    }
+    double seconds = timer.seconds();
+    edacal_context_free(context);
+    return seconds;
+}
+
+// El mismo kind, columna y mensaje que Tokenizer/Parser/Evaluator.
+bool sameError(const edacal_error& actual, const Error& expected) {
+    std::string message = expected.message().substr(0, EDACAL_MESSAGE_SIZE - 1);
+    return actual.kind == static_cast<int>(expected.kind) && actual.column == expected.column &&
+           actual.length == expected.length && message == actual.message;
+}
+
+bool checkErrors() {
+    bool ok = true;
+    edacal_context* context = edacal_context_new();
+    edacal_set(context, "x", 3.0);
+    const std::string longName(200, 'v');
+    const char* const syntax[] = {"1 +", "(x * 2", "x = 1", "sqrt(1, 2)", "2 $ 3"};
+    for (const char* text : syntax) {
+        edacal_error error;
+        TokenList tokens;
+        TokenList postfix;
+        Error expected;
+        bool valid = Tokenizer().tokenize(text, tokens, expected) && Parser().toPostfix(tokens, postfix, expected);
+        ok &= !valid && edacal_compile(context, text, &error) == nullptr && sameError(error, expected);
+    }
+
+    const std::string texts[] = {"1 / (x - 3)", "sqrt(-x)", "nadie * 2", longName + " + 1", "select(x > 0, 1, 1 / (x - x))",
+                                 "sum(i, 1, 10, i * x)", "select(x > 2, x * 10, -1)"};
+    for (const std::string& text : texts) {
+        edacal_error error;
+        edacal_expr* expr = edacal_compile(context, text.c_str(), &error);
+        ok &= expr != nullptr && error.kind == EDACAL_OK;
+        double actual = 0.0;
+        edacal_error_kind kind = edacal_eval(expr, &actual, &error);
+        SymbolTable symbols;
+        symbols.set("x", 3.0);
+        double expected = 0.0;
+        Error expectedError;
+        bool expectedOk = Evaluator().evalPostfix(Parser().toPostfix(Tokenizer().tokenize(text)), symbols, expected,
+                                                  expectedError);
+        ok &= expectedOk ? kind == EDACAL_OK && sameBits(actual, expected)
+                         : kind == static_cast<int>(expectedError.kind) && sameError(error, expectedError);
+        edacal_expr_free(expr);
+    }
+
+    // Ligar una variable no definida la resuelve; desligarla vuelve al error.
+    edacal_expr* expr = edacal_compile(context, "nadie * x + sum(i, 1, 3, nadie)", nullptr);
+    double nadie = 0.25;
+    double value = 0.0;
+    ok &= edacal_eval(expr, &value, nullptr) == EDACAL_ERROR_UNDEFINED_VARIABLE;
+    edacal_bind(expr, "nadie", &nadie);
+    ok &= edacal_eval(expr, &value, nullptr) == EDACAL_OK && value == 0.25 * 3 + 0.75;
+    edacal_set(context, "x", 4.0);
+    ok &= edacal_eval(expr, &value, nullptr) == EDACAL_OK && value == 0.25 * 4 + 0.75;
+    edacal_bind(expr, "nadie", nullptr);
+    ok &= edacal_eval(expr, &value, nullptr) == EDACAL_ERROR_UNDEFINED_VARIABLE;
+    edacal_expr_free(expr);
+
+    // edacal_eval no toca `ans` ni el resto de la tabla.
+    double ans = 1.0;
+    ok &= edacal_get(context, "ans", &ans) == 1 && ans == 0.0 && edacal_get(context, "x", &value) == 1 && value == 4.0;
+    ok &= edacal_get(context, "otra", &value) == 0;
+    edacal_context_free(context);
+    return ok;
+}
+
+// Un contexto por hilo, sin sincronizar: la misma suma que en un solo hilo.
+bool checkThreads(std::size_t count, double expected) {
+    const std::size_t threads = 4;
+    std::vector<double> sums(threads, 0.0);
+    std::vector<char> results(threads, 0);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            bool ok = true;
+            inProcess(count, false, ok, sums[t]);
+            results[t] = ok;
+        }));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    bool ok = true;
+    for (std::size_t t = 0; t < threads; ++t) {
+        ok &= results[t] && sameBits(sums[t], expected);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t evaluations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::string path = argc > 2 ? argv[2] : "./EdaCal";
+    std::signal(SIGPIPE, SIG_IGN);
+    std::size_t piped = std::min<std::size_t>(evaluations, 20000);
+    std::size_t spawned = std::min<std::size_t>(evaluations, 100);
+    std::size_t recompiled = std::min<std::size_t>(evaluations, 200000);
+
+    std::cout << kFormula << std::endl;
+    bool pipes = true;
+    if (::access(path.c_str(), X_OK) == 0) {
+        bench::report("un proceso EdaCal por evaluacion", perProcess(path, spawned, pipes), spawned);
+        bench::report("un proceso EdaCal, por tuberia", longLived(path, piped, pipes), piped);
+    } else {
+        std::cout << "no se encontro " << path << ": se omiten las tuberias" << std::endl;
+    }
+    bool same = true;
+    double sum = 0.0;
+    bench::report("libedacal, compilar y evaluar", recompiling(recompiled, same), recompiled);
+    bench::report("libedacal, variables ligadas", inProcess(evaluations, false, same, sum), evaluations);
+    double checked = 0.0;
+    inProcess(evaluations, true, same, checked);
+    same &= sameBits(sum, checked);
+    std::cout << std::endl;
+
+    bool errors = checkErrors();
+    std::size_t threaded = std::min<std::size_t>(evaluations, 200000);
+    double expected = 0.0;
+    inProcess(threaded, false, same, expected);
+    bool threads = checkThreads(threaded, expected);
+    std::cout << (pipes ? "ok    " : "FALLA ") << "la tuberia da los mismos resultados (12 decimales)" << std::endl;
+    std::cout << (same ? "ok    " : "FALLA ") << "libedacal igual bit a bit a Evaluator" << std::endl;
+    std::cout << (errors ? "ok    " : "FALLA ") << "errores estructurados iguales a los de Tokenizer, Parser y Evaluator"
+              << std::endl;
+    std::cout << (threads ? "ok    " : "FALLA ") << "un contexto por hilo da lo mismo que un solo hilo" << std::endl;
+    return pipes && same && errors && threads ? 0 : 1;
+}
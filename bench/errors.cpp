@@ -0,0 +1,153 @@
+// Filas que fallan: la mitad de las filas de cada carga produce un error
+// (division por cero, dominio de sqrt/log, variable no definida, sintaxis).
+// Compara el camino con excepciones contra el de codigos de resultado y
+// verifica que ambos reporten el mismo mensaje en cada fila.
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kRows = 200000;
+
+struct Outcome {
+    std::size_t failures;
+    double sum;
+};
+
+Outcome evalWithExceptions(const std::vector<std::string>& lines, SymbolTable& symbols,
+                           std::vector<std::string>& messages) {
+    Tokenizer tokenizer;
+    Parser parser;
+    Evaluator evaluator;
+    Outcome outcome = {0, 0.0};
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        try {
+            outcome.sum += evaluator.evalPostfix(parser.toPostfix(tokenizer.tokenize(lines[i])), symbols);
+        } catch (const EdaError& err) {
+            ++outcome.failures;
+            messages[i] = err.what();
+        }
+    }
+    return outcome;
+}
+
+Outcome evalWithResults(const std::vector<std::string>& lines, SymbolTable& symbols,
+                        std::vector<Error>& errors) {
+    Tokenizer tokenizer;
+    Parser parser;
+    Evaluator evaluator;
+    Outcome outcome = {0, 0.0};
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        TokenList tokens;
+        TokenList postfix;
+        double value = 0.0;
+        if (tokenizer.tokenize(lines[i], tokens, errors[i]) && parser.toPostfix(tokens, postfix, errors[i]) &&
+            evaluator.evalPostfix(postfix, symbols, value, errors[i])) {
+            outcome.sum += value;
+        } else {
+            ++outcome.failures;
+        }
+    }
+    return outcome;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    const char* failing[] = {"a / (b - b)", "sqrt(-abs(a) - 1)", "log(b - b)", "a * missing", "(a + b",
+                             "a + * b", "max(a)"};
+    const std::size_t failingCount = sizeof(failing) / sizeof(failing[0]);
+
+    std::vector<std::string> lines(kRows);
+    for (std::size_t i = 0; i < kRows; ++i) {
+        if (i % 2 == 0) {
+            lines[i] = "a * b + sqrt(abs(a)) - " + std::to_string(dist(rng));
+        } else {
+            lines[i] = failing[(i / 2) % failingCount];
+        }
+    }
+
+    SymbolTable symbols;
+    symbols.set("a", 3.5);
+    symbols.set("b", -1.25);
+
+    std::vector<std::string> messages(kRows);
+    std::vector<Error> errors(kRows);
+    Outcome thrown;
+    Outcome returned;
+    {
+        bench::Timer timer;
+        thrown = evalWithExceptions(lines, symbols, messages);
+        bench::report("excepciones, pipeline completo", timer.seconds(), kRows);
+    }
+    {
+        bench::Timer timer;
+        returned = evalWithResults(lines, symbols, errors);
+        bench::report("codigos de resultado, pipeline completo", timer.seconds(), kRows);
+    }
+
+    std::vector<TokenList> postfixes;
+    for (std::size_t i = 0; i < kRows; ++i) {
+        TokenList tokens;
+        TokenList postfix;
+        Error error;
+        if (Tokenizer().tokenize(lines[i], tokens, error) && Parser().toPostfix(tokens, postfix, error)) {
+            postfixes.push_back(postfix);
+        }
+    }
+    Evaluator evaluator;
+    std::size_t evalFailuresThrown = 0;
+    std::size_t evalFailuresReturned = 0;
+    {
+        bench::Timer timer;
+        for (const TokenList& postfix : postfixes) {
+            try {
+                bench::keep(evaluator.evalPostfix(postfix, symbols));
+            } catch (const EdaError&) {
+                ++evalFailuresThrown;
+            }
+        }
+        bench::report("excepciones, solo evaluacion", timer.seconds(), postfixes.size());
+    }
+    {
+        bench::Timer timer;
+        for (const TokenList& postfix : postfixes) {
+            double value;
+            Error error;
+            if (evaluator.evalPostfix(postfix, symbols, value, error)) {
+                bench::keep(value);
+            } else {
+                ++evalFailuresReturned;
+            }
+        }
+        bench::report("codigos de resultado, solo evaluacion", timer.seconds(), postfixes.size());
+    }
+
+    bool ok = thrown.failures == returned.failures && thrown.sum == returned.sum &&
+              evalFailuresThrown == evalFailuresReturned;
+    for (std::size_t i = 0; i < kRows && ok; ++i) {
+        if (!messages[i].empty() && messages[i] != errors[i].message()) {
+            std::cout << "FALLA fila " << i << ": \"" << messages[i] << "\" vs \"" << errors[i].message() << "\""
+                      << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << std::endl << "filas con error: " << returned.failures << " de " << kRows << std::endl;
+    for (std::size_t i = 1; i < 2 * failingCount; i += 2) {
+        std::cout << "  " << lines[i] << "  ->  " << errors[i].message() << " (columna " << errors[i].column
+                  << ")" << std::endl;
+    }
+    std::cout << (ok ? "ok    " : "FALLA ") << "mismos mensajes y resultados en ambos caminos" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+// Columnas float en BatchEvaluator: precision de los kernels float de vecmath
+// frente a libm en float, error de los modos Single y Mixed frente al camino
+// double y rendimiento de los tres con columnas que no caben en cache.
+// Termina con codigo 1 si alguna cota no se cumple.
+#include "batch_evaluator.hpp"
+#include "bench_util.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kSamples = 1 << 20;
+const std::size_t kRows = 1 << 22;
+
+double ulpDistance(float a, float b) {
+    if (a == b || (std::isnan(a) && std::isnan(b))) {
+        return 0.0;
+    }
+    std::int32_t ia;
+    std::int32_t ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) {
+        ia = INT32_MIN - ia;
+    }
+    if (ib < 0) {
+        ib = INT32_MIN - ib;
+    }
+    return std::fabs(static_cast<double>(ia) - static_cast<double>(ib));
+}
+
+double maxUlp(const std::vector<float>& got, const std::vector<float>& expected) {
+    double worst = 0.0;
+    for (std::size_t i = 0; i < got.size(); ++i) {
+        double d = ulpDistance(got[i], expected[i]);
+        if (d > worst) {
+            worst = d;
+        }
+    }
+    return worst;
+}
+
+bool check(const std::string& label, double worst, double bound, const char* unit) {
+    bool ok = worst <= bound;
+    std::cout << (ok ? "ok    " : "FALLA ") << label << ": " << std::scientific << worst << unit << " (cota "
+              << bound << ")" << std::fixed << std::endl;
+    return ok;
+}
+
+std::vector<float> uniform(float lo, float hi, std::size_t n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<float> dist(lo, hi);
+    std::vector<float> values(n);
+    for (float& v : values) {
+        v = dist(rng);
+    }
+    return values;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::vector<float> out(kSamples);
+    std::vector<float> expected(kSamples);
+    bool ok = true;
+
+    std::vector<float> expIn = uniform(-103.0f, 88.0f, kSamples, rng);
+    std::vector<float> logIn = uniform(1e-30f, 1e30f, kSamples, rng);
+    std::vector<float> unitIn = uniform(1e-3f, 4.0f, kSamples, rng);
+    std::vector<float> powBase = uniform(0.01f, 10.0f, kSamples, rng);
+    std::vector<float> powExp = uniform(-8.0f, 8.0f, kSamples, rng);
+
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::sqrt(unitIn[i]);
+    }
+    vecmath::sqrt(unitIn.data(), out.data(), kSamples);
+    ok &= check("sqrt float", maxUlp(out, expected), 0.0, " ULP");
+
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::exp(expIn[i]);
+    }
+    vecmath::exp(expIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    ok &= check("exp float (Fast)", maxUlp(out, expected), 2.0, " ULP");
+
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::log(logIn[i]);
+    }
+    vecmath::log(logIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    ok &= check("log float (Fast, rango completo)", maxUlp(out, expected), 2.0, " ULP");
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::log(unitIn[i]);
+    }
+    vecmath::log(unitIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    ok &= check("log float (Fast, cerca de 1)", maxUlp(out, expected), 2.0, " ULP");
+
+    double powWorstExcess = 0.0;
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::pow(powBase[i], powExp[i]);
+    }
+    vecmath::pow(powBase.data(), powExp.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        double bound = 2.0 + 3.0 * std::fabs(powExp[i] * std::log(powBase[i]));
+        double excess = ulpDistance(out[i], expected[i]) - bound;
+        if (excess > powWorstExcess) {
+            powWorstExcess = excess;
+        }
+    }
+    ok &= check("pow float (Fast) sobre 2 + 3|y ln x|", powWorstExcess, 0.0, " ULP");
+
+    std::cout << std::endl;
+    TokenList postfix = Parser().toPostfix(Tokenizer().tokenize("sqrt(x) * exp(-y) + log(x + 1) * y / 3"));
+    SymbolTable symbols;
+
+    std::vector<float> x = uniform(1e-3f, 4.0f, kRows, rng);
+    std::vector<float> y = uniform(0.01f, 10.0f, kRows, rng);
+    std::vector<double> xd(x.begin(), x.end());
+    std::vector<double> yd(y.begin(), y.end());
+
+    BatchEvaluator::Columns columns;
+    columns["x"] = xd.data();
+    columns["y"] = yd.data();
+    BatchEvaluator::FloatColumns floatColumns;
+    floatColumns["x"] = x.data();
+    floatColumns["y"] = y.data();
+
+    BatchEvaluator evaluator(vecmath::Mode::Fast);
+    std::vector<double> reference(kRows);
+    std::vector<float> single(kRows);
+    std::vector<float> mixed(kRows);
+    {
+        bench::Timer timer;
+        evaluator.evalPostfix(postfix, columns, symbols, reference.data(), kRows);
+        bench::report("double", timer.seconds(), kRows);
+    }
+    {
+        bench::Timer timer;
+        evaluator.evalPostfix(postfix, floatColumns, symbols, mixed.data(), kRows,
+                              BatchEvaluator::Precision::Mixed);
+        bench::report("float Mixed", timer.seconds(), kRows);
+    }
+    {
+        bench::Timer timer;
+        evaluator.evalPostfix(postfix, floatColumns, symbols, single.data(), kRows,
+                              BatchEvaluator::Precision::Single);
+        bench::report("float Single", timer.seconds(), kRows);
+    }
+
+    std::vector<float> rounded(reference.begin(), reference.end());
+    double singleRelative = 0.0;
+    double mixedRelative = 0.0;
+    for (std::size_t i = 0; i < kRows; ++i) {
+        double scale = std::fabs(reference[i]) > 1e-3 ? std::fabs(reference[i]) : 1e-3;
+        singleRelative = std::max(singleRelative, std::fabs(single[i] - reference[i]) / scale);
+        mixedRelative = std::max(mixedRelative, std::fabs(mixed[i] - reference[i]) / scale);
+    }
+    std::cout << std::endl;
+    ok &= check("Mixed vs double redondeado a float", maxUlp(mixed, rounded), 0.0, " ULP");
+    ok &= check("Mixed, error relativo vs double", mixedRelative, std::ldexp(1.0, -24), "");
+    // En float, x + 1 pierde los bits bajos de x cuando x es pequeno y log lo
+    // amplifica: ~2^-24 / 1e-3 de error relativo en el peor caso.
+    ok &= check("Single, error relativo vs double", singleRelative, 1e-4, "");
+
+    std::vector<float> zero(1, 0.0f);
+    BatchEvaluator::FloatColumns zeroColumns;
+    zeroColumns["x"] = zero.data();
+    TokenList division = Parser().toPostfix(Tokenizer().tokenize("1 / x"));
+    std::string message;
+    try {
+        evaluator.evalPostfix(division, zeroColumns, symbols, out.data(), 1, BatchEvaluator::Precision::Single);
+    } catch (const EdaError& err) {
+        message = err.what();
+    }
+    bool errorOk = message == "division por cero en fila 0";
+    std::cout << (errorOk ? "ok    " : "FALLA ") << "errores por fila en float: " << message << std::endl;
+    ok &= errorOk;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// Costo del despacho por puntero de FunctionRegistry frente al sqrt
+// cableado que tenia Evaluator antes del registro.
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <cmath>
+#include <string>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kIterations = 1000000;
+
+// Replica del caso SQRT original: llamada directa a std::sqrt.
+double evalHardcodedSqrt(const TokenList& postfix, SymbolTable& symbols) {
+    Stack<double> values;
+    for (auto it = postfix.begin(); it != postfix.end(); ++it) {
+        const Token& token = *it;
+        switch (token.type) {
+            case TokenType::NUMBER:
+                values.push(token.value);
+                break;
+            case TokenType::IDENT:
+                values.push(symbols.get(token.lexeme));
+                break;
+            case TokenType::FUNCTION: {
+                double operand = values.top();
+                values.pop();
+                if (operand < 0.0) {
+                    throw EdaError("sqrt con argumento negativo");
+                }
+                values.push(std::sqrt(operand));
+                break;
+            }
+            case TokenType::PLUS: {
+                double right = values.top();
+                values.pop();
+                double left = values.top();
+                values.pop();
+                values.push(left + right);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return values.top();
+}
+
+TokenList compile(const std::string& text) {
+    return Parser().toPostfix(Tokenizer().tokenize(text));
+}
+
+} // namespace
+
+int main() {
+    SymbolTable symbols;
+    symbols.set("x", 2.0);
+    symbols.set("y", 3.0);
+
+    Evaluator evaluator;
+    TokenList postfix = compile("sqrt(x) + sqrt(y)");
+
+    {
+        bench::Timer timer;
+        double acc = 0.0;
+        for (std::size_t i = 0; i < kIterations; ++i) {
+            acc += evalHardcodedSqrt(postfix, symbols);
+        }
+        bench::keep(acc);
+        bench::report("sqrt cableado", timer.seconds(), kIterations);
+    }
+    {
+        bench::Timer timer;
+        double acc = 0.0;
+        for (std::size_t i = 0; i < kIterations; ++i) {
+            acc += evaluator.evalPostfix(postfix, symbols);
+        }
+        bench::keep(acc);
+        bench::report("sqrt via registro", timer.seconds(), kIterations);
+    }
+
+    Parser parser;
+    Optimizer optimizer;
+    TokenList constantPostfix = compile("x * hypot(3, 4) + exp(log(2))");
+    Tree tree = parser.buildTreeFromPostfix(constantPostfix);
+    optimizer.foldConstants(tree);
+    TokenList folded = optimizer.toPostfix(tree);
+
+    {
+        bench::Timer timer;
+        double acc = 0.0;
+        for (std::size_t i = 0; i < kIterations; ++i) {
+            acc += evaluator.evalPostfix(constantPostfix, symbols);
+        }
+        bench::keep(acc);
+        bench::report("funciones puras sin plegar", timer.seconds(), kIterations);
+    }
+    {
+        bench::Timer timer;
+        double acc = 0.0;
+        for (std::size_t i = 0; i < kIterations; ++i) {
+            acc += evaluator.evalPostfix(folded, symbols);
+        }
+        bench::keep(acc);
+        bench::report("funciones puras plegadas", timer.seconds(), kIterations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,589 @@
+// Pruebas diferenciales: genera expresiones al azar (profundidad, ancho,
+// mezcla de operadores, comparaciones, select y cantidad de variables
+// configurables), las evalua con cada backend y compara contra Tokenizer ->
+// Parser::toPostfix -> Evaluator::evalPostfix. Los valores deben coincidir
+// bit a bit (IntervalEvaluator: contener el valor) y los errores tener el
+// mismo mensaje. Cualquier diferencia se reduce a una expresion minima antes
+// de reportarla. Despues mide el parser con entradas patologicas.
+//
+//   bench/bin/fuzz [semilla] [casos] [profundidad] [ancho] [variables]
+//
+// Termina con codigo 1 si algun backend no coincide.
+#include "autodiff.hpp"
+#include "batch_evaluator.hpp"
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "interval_evaluator.hpp"
+#include "memo_evaluator.hpp"
+#include "optimizer.hpp"
+#include "parallel_evaluator.hpp"
+#include "parser.hpp"
+#include "register_vm.hpp"
+#include "tokenizer.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kRows = 4;
+
+struct Options {
+    std::size_t depth;
+    std::size_t width;
+    std::size_t variables;
+    // Pesos relativos de cada forma de nodo interno.
+    double chainWeight;
+    double powWeight;
+    double negWeight;
+    double callWeight;
+    double compareWeight;
+};
+
+struct Expr {
+    enum Kind {
+        LEAF,
+        NEG,
+        CHAIN,
+        POW,
+        CALL,
+        COMPARE
+    };
+
+    Kind kind;
+    std::string text;
+    std::vector<char> ops;
+    std::vector<Expr> children;
+};
+
+class Generator {
+public:
+    Generator(const Options& options, std::uint64_t seed) : options_(options), rng_(seed) {}
+
+    Expr generate() { return node(options_.depth); }
+
+private:
+    Options options_;
+    std::mt19937_64 rng_;
+
+    std::size_t pick(std::size_t n) { return std::uniform_int_distribution<std::size_t>(0, n - 1)(rng_); }
+
+    Expr leaf() {
+        static const char* const numbers[] = {"0", "1", "2", "3", "0.5", "1.5", "10", "0.25", "7"};
+        Expr expr;
+        expr.kind = Expr::LEAF;
+        if (options_.variables > 0 && pick(2) == 0) {
+            expr.text = "v" + std::to_string(pick(options_.variables));
+        } else {
+            expr.text = numbers[pick(sizeof(numbers) / sizeof(numbers[0]))];
+        }
+        return expr;
+    }
+
+    Expr node(std::size_t depth) {
+        if (depth == 0 || pick(4) == 0) {
+            return leaf();
+        }
+        double total = options_.chainWeight + options_.powWeight + options_.negWeight + options_.callWeight +
+                       options_.compareWeight;
+        double roll = std::uniform_real_distribution<double>(0.0, total)(rng_);
+
+        Expr expr;
+        if ((roll -= options_.chainWeight) < 0.0) {
+            expr.kind = Expr::CHAIN;
+            bool additive = pick(2) == 0;
+            std::size_t operands = 2 + pick(options_.width > 1 ? options_.width - 1 : 1);
+            for (std::size_t i = 0; i < operands; ++i) {
+                if (i > 0) {
+                    expr.ops.push_back(additive ? "+-"[pick(2)] : "*/"[pick(2)]);
+                }
+                expr.children.push_back(node(depth - 1));
+            }
+        } else if ((roll -= options_.powWeight) < 0.0) {
+            expr.kind = Expr::POW;
+            expr.children.push_back(node(depth - 1));
+            expr.children.push_back(pick(2) == 0 ? leaf() : node(depth - 1));
+        } else if ((roll -= options_.negWeight) < 0.0) {
+            expr.kind = Expr::NEG;
+            expr.children.push_back(node(depth - 1));
+        } else if ((roll -= options_.compareWeight) < 0.0) {
+            static const char* const comparisons[] = {"<", "<=", ">", ">=", "=="};
+            expr.kind = Expr::COMPARE;
+            expr.text = comparisons[pick(5)];
+            expr.children.push_back(node(depth - 1));
+            expr.children.push_back(pick(2) == 0 ? leaf() : node(depth - 1));
+        } else {
+            static const char* const unary[] = {"sqrt", "exp", "log", "sin", "cos", "abs"};
+            static const char* const binary[] = {"min", "max", "hypot"};
+            expr.kind = Expr::CALL;
+            if (pick(4) == 0) {
+                expr.text = "select";
+                for (std::size_t i = 0; i < 3; ++i) {
+                    expr.children.push_back(node(depth - 1));
+                }
+                return expr;
+            }
+            bool two = pick(3) == 0;
+            expr.text = two ? binary[pick(3)] : unary[pick(6)];
+            expr.children.push_back(node(depth - 1));
+            if (two) {
+                expr.children.push_back(node(depth - 1));
+            }
+        }
+        return expr;
+    }
+};
+
+std::string render(const Expr& expr);
+
+std::string operand(const Expr& expr) {
+    return expr.kind == Expr::LEAF || expr.kind == Expr::CALL ? render(expr) : "(" + render(expr) + ")";
+}
+
+std::string render(const Expr& expr) {
+    switch (expr.kind) {
+        case Expr::LEAF:
+            return expr.text;
+        case Expr::NEG:
+            return "-" + operand(expr.children[0]);
+        case Expr::POW:
+            return operand(expr.children[0]) + " ^ " + operand(expr.children[1]);
+        case Expr::COMPARE:
+            return operand(expr.children[0]) + " " + expr.text + " " + operand(expr.children[1]);
+        case Expr::CALL: {
+            std::string text = expr.text + "(" + render(expr.children[0]);
+            for (std::size_t i = 1; i < expr.children.size(); ++i) {
+                text += ", " + render(expr.children[i]);
+            }
+            return text + ")";
+        }
+        case Expr::CHAIN: {
+            std::string text = operand(expr.children[0]);
+            for (std::size_t i = 1; i < expr.children.size(); ++i) {
+                text += std::string(" ") + expr.ops[i - 1] + " " + operand(expr.children[i]);
+            }
+            return text;
+        }
+    }
+    return std::string();
+}
+
+std::size_t size(const Expr& expr) {
+    std::size_t total = 1;
+    for (const Expr& child : expr.children) {
+        total += size(child);
+    }
+    return total;
+}
+
+// Resultado de una evaluacion: valor o mensaje de error.
+struct Outcome {
+    bool ok;
+    double value;
+    std::string error;
+};
+
+typedef std::vector<std::vector<double>> Rows;
+
+SymbolTable tableFor(const std::vector<double>& row) {
+    SymbolTable symbols;
+    for (std::size_t i = 0; i < row.size(); ++i) {
+        symbols.set("v" + std::to_string(i), row[i]);
+    }
+    symbols.set("ans", 0.0);
+    return symbols;
+}
+
+template <typename F>
+Outcome capture(F body) {
+    try {
+        return Outcome{true, body(), std::string()};
+    } catch (const EdaError& err) {
+        return Outcome{false, 0.0, err.what()};
+    }
+}
+
+bool sameBits(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) || std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+bool sameOutcome(const Outcome& a, const Outcome& b) {
+    return a.ok == b.ok && (a.ok ? sameBits(a.value, b.value) : a.error == b.error);
+}
+
+std::string describe(const Outcome& outcome) {
+    return outcome.ok ? std::to_string(outcome.value) : "error \"" + outcome.error + "\"";
+}
+
+// Un backend devuelve un Outcome por fila a partir de la posfija.
+struct Backend {
+    const char* name;
+    bool containment;
+    std::function<std::vector<Outcome>(const TokenList&, const Rows&)> run;
+};
+
+std::vector<Outcome> perRow(const Rows& rows, const std::function<double(SymbolTable&)>& body) {
+    std::vector<Outcome> outcomes;
+    for (const std::vector<double>& row : rows) {
+        SymbolTable symbols = tableFor(row);
+        outcomes.push_back(capture([&]() { return body(symbols); }));
+    }
+    return outcomes;
+}
+
+std::vector<Backend> backends(std::size_t variables) {
+    std::vector<std::string> names;
+    for (std::size_t i = 0; i < variables; ++i) {
+        names.push_back("v" + std::to_string(i));
+    }
+
+    std::vector<Backend> list;
+    list.push_back(Backend{"Evaluator sin excepciones", false,
+                           [](const TokenList& postfix, const Rows& rows) {
+                               std::vector<Outcome> outcomes;
+                               for (const std::vector<double>& row : rows) {
+                                   SymbolTable symbols = tableFor(row);
+                                   Outcome outcome = {true, 0.0, std::string()};
+                                   Error error;
+                                   if (!Evaluator().evalPostfix(postfix, symbols, outcome.value, error)) {
+                                       outcome = Outcome{false, 0.0, error.message()};
+                                   }
+                                   outcomes.push_back(outcome);
+                               }
+                               return outcomes;
+                           }});
+    list.push_back(Backend{"Tree -> Optimizer::toPostfix", false,
+                           [](const TokenList& postfix, const Rows& rows) {
+                               Tree tree = Parser().buildTreeFromPostfix(postfix);
+                               TokenList again = Optimizer().toPostfix(tree);
+                               return perRow(rows, [&](SymbolTable& s) { return Evaluator().evalPostfix(again, s); });
+                           }});
+    list.push_back(Backend{"Optimizer::foldConstants", false,
+                           [](const TokenList& postfix, const Rows& rows) {
+                               Tree tree = Parser().buildTreeFromPostfix(postfix);
+                               Optimizer().foldConstants(tree);
+                               TokenList folded = Optimizer().toPostfix(tree);
+                               return perRow(rows, [&](SymbolTable& s) { return Evaluator().evalPostfix(folded, s); });
+                           }});
+    list.push_back(Backend{"RegisterVM", false,
+                           [](const TokenList& postfix, const Rows& rows) {
+                               RegisterVM vm(postfix);
+                               return perRow(rows, [&](SymbolTable& s) { return vm.evaluate(s); });
+                           }});
+    // Con minNodes = 1 todo arbol se reparte entre los hilos.
+    std::shared_ptr<ParallelEvaluator> parallel(new ParallelEvaluator(4, 1));
+    list.push_back(Backend{"ParallelEvaluator", false,
+                           [parallel](const TokenList& postfix, const Rows& rows) {
+                               Tree tree = Parser().buildTreeFromPostfix(postfix);
+                               std::vector<Outcome> outcomes;
+                               for (const std::vector<double>& row : rows) {
+                                   SymbolTable symbols = tableFor(row);
+                                   Outcome outcome = {true, 0.0, std::string()};
+                                   Error error;
+                                   if (!parallel->evaluate(tree, symbols, outcome.value, error)) {
+                                       outcome = Outcome{false, 0.0, error.message()};
+                                   }
+                                   outcomes.push_back(outcome);
+                               }
+                               return outcomes;
+                           }});
+    list.push_back(Backend{"BatchEvaluator Exact", false,
+                           [names](const TokenList& postfix, const Rows& rows) {
+                               std::vector<Outcome> outcomes;
+                               for (const std::vector<double>& row : rows) {
+                                   SymbolTable symbols = tableFor(row);
+                                   BatchEvaluator::Columns columns;
+                                   for (std::size_t i = 0; i < names.size(); ++i) {
+                                       columns[names[i]] = &row[i];
+                                   }
+                                   outcomes.push_back(capture([&]() {
+                                       double out = 0.0;
+                                       BatchEvaluator(vecmath::Mode::Exact).evalPostfix(postfix, columns, symbols,
+                                                                                         &out, 1);
+                                       return out;
+                                   }));
+                                   const std::string suffix = " en fila 0";
+                                   std::string& error = outcomes.back().error;
+                                   if (error.size() > suffix.size() &&
+                                       error.compare(error.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                                       error.erase(error.size() - suffix.size());
+                                   }
+                               }
+                               return outcomes;
+                           }});
+    // Un solo MemoEvaluator y una sola tabla para todas las filas: cada fila
+    // se evalua tras cambiar v0 y volverlo a su valor, asi las evaluaciones
+    // reutilizan los nodos que no dependen de v0. La intermedia se compara
+    // con Evaluator sobre la misma tabla.
+    list.push_back(Backend{"MemoEvaluator (incremental)", false,
+                           [names](const TokenList& postfix, const Rows& rows) {
+                               MemoEvaluator memo(Parser().buildTreeFromPostfix(postfix));
+                               SymbolTable symbols;
+                               symbols.set("ans", 0.0);
+                               auto evaluate = [&]() {
+                                   Outcome outcome = {true, 0.0, std::string()};
+                                   Error error;
+                                   if (!memo.evaluate(symbols, outcome.value, error)) {
+                                       outcome = Outcome{false, 0.0, error.message()};
+                                   }
+                                   return outcome;
+                               };
+                               std::vector<Outcome> outcomes;
+                               for (const std::vector<double>& row : rows) {
+                                   for (std::size_t i = 0; i < names.size(); ++i) {
+                                       symbols.set(names[i], row[i]);
+                                   }
+                                   Outcome outcome = evaluate();
+                                   if (!names.empty()) {
+                                       symbols.set(names[0], row[0] + 1.0);
+                                       Outcome changed = evaluate();
+                                       Outcome expected = capture([&]() {
+                                           return Evaluator().evalPostfix(postfix, symbols);
+                                       });
+                                       if (!sameOutcome(changed, expected)) {
+                                           outcome = Outcome{false, 0.0, "con v0 + 1: " + describe(changed) +
+                                                                             " vs " + describe(expected)};
+                                           outcomes.push_back(outcome);
+                                           continue;
+                                       }
+                                       symbols.set(names[0], row[0]);
+                                       Outcome again = evaluate();
+                                       if (!sameOutcome(again, outcome)) {
+                                           outcome = Outcome{false, 0.0, "al volver v0: " + describe(again)};
+                                       }
+                                   }
+                                   outcomes.push_back(outcome);
+                               }
+                               return outcomes;
+                           }});
+    list.push_back(Backend{"DualEvaluator (valor)", false,
+                           [](const TokenList& postfix, const Rows& rows) {
+                               return perRow(rows, [&](SymbolTable& s) {
+                                   return DualEvaluator().evalPostfix(postfix, s, "v0").value;
+                               });
+                           }});
+    list.push_back(Backend{"GradientEvaluator (valor)", false,
+                           [names](const TokenList& postfix, const Rows& rows) {
+                               Tree tree = Parser().buildTreeFromPostfix(postfix);
+                               return perRow(rows, [&](SymbolTable& s) {
+                                   return GradientEvaluator().evaluate(tree, s, names).value;
+                               });
+                           }});
+    list.push_back(Backend{"IntervalEvaluator (contiene)", true,
+                           [](const TokenList& postfix, const Rows& rows) {
+                               std::vector<Outcome> outcomes;
+                               for (const std::vector<double>& row : rows) {
+                                   SymbolTable symbols = tableFor(row);
+                                   Interval result = {0.0, 0.0};
+                                   Outcome outcome = capture([&]() {
+                                       result = IntervalEvaluator().evalPostfix(postfix, symbols,
+                                                                                IntervalEvaluator::Inputs());
+                                       return result.lo;
+                                   });
+                                   outcome.value = result.hi;
+                                   outcomes.push_back(outcome);
+                                   outcomes.push_back(Outcome{outcome.ok, result.lo, outcome.error});
+                               }
+                               return outcomes;
+                           }});
+    return list;
+}
+
+// Primera diferencia entre un backend y la referencia, o "" si coinciden.
+std::string compare(const std::string& text, const Rows& rows, const std::vector<Backend>& list) {
+    std::vector<Outcome> reference;
+    TokenList postfix;
+    for (const std::vector<double>& row : rows) {
+        SymbolTable symbols = tableFor(row);
+        reference.push_back(capture([&]() {
+            postfix = Parser().toPostfix(Tokenizer().tokenize(text));
+            return Evaluator().evalPostfix(postfix, symbols);
+        }));
+    }
+
+    TokenList tokens;
+    TokenList resultPostfix;
+    Error error;
+    bool parsed = Tokenizer().tokenize(text, tokens, error) && Parser().toPostfix(tokens, resultPostfix, error);
+    if (!parsed) {
+        if (reference[0].ok || reference[0].error != error.message()) {
+            return "Parser sin excepciones: " + error.message() + " vs " + describe(reference[0]);
+        }
+        return std::string();
+    }
+
+    for (const Backend& backend : list) {
+        std::vector<Outcome> got = backend.run(postfix, rows);
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            const Outcome& expected = reference[r];
+            if (backend.containment) {
+                const Outcome& hi = got[2 * r];
+                const Outcome& lo = got[2 * r + 1];
+                if (expected.ok && hi.ok && !std::isnan(expected.value) &&
+                    !(lo.value <= expected.value && expected.value <= hi.value)) {
+                    return std::string(backend.name) + ", fila " + std::to_string(r) + ": [" +
+                           std::to_string(lo.value) + ", " + std::to_string(hi.value) + "] no contiene " +
+                           describe(expected);
+                }
+                continue;
+            }
+            const Outcome& actual = got[r];
+            if (!sameOutcome(expected, actual)) {
+                return std::string(backend.name) + ", fila " + std::to_string(r) + ": " + describe(actual) +
+                       " vs " + describe(expected);
+            }
+        }
+    }
+    return std::string();
+}
+
+void collect(Expr& expr, std::vector<Expr*>& nodes) {
+    nodes.push_back(&expr);
+    for (Expr& child : expr.children) {
+        collect(child, nodes);
+    }
+}
+
+// Reduce la expresion mientras siga habiendo diferencia: reemplaza un nodo
+// por uno de sus hijos o por una hoja, o quita un operando de una cadena.
+Expr shrink(Expr expr, const Rows& rows, const std::vector<Backend>& list) {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        std::vector<Expr*> nodes;
+        collect(expr, nodes);
+        for (std::size_t k = 0; k < nodes.size() && !progress; ++k) {
+            std::vector<Expr> replacements;
+            for (const Expr& child : nodes[k]->children) {
+                replacements.push_back(child);
+            }
+            if (nodes[k]->kind != Expr::LEAF) {
+                Expr one;
+                one.kind = Expr::LEAF;
+                one.text = "1";
+                replacements.push_back(one);
+            }
+            if (nodes[k]->kind == Expr::CHAIN && nodes[k]->children.size() > 2) {
+                for (std::size_t i = 0; i < nodes[k]->children.size(); ++i) {
+                    Expr shorter = *nodes[k];
+                    shorter.children.erase(shorter.children.begin() + static_cast<long>(i));
+                    shorter.ops.erase(shorter.ops.begin() + static_cast<long>(i == 0 ? 0 : i - 1));
+                    replacements.push_back(shorter);
+                }
+            }
+
+            for (const Expr& replacement : replacements) {
+                Expr candidate = expr;
+                std::vector<Expr*> candidateNodes;
+                collect(candidate, candidateNodes);
+                *candidateNodes[k] = replacement;
+                if (!compare(render(candidate), rows, list).empty()) {
+                    expr = candidate;
+                    progress = true;
+                    break;
+                }
+            }
+        }
+    }
+    return expr;
+}
+
+Rows randomRows(std::size_t variables, std::mt19937_64& rng) {
+    static const double special[] = {0.0, 1.0, -1.0, 0.5, 2.0};
+    std::uniform_real_distribution<double> dist(-5.0, 5.0);
+    Rows rows(kRows, std::vector<double>(variables));
+    for (std::vector<double>& row : rows) {
+        for (double& value : row) {
+            value = rng() % 4 == 0 ? special[rng() % 5] : dist(rng);
+        }
+    }
+    return rows;
+}
+
+std::string repeat(const std::string& piece, std::size_t count) {
+    std::string text;
+    text.reserve(piece.size() * count);
+    for (std::size_t i = 0; i < count; ++i) {
+        text += piece;
+    }
+    return text;
+}
+
+// Tokenizer + Parser::toPostfix sobre una entrada patologica; ns por caracter.
+void parseThroughput(const std::string& label, const std::string& text) {
+    Tokenizer tokenizer;
+    Parser parser;
+    bench::Timer timer;
+    TokenList tokens = tokenizer.tokenize(text);
+    TokenList postfix;
+    Error error;
+    bool ok = parser.toPostfix(tokens, postfix, error);
+    double seconds = timer.seconds();
+    bench::report(label + (ok ? "" : " (error)"), seconds, text.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t seed = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    std::size_t cases = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000;
+    Options options = {6, 4, 3, 4.0, 1.0, 1.0, 2.0, 1.0};
+    if (argc > 3) {
+        options.depth = std::strtoul(argv[3], nullptr, 10);
+    }
+    if (argc > 4) {
+        options.width = std::strtoul(argv[4], nullptr, 10);
+    }
+    if (argc > 5) {
+        options.variables = std::strtoul(argv[5], nullptr, 10);
+    }
+
+    Generator generator(options, seed);
+    std::mt19937_64 rng(seed ^ 0x9e3779b97f4a7c15ULL);
+    std::vector<Backend> list = backends(options.variables);
+
+    std::cout << "semilla " << seed << ", " << cases << " casos, profundidad " << options.depth << ", ancho "
+              << options.width << ", " << options.variables << " variables, " << list.size() + 1 << " backends"
+              << std::endl;
+
+    bool ok = true;
+    std::size_t failures = 0;
+    bench::Timer timer;
+    for (std::size_t i = 0; i < cases && ok; ++i) {
+        Expr expr = generator.generate();
+        Rows rows = randomRows(options.variables, rng);
+        std::string diff = compare(render(expr), rows, list);
+        if (!diff.empty()) {
+            Expr minimal = shrink(expr, rows, list);
+            std::cout << "FALLA caso " << i << " (" << size(expr) << " nodos): " << render(expr) << std::endl
+                      << "  minima (" << size(minimal) << " nodos): " << render(minimal) << std::endl
+                      << "  " << compare(render(minimal), rows, list) << std::endl;
+            ok = false;
+        }
+        failures += diff.empty() ? 0 : 1;
+    }
+    bench::report("casos diferenciales", timer.seconds(), cases);
+    std::cout << (ok ? "ok    " : "FALLA ") << "todos los backends coinciden con Evaluator" << std::endl
+              << std::endl;
+
+    const std::size_t n = 100000;
+    parseThroughput("cadena 1+1+...", "1" + repeat(" + 1", n));
+    parseThroughput("potencias 2^2^...^2", "2" + repeat("^2", n));
+    parseThroughput("parentesis anidados", repeat("(", n) + "1" + repeat(")", n));
+    parseThroughput("menos unarios", repeat("-", n) + "1");
+    parseThroughput("funciones anidadas", repeat("sqrt(", n) + "1" + repeat(")", n));
+    parseThroughput("parentesis sin cerrar", repeat("(", n) + "1");
+    parseThroughput("identificadores largos", repeat("abcdefghij", n) + " + 1");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Sensibilidad de una formula: una pasada de IntervalEvaluator frente al
+// bucle de Monte Carlo (tokenizar, parsear y evaluar con entradas
+// perturbadas) y frente a una evaluacion normal. Tambien comprueba que todas
+// las muestras caen dentro del intervalo; termina con codigo 1 si no.
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "interval_evaluator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kRepetitions = 20000;
+const std::size_t kMonteCarloSamples = 64;
+const char* const kFormula = "x * y - sqrt(x) / (y - 2.5) + exp(z) * hypot(x, z) - (x - y) ^ 3";
+
+void bind(SymbolTable& symbols, double x, double y, double z) {
+    symbols.set("x", x);
+    symbols.set("y", y);
+    symbols.set("z", z);
+}
+
+} // namespace
+
+int main() {
+    Tokenizer tokenizer;
+    Parser parser;
+    Evaluator evaluator;
+    IntervalEvaluator intervals;
+    SymbolTable symbols;
+    TokenList postfix = parser.toPostfix(tokenizer.tokenize(kFormula));
+
+    const double x = 2.0, y = 3.0, z = 0.5, tolerance = 0.01;
+    bind(symbols, x, y, z);
+    IntervalEvaluator::Inputs inputs;
+    inputs["x"] = Interval{x - tolerance, x + tolerance};
+    inputs["y"] = Interval{y - tolerance, y + tolerance};
+    inputs["z"] = Interval{z - tolerance, z + tolerance};
+
+    bool ok = true;
+    Interval bounds = intervals.evalPostfix(postfix, symbols, inputs);
+    std::cout << kFormula << std::endl;
+    std::cout << "intervalo: [" << bounds.lo << ", " << bounds.hi << "]" << std::endl;
+
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> offset(-tolerance, tolerance);
+    double sampledLo = bounds.hi;
+    double sampledHi = bounds.lo;
+    for (std::size_t i = 0; i < 100000; ++i) {
+        bind(symbols, x + offset(rng), y + offset(rng), z + offset(rng));
+        double value = evaluator.evalPostfix(postfix, symbols);
+        sampledLo = std::min(sampledLo, value);
+        sampledHi = std::max(sampledHi, value);
+        if (!bounds.contains(value)) {
+            ok = false;
+        }
+    }
+    std::cout << (ok ? "ok    " : "FALLA ") << "100000 muestras dentro del intervalo (rango muestreado ["
+              << sampledLo << ", " << sampledHi << "])" << std::endl;
+
+    for (std::size_t i = 0; i < 100000; ++i) {
+        double a = offset(rng) * 1e3;
+        double b = offset(rng) * 1e3;
+        bind(symbols, a, b, 0.0);
+        IntervalEvaluator::Inputs points;
+        points["x"] = Interval::point(a);
+        points["y"] = Interval::point(b);
+        TokenList ops = parser.toPostfix(tokenizer.tokenize("x * y + x / y - sqrt(abs(x)) - y"));
+        Interval enclosure = intervals.evalPostfix(ops, symbols, points);
+        double value = evaluator.evalPostfix(ops, symbols);
+        if (!enclosure.contains(value) || enclosure.hi - enclosure.lo > 1e-9 * (1.0 + std::fabs(value))) {
+            ok = false;
+        }
+    }
+    std::cout << (ok ? "ok    " : "FALLA ") << "entradas puntuales: intervalo estrecho que contiene el valor" << std::endl;
+
+    std::cout << std::endl;
+    bind(symbols, x, y, z);
+    {
+        bench::Timer timer;
+        double sum = 0.0;
+        for (std::size_t i = 0; i < kRepetitions; ++i) {
+            sum += evaluator.evalPostfix(postfix, symbols);
+        }
+        bench::keep(sum);
+        bench::report("Evaluator (una pasada)", timer.seconds(), kRepetitions);
+    }
+    {
+        bench::Timer timer;
+        double sum = 0.0;
+        for (std::size_t i = 0; i < kRepetitions; ++i) {
+            sum += intervals.evalPostfix(postfix, symbols, inputs).hi;
+        }
+        bench::keep(sum);
+        bench::report("IntervalEvaluator (una pasada)", timer.seconds(), kRepetitions);
+    }
+    {
+        const std::size_t runs = kRepetitions / 20;
+        bench::Timer timer;
+        double sum = 0.0;
+        for (std::size_t i = 0; i < runs; ++i) {
+            for (std::size_t s = 0; s < kMonteCarloSamples; ++s) {
+                bind(symbols, x + offset(rng), y + offset(rng), z + offset(rng));
+                TokenList reparsed = parser.toPostfix(tokenizer.tokenize(kFormula));
+                sum += evaluator.evalPostfix(reparsed, symbols);
+            }
+        }
+        bench::keep(sum);
+        bench::report("Monte Carlo (64 pasadas completas)", timer.seconds(), runs);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+// Reevaluacion incremental con MemoEvaluator frente a evaluar la posfija
+// entera con Evaluator, sobre formulas grandes (sumas de miles de terminos
+// con funciones sobre miles de variables) cuando entre evaluacion y
+// evaluacion cambia una sola variable. Mide con el arbol tal como lo arma el
+// Parser (la cadena de sumas es un peine: cambiar una variable recalcula
+// toda la espina) y despues de Optimizer::reassociate (arbol balanceado).
+// Verifica que cada resultado sea identico bit a bit al de Evaluator, que
+// los errores coincidan y que se detecten los cambios en SharedSymbols.
+// Uso: memo [terminos] [actualizaciones]
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "memo_evaluator.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "shared_symbols.hpp"
+#include "tokenizer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kVariables = 4096;
+
+std::string name(std::size_t index) {
+    return "v" + std::to_string(index);
+}
+
+// (sin(va * c) * vb - sqrt(vc)) + ..., con variables al azar en cada termino.
+std::string makeFormula(std::size_t terms, std::mt19937_64& rng) {
+    std::string text;
+    for (std::size_t i = 0; i < terms; ++i) {
+        if (i > 0) {
+            text += " + ";
+        }
+        text += "(sin(" + name(rng() % kVariables) + " * " + std::to_string(1 + rng() % 9) + ") * " +
+                name(rng() % kVariables) + " - sqrt(" + name(rng() % kVariables) + "))";
+    }
+    return text;
+}
+
+Tree makeTree(const std::string& text, bool balanced) {
+    Tree tree = Parser().buildTreeFromPostfix(Parser().toPostfix(Tokenizer().tokenize(text)));
+    if (balanced) {
+        Optimizer().reassociate(tree);
+    }
+    return tree;
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+bool measure(const std::string& label, const Tree& tree, std::size_t updates, std::mt19937_64& rng) {
+    TokenList postfix = Optimizer().toPostfix(tree);
+    SymbolTable symbols;
+    for (std::size_t i = 0; i < kVariables; ++i) {
+        symbols.set(name(i), 1.0 + static_cast<double>(rng() % 1000) / 100.0);
+    }
+    std::vector<std::size_t> changed(updates);
+    std::vector<double> values(updates);
+    for (std::size_t i = 0; i < updates; ++i) {
+        changed[i] = rng() % kVariables;
+        values[i] = 1.0 + static_cast<double>(rng() % 1000) / 100.0;
+    }
+
+    Evaluator evaluator;
+    std::vector<double> expected(updates);
+    SymbolTable fullSymbols = symbols;
+    bench::Timer fullTimer;
+    for (std::size_t i = 0; i < updates; ++i) {
+        fullSymbols.set(name(changed[i]), values[i]);
+        expected[i] = evaluator.evalPostfix(postfix, fullSymbols);
+    }
+    double fullSeconds = fullTimer.seconds();
+
+    MemoEvaluator memo(tree);
+    memo.evaluate(symbols);
+    memo.resetStats();
+    bool same = true;
+    bench::Timer memoTimer;
+    for (std::size_t i = 0; i < updates; ++i) {
+        symbols.set(name(changed[i]), values[i]);
+        same &= sameBits(memo.evaluate(symbols), expected[i]);
+    }
+    double memoSeconds = memoTimer.seconds();
+
+    std::cout << label << " (" << memo.nodeCount() << " nodos)" << std::endl;
+    bench::report("  Evaluator, posfija entera", fullSeconds, updates);
+    bench::report("  MemoEvaluator, incremental", memoSeconds, updates);
+    std::cout << "    aciertos " << 100.0 * memo.stats().hitRate() << "%, aceleracion " << fullSeconds / memoSeconds
+              << "x" << std::endl;
+    if (!same) {
+        std::cout << "FALLA resultados distintos de Evaluator" << std::endl;
+    }
+    return same;
+}
+
+// Mismo valor o mismo mensaje de error que Evaluator.
+bool sameOutcome(MemoEvaluator& memo, const Tree& tree, const SymbolTable& symbols) {
+    TokenList postfix = Optimizer().toPostfix(tree);
+    double expected = 0.0;
+    double actual = 0.0;
+    Error expectedError;
+    Error actualError;
+    bool expectedOk = Evaluator().evalPostfix(postfix, symbols, expected, expectedError);
+    bool actualOk = memo.evaluate(symbols, actual, actualError);
+    if (expectedOk != actualOk) {
+        return false;
+    }
+    return expectedOk ? sameBits(expected, actual) : expectedError.message() == actualError.message();
+}
+
+bool checkErrors() {
+    Tree tree = makeTree("sqrt(x) + 1 / (y - 2) + log(z) * ans", false);
+    MemoEvaluator memo(tree);
+    SymbolTable symbols;
+    bool ok = sameOutcome(memo, tree, symbols);
+    symbols.set("x", 4.0);
+    symbols.set("y", 3.0);
+    symbols.set("z", 5.0);
+    ok &= sameOutcome(memo, tree, symbols);
+    symbols.set("y", 2.0);
+    ok &= sameOutcome(memo, tree, symbols);
+    symbols.set("x", -1.0);
+    ok &= sameOutcome(memo, tree, symbols);
+    symbols.set("x", 9.0);
+    symbols.set("y", 4.0);
+    ok &= sameOutcome(memo, tree, symbols);
+    symbols.set("ans", 2.5);
+    ok &= sameOutcome(memo, tree, symbols);
+    // Sin cambios no se recalcula nada.
+    std::size_t recomputed = memo.stats().recomputed;
+    ok &= sameOutcome(memo, tree, symbols) && memo.stats().recomputed == recomputed;
+    return ok;
+}
+
+bool checkShared() {
+    SharedSymbols shared;
+    shared.set("g", 2.0);
+    SymbolTable symbols(&shared);
+    symbols.set("x", 3.0);
+    Tree tree = makeTree("g * x + g ^ 2", false);
+    MemoEvaluator memo(tree);
+    bool ok = sameOutcome(memo, tree, symbols);
+    shared.set("g", -0.5);
+    ok &= sameOutcome(memo, tree, symbols);
+    symbols.set("g", 7.0);
+    ok &= sameOutcome(memo, tree, symbols);
+    return ok;
+}
+
+// Una suma larga da un arbol tan profundo como terminos tiene: ni el
+// constructor ni la posfija para los errores usan recursion.
+bool checkDeep() {
+    std::string text = "x";
+    for (std::size_t i = 1; i < 300000; ++i) {
+        text += " + x";
+    }
+    Tree tree = makeTree(text + " + 1 / y", false);
+    MemoEvaluator memo(tree);
+    SymbolTable symbols;
+    symbols.set("x", 0.25);
+    symbols.set("y", 0.0);
+    bool ok = sameOutcome(memo, tree, symbols);
+    symbols.set("y", 4.0);
+    ok &= sameOutcome(memo, tree, symbols);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t terms = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    std::size_t updates = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+    std::mt19937_64 rng(48);
+    std::string text = makeFormula(terms, rng);
+
+    bool ok = true;
+    ok &= measure("arbol del Parser", makeTree(text, false), updates, rng);
+    ok &= measure("arbol balanceado (reassociate)", makeTree(text, true), updates, rng);
+    std::cout << std::endl;
+
+    bool errors = checkErrors();
+    bool shared = checkShared();
+    bool deep = checkDeep();
+    ok &= errors && shared && deep;
+    std::cout << (ok ? "ok    " : "FALLA ")
+              << "MemoEvaluator igual bit a bit a Evaluator, con los mismos errores, SharedSymbols y arboles profundos"
+              << std::endl;
+    return ok ? 0 : 1;
+}
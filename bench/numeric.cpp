@@ -0,0 +1,111 @@
+// Los mismos scripts con BasicEvaluator<double> y BasicEvaluator<Rational>:
+// uno con importes pequenos (el racional no sale de la representacion en
+// linea) y otro con intereses compuestos (numeradores de cientos de digitos).
+// Termina con codigo 1 si el modo racional no es exacto.
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "rational.hpp"
+#include "tokenizer.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+struct Line {
+    std::string target;
+    TokenList postfix;
+};
+
+std::vector<Line> compile(const std::vector<std::string>& script) {
+    Tokenizer tokenizer;
+    Parser parser;
+    std::vector<Line> lines;
+    for (const std::string& text : script) {
+        std::size_t equals = text.find('=');
+        Line line;
+        line.target = text.substr(0, equals - 1);
+        line.postfix = parser.toPostfix(tokenizer.tokenize(text.substr(equals + 1)));
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+template <typename T>
+T run(const std::vector<Line>& lines, std::size_t repetitions, const std::string& label) {
+    BasicEvaluator<T> evaluator;
+    BasicSymbolTable<T> symbols;
+    T last = T();
+    bench::Timer timer;
+    for (std::size_t r = 0; r < repetitions; ++r) {
+        for (const Line& line : lines) {
+            last = evaluator.evalPostfix(line.postfix, symbols);
+            symbols.set(line.target, last);
+            symbols.set("ans", last);
+        }
+    }
+    bench::report(label, timer.seconds(), repetitions * lines.size());
+    return last;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+
+    std::vector<std::string> ledger = {
+        "total = 0",
+        "a = 19.99 * 3",
+        "b = 0.1 + 0.2",
+        "c = a - b * 4.25",
+        "d = max(c, 12.5) / 4",
+        "previous = total",
+        "total = total + a + b + c + d - 0.01",
+        "check = (total - previous) - (a + b + c + d - 0.01)",
+    };
+    std::vector<std::string> compound = {
+        "p = 1000",
+        "rate = 0.05 / 12",
+        "amount = p * (1 + rate) ^ 360",
+        "interest = amount - p",
+    };
+
+    std::vector<Line> small = compile(ledger);
+    std::cout << "libro de importes (" << ledger.size() << " lineas)" << std::endl;
+    run<double>(small, 20000, "  double");
+    Rational check = run<Rational>(small, 20000, "  racional");
+    ok &= check.isZero();
+    std::cout << "  " << (check.isZero() ? "ok    " : "FALLA ") << "check = 0 exacto en modo racional" << std::endl;
+
+    std::vector<Line> big = compile(compound);
+    std::cout << "interes compuesto (" << compound.size() << " lineas)" << std::endl;
+    double approx = run<double>(big, 200, "  double");
+    Rational exact = run<Rational>(big, 200, "  racional");
+    std::cout << "  digitos del numerador: " << exact.numerator().toString().size()
+              << std::scientific << ", error relativo del double: " << (approx - exact.toDouble()) / exact.toDouble()
+              << std::fixed << std::endl;
+
+    {
+        Tokenizer tokenizer;
+        Parser parser;
+        TokenList step = parser.toPostfix(tokenizer.tokenize("ans + 0.01"));
+        BasicEvaluator<Rational> exactEvaluator;
+        BasicSymbolTable<Rational> exactSymbols;
+        Evaluator evaluator;
+        SymbolTable symbols;
+        for (int i = 0; i < 10000; ++i) {
+            exactSymbols.set("ans", exactEvaluator.evalPostfix(step, exactSymbols));
+            symbols.set("ans", evaluator.evalPostfix(step, symbols));
+        }
+        bool exactHundred = exactSymbols.get("ans") == Rational(100);
+        ok &= exactHundred;
+        std::cout << (exactHundred ? "ok    " : "FALLA ") << "10000 * 0.01 = " << exactSymbols.get("ans").toString()
+                  << std::scientific << " (double: " << symbols.get("ans") - 100.0 << " de error)" << std::fixed << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// Una sola expresion enorme (suma de terminos producto, como las generadas)
+// evaluada por ParallelEvaluator con 1, 2, 4 y hardware_concurrency() hilos,
+// de 10^5 a 10^7 nodos. Verifica que el resultado sea identico bit a bit al
+// de Evaluator sobre la posfija con cualquier numero de hilos, y que un
+// error en medio de la suma se reporte igual.
+// Uso: parallel [nodos maximos]
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "functions.hpp"
+#include "parallel_evaluator.hpp"
+#include "parser.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kNodesPerTerm = 11;
+
+Token number(double value) {
+    return Token(TokenType::NUMBER, std::to_string(value), value);
+}
+
+Token op(TokenType type, const char* lexeme) {
+    return Token(type, lexeme);
+}
+
+// Suma de `terms` terminos c * x * y * sin(x + d), en posfija; con
+// `brokenTerm` < terms ese termino divide por (y - y).
+TokenList sumOfProducts(std::size_t terms, std::size_t brokenTerm) {
+    const Function* sine = FunctionRegistry::builtins().find("sin");
+    TokenList postfix;
+    for (std::size_t i = 0; i < terms; ++i) {
+        postfix.push_back(number(1.0 + static_cast<double>(i % 97) / 8.0));
+        postfix.push_back(Token(TokenType::IDENT, "x"));
+        postfix.push_back(op(TokenType::MUL, "*"));
+        postfix.push_back(Token(TokenType::IDENT, "y"));
+        postfix.push_back(op(TokenType::MUL, "*"));
+        postfix.push_back(Token(TokenType::IDENT, "x"));
+        postfix.push_back(number(static_cast<double>(i % 13) / 4.0));
+        postfix.push_back(op(TokenType::PLUS, "+"));
+        postfix.push_back(Token(sine, "sin"));
+        if (i == brokenTerm) {
+            postfix.push_back(Token(TokenType::IDENT, "y"));
+            postfix.push_back(Token(TokenType::IDENT, "y"));
+            postfix.push_back(op(TokenType::MINUS, "-"));
+            postfix.push_back(op(TokenType::DIV, "/"));
+        }
+        postfix.push_back(op(TokenType::MUL, "*"));
+        if (i > 0) {
+            postfix.push_back(op(TokenType::PLUS, "+"));
+        }
+    }
+    postfix.push_back(Token(TokenType::END, ""));
+    return postfix;
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+bool runSize(std::size_t nodes, const std::vector<std::size_t>& threadCounts, const SymbolTable& symbols) {
+    std::size_t terms = nodes / kNodesPerTerm;
+    TokenList postfix = sumOfProducts(terms, terms);
+    Tree tree = Parser().buildTreeFromPostfix(postfix);
+    std::size_t actual = tree.getRoot()->size;
+    std::cout << terms << " terminos, " << actual << " nodos" << std::endl;
+
+    SymbolTable table = symbols;
+    double reference;
+    {
+        bench::Timer timer;
+        reference = Evaluator().evalPostfix(postfix, table);
+        bench::report("  Evaluator, posfija", timer.seconds(), actual);
+    }
+    postfix.clear();
+
+    bool ok = true;
+    double single = 0.0;
+    for (std::size_t threads : threadCounts) {
+        ParallelEvaluator evaluator(threads);
+        double best = 0.0;
+        double value = 0.0;
+        for (int round = 0; round < 3; ++round) {
+            bench::Timer timer;
+            value = evaluator.evaluate(tree, symbols);
+            double seconds = timer.seconds();
+            best = round == 0 ? seconds : std::min(best, seconds);
+        }
+        if (threads == 1) {
+            single = best;
+        }
+        bench::report("  " + std::to_string(threads) + " hilo(s)", best, actual);
+        std::cout << "    aceleracion " << single / best << "x" << std::endl;
+        if (!sameBits(value, reference)) {
+            std::cout << "FALLA resultado distinto con " << threads << " hilos: " << value << " vs " << reference
+                      << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool checkError(const std::vector<std::size_t>& threadCounts, const SymbolTable& symbols) {
+    const std::size_t terms = 20000;
+    TokenList postfix = sumOfProducts(terms, terms / 3);
+    Tree tree = Parser().buildTreeFromPostfix(postfix);
+    SymbolTable table = symbols;
+    double value;
+    Error expected;
+    bool ok = !Evaluator().evalPostfix(postfix, table, value, expected);
+    for (std::size_t threads : threadCounts) {
+        ParallelEvaluator evaluator(threads);
+        Error error;
+        ok &= !evaluator.evaluate(tree, symbols, value, error) && error.kind == expected.kind &&
+              error.message() == expected.message();
+    }
+    std::cout << (ok ? "ok    " : "FALLA ") << "mismo error que Evaluator con cada numero de hilos ("
+              << expected.message() << ")" << std::endl;
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t maxNodes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    std::size_t cores = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    std::vector<std::size_t> threadCounts = {1, 2, 4};
+    if (std::find(threadCounts.begin(), threadCounts.end(), cores) == threadCounts.end()) {
+        threadCounts.push_back(cores);
+    }
+    std::cout << "nucleos disponibles: " << cores << std::endl << std::endl;
+
+    SymbolTable symbols;
+    symbols.set("x", 0.75);
+    symbols.set("y", -1.5);
+
+    bool ok = true;
+    for (std::size_t nodes = 100000; nodes <= maxNodes; nodes *= 10) {
+        ok &= runSize(nodes, threadCounts, symbols);
+        std::cout << std::endl;
+    }
+    ok &= checkError(threadCounts, symbols);
+    std::cout << (ok ? "ok    " : "FALLA ") << "resultados identicos bit a bit a Evaluator" << std::endl;
+    return ok ? 0 : 1;
+}
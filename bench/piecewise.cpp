@@ -0,0 +1,300 @@
+// Funciones a trozos: BatchEvaluator con select, comparaciones y min/max sin
+// saltos (mascaras de vecmath) frente a un bucle C++ que salta segun la
+// condicion de cada fila, con condiciones al azar (el predictor de saltos
+// falla la mitad de las veces) y con las filas ordenadas (acierta casi
+// siempre). Tambien RegisterVM y Evaluator fila por fila. Verifica que los
+// kernels de vecmath den lo mismo que la version escalar (NaN y ceros con
+// signo incluidos), que BatchEvaluator Exact y RegisterVM den lo mismo bit a
+// bit que Evaluator y que un error en la rama no elegida sea un error.
+// Uso: piecewise [filas]
+#include "batch_evaluator.hpp"
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "rational.hpp"
+#include "register_vm.hpp"
+#include "tokenizer.hpp"
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const char* const kFormula = "select(x < t, exp(x), sqrt(x) * 2) + min(x, t)";
+
+TokenList compile(const std::string& text) {
+    return Parser().toPostfix(Tokenizer().tokenize(text));
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+bool sameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// La misma funcion a mano: exp y sqrt son llamadas, asi que el compilador
+// no puede convertir el if en una mezcla y salta en cada fila.
+void branching(const double* x, const double* t, double* out, std::size_t rows) {
+    for (std::size_t i = 0; i < rows; ++i) {
+        double value;
+        if (x[i] < t[i]) {
+            value = std::exp(x[i]);
+        } else {
+            value = std::sqrt(x[i]) * 2;
+        }
+        out[i] = value + std::min(x[i], t[i]);
+    }
+}
+
+struct Timing {
+    double branching;
+    double batch;
+    double vm;
+    double evaluator;
+};
+
+Timing measure(const std::vector<double>& x, const std::vector<double>& t, std::size_t scalarRows, bool& same) {
+    std::size_t rows = x.size();
+    TokenList postfix = compile(kFormula);
+    Timing timing;
+
+    std::vector<double> expected(rows);
+    bench::Timer branchTimer;
+    branching(x.data(), t.data(), expected.data(), rows);
+    timing.branching = branchTimer.seconds();
+
+    BatchEvaluator::Columns columns;
+    columns["x"] = x.data();
+    columns["t"] = t.data();
+    SymbolTable symbols;
+    std::vector<double> batch(rows);
+    bench::Timer batchTimer;
+    BatchEvaluator(vecmath::Mode::Exact).evalPostfix(postfix, columns, symbols, batch.data(), rows);
+    timing.batch = batchTimer.seconds();
+
+    RegisterVM vm(postfix);
+    double vmSum = 0.0;
+    bench::Timer vmTimer;
+    for (std::size_t i = 0; i < scalarRows; ++i) {
+        symbols.set("x", x[i]);
+        symbols.set("t", t[i]);
+        vmSum += vm.evaluate(symbols);
+    }
+    timing.vm = vmTimer.seconds();
+
+    Evaluator evaluator;
+    double evaluatorSum = 0.0;
+    bench::Timer evaluatorTimer;
+    for (std::size_t i = 0; i < scalarRows; ++i) {
+        symbols.set("x", x[i]);
+        symbols.set("t", t[i]);
+        evaluatorSum += evaluator.evalPostfix(postfix, symbols);
+    }
+    timing.evaluator = evaluatorTimer.seconds();
+
+    double batchSum = 0.0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        same &= sameBits(batch[i], expected[i]);
+        if (i < scalarRows) {
+            batchSum += batch[i];
+        }
+    }
+    same &= sameBits(vmSum, batchSum) && sameBits(evaluatorSum, batchSum);
+    return timing;
+}
+
+void report(const std::string& label, const Timing& timing, std::size_t rows, std::size_t scalarRows) {
+    std::cout << label << std::endl;
+    bench::report("  C++ con saltos", timing.branching, rows);
+    bench::report("  BatchEvaluator, mezcla sin saltos", timing.batch, rows);
+    bench::report("  RegisterVM por fila", timing.vm, scalarRows);
+    bench::report("  Evaluator por fila", timing.evaluator, scalarRows);
+}
+
+// Valores que separan las semanticas: NaN, ceros con signo, iguales.
+template <typename T>
+std::vector<T> specialValues(std::mt19937_64& rng, std::size_t n) {
+    const T specials[] = {T(0), -T(0), T(1), T(-1), T(0.5), std::numeric_limits<T>::quiet_NaN(),
+                          std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity()};
+    std::vector<T> values(n);
+    for (T& value : values) {
+        value = rng() % 2 ? specials[rng() % 8] : static_cast<T>(static_cast<double>(rng() % 2001) / 1000.0 - 1.0);
+    }
+    return values;
+}
+
+template <typename T>
+bool checkKernels(std::mt19937_64& rng) {
+    const vecmath::Comparison comparisons[] = {vecmath::Comparison::Less, vecmath::Comparison::LessEqual,
+                                               vecmath::Comparison::Greater, vecmath::Comparison::GreaterEqual,
+                                               vecmath::Comparison::Equal};
+    bool ok = true;
+    for (std::size_t n = 0; n < 40; ++n) {
+        std::vector<T> a = specialValues<T>(rng, n);
+        std::vector<T> b = specialValues<T>(rng, n);
+        std::vector<T> c = specialValues<T>(rng, n);
+        std::vector<T> out(n);
+        for (vecmath::Comparison op : comparisons) {
+            vecmath::compare(op, a.data(), b.data(), out.data(), n);
+            for (std::size_t i = 0; i < n; ++i) {
+                bool holds = op == vecmath::Comparison::Less        ? a[i] < b[i]
+                             : op == vecmath::Comparison::LessEqual ? a[i] <= b[i]
+                             : op == vecmath::Comparison::Greater   ? a[i] > b[i]
+                             : op == vecmath::Comparison::GreaterEqual ? a[i] >= b[i]
+                                                                        : a[i] == b[i];
+                ok &= sameBits(out[i], holds ? T(1) : T(0));
+            }
+        }
+        vecmath::select(c.data(), a.data(), b.data(), out.data(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ok &= sameBits(out[i], c[i] != T(0) ? a[i] : b[i]);
+        }
+        vecmath::min(a.data(), b.data(), out.data(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ok &= sameBits(out[i], std::min(a[i], b[i]));
+        }
+        vecmath::max(a.data(), b.data(), out.data(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ok &= sameBits(out[i], std::max(a[i], b[i]));
+        }
+        // Resultado sobre una de las entradas, como lo usa BatchEvaluator.
+        std::vector<T> inPlace = a;
+        vecmath::min(inPlace.data(), b.data(), inPlace.data(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+            ok &= sameBits(inPlace[i], std::min(a[i], b[i]));
+        }
+    }
+    return ok;
+}
+
+// Mismo valor o mismo mensaje de error que Evaluator, fila por fila, en
+// BatchEvaluator Exact (de a una fila, porque el error de un lote corta en
+// la primera fila que falla) y en RegisterVM.
+bool checkBackends(std::mt19937_64& rng) {
+    const char* const texts[] = {
+        "select(x < y, x, y) - min(x, y)",
+        "select(x >= 0, sqrt(abs(x)), -x) * (y == 0.5)",
+        "max(x, y) + min(y, x) + (x <= y) - (x > y)",
+        "select(select(x, y, 0), x * y, x / 2) + select(y > x + 1, 3, -3)",
+        "x < y == (y > x)",
+        "-x < 1 + y * 2",
+        "select(x < 0.5, 1 / (x - x), 2)",
+        "select(y, log(x), 0)",
+    };
+    std::vector<double> values = specialValues<double>(rng, 2000);
+    bool ok = true;
+    for (const char* text : texts) {
+        TokenList postfix = compile(text);
+        RegisterVM vm(postfix);
+        ok &= vm.compiled();
+        for (std::size_t i = 0; i + 1 < values.size(); i += 2) {
+            double x = values[i];
+            double y = values[i + 1];
+            SymbolTable symbols;
+            symbols.set("x", x);
+            symbols.set("y", y);
+            double expected = 0.0;
+            Error expectedError;
+            bool expectedOk = Evaluator().evalPostfix(postfix, symbols, expected, expectedError);
+
+            double actual = 0.0;
+            Error actualError;
+            bool actualOk = vm.evaluate(symbols, actual, actualError);
+            ok &= expectedOk == actualOk && (expectedOk ? sameBits(expected, actual)
+                                                        : expectedError.message() == actualError.message());
+
+            BatchEvaluator::Columns columns;
+            columns["x"] = &x;
+            columns["y"] = &y;
+            double batch = 0.0;
+            std::string batchError;
+            try {
+                BatchEvaluator(vecmath::Mode::Exact).evalPostfix(postfix, columns, symbols, &batch, 1);
+            } catch (const EdaError& err) {
+                batchError = err.what();
+            }
+            ok &= expectedOk ? batchError.empty() && sameBits(expected, batch)
+                             : batchError == expectedError.message() + " en fila 0";
+        }
+    }
+    // Las dos ramas se evaluan: el error de la rama no elegida tambien cuenta.
+    SymbolTable symbols;
+    symbols.set("x", 4.0);
+    double result = 0.0;
+    Error error;
+    ok &= !Evaluator().evalPostfix(compile("select(x > 0, 1, 1 / (x - x))"), symbols, result, error) &&
+          error.kind == ErrorKind::DIVISION_BY_ZERO;
+    return ok;
+}
+
+bool checkRational() {
+    BasicSymbolTable<Rational> symbols;
+    const char* const texts[] = {"1 / 3 < 0.34", "select(2 / 6 == 1 / 3, 5, 6)", "0.1 + 0.2 == 0.3"};
+    const double expected[] = {1.0, 5.0, 1.0};
+    bool ok = true;
+    for (std::size_t i = 0; i < 3; ++i) {
+        ok &= BasicEvaluator<Rational>().evalPostfix(compile(texts[i]), symbols).toDouble() == expected[i];
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 22;
+    std::size_t scalarRows = std::min<std::size_t>(rows, 1 << 18);
+    std::mt19937_64 rng(49);
+    std::uniform_real_distribution<double> dist(0.0, 2.0);
+    std::vector<double> x(rows);
+    std::vector<double> t(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        x[i] = dist(rng);
+        t[i] = dist(rng);
+    }
+
+    std::cout << kFormula << ", " << rows << " filas" << std::endl;
+    bool same = true;
+    Timing random = measure(x, t, scalarRows, same);
+    report("condiciones al azar", random, rows, scalarRows);
+
+    // Ordenadas por x - t la condicion es falsa y despues verdadera: un solo cambio.
+    std::vector<std::size_t> order(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](std::size_t a, std::size_t b) { return x[a] - t[a] > x[b] - t[b]; });
+    std::vector<double> sortedX(rows);
+    std::vector<double> sortedT(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        sortedX[i] = x[order[i]];
+        sortedT[i] = t[order[i]];
+    }
+    Timing sorted = measure(sortedX, sortedT, scalarRows, same);
+    report("condiciones ordenadas", sorted, rows, scalarRows);
+    std::cout << "    al azar / ordenadas: con saltos " << random.branching / sorted.branching << "x, sin saltos "
+              << random.batch / sorted.batch << "x" << std::endl
+              << std::endl;
+
+    bool kernels = checkKernels<double>(rng) && checkKernels<float>(rng);
+    bool backends = checkBackends(rng);
+    bool rational = checkRational();
+    std::cout << (kernels ? "ok    " : "FALLA ") << "compare/select/min/max de vecmath iguales a la version escalar"
+              << std::endl;
+    std::cout << (same && backends ? "ok    " : "FALLA ")
+              << "BatchEvaluator y RegisterVM iguales bit a bit a Evaluator, con los mismos errores" << std::endl;
+    std::cout << (rational ? "ok    " : "FALLA ") << "comparaciones y select en modo racional" << std::endl;
+    return kernels && same && backends && rational ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Script de muchas lineas (asignaciones, expresiones largas, errores de
+// sintaxis y de evaluacion y algun comando) ejecutado con el bucle serie
+// del REPL y con ScriptRunner con 1, 2, 4 y hardware_concurrency() hilos de
+// analisis. Reporta lineas por segundo y verifica que la salida de la
+// tuberia sea identica byte a byte a la del bucle serie, tambien con `exit`
+// a mitad del script.
+// Uso: pipeline [lineas]
+#include "bench_util.hpp"
+#include "script_runner.hpp"
+#include "session.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+std::string makeScript(std::size_t lines) {
+    std::mt19937_64 rng(44);
+    std::ostringstream script;
+    const char* names[] = {"a", "b", "c", "d"};
+    for (std::size_t i = 0; i < lines; ++i) {
+        std::size_t kind = rng() % 20;
+        if (kind == 0) {
+            script << "1 + * 2" << '\n';
+        } else if (kind == 1) {
+            script << "a / (b - b)" << '\n';
+        } else if (kind == 2) {
+            script << "show " << names[rng() % 4] << '\n';
+        } else if (kind == 3) {
+            script << '\n';
+        } else {
+            if (kind % 2 == 0) {
+                script << names[rng() % 4] << " = ";
+            }
+            std::size_t terms = 4 + rng() % 12;
+            for (std::size_t t = 0; t < terms; ++t) {
+                if (t > 0) {
+                    script << (rng() % 2 ? " + " : " - ");
+                }
+                script << "sin(" << names[rng() % 4] << " * " << (rng() % 1000) / 100.0 << ") * ("
+                       << names[rng() % 4] << " + " << rng() % 10 << ")^2";
+            }
+            script << '\n';
+        }
+    }
+    return script.str();
+}
+
+std::string prologue() {
+    return "a = 1.5\nb = -0.25\nc = 2\nd = 0.75\n";
+}
+
+std::string runSerial(const std::string& script) {
+    Session session;
+    std::istringstream in(script);
+    std::ostringstream out;
+    std::string line;
+    while (true) {
+        out << ">> ";
+        if (!std::getline(in, line)) {
+            break;
+        }
+        if (!session.handleLine(line, out)) {
+            break;
+        }
+    }
+    return out.str();
+}
+
+std::string runPipeline(const std::string& script, std::size_t workers) {
+    Session session;
+    ScriptRunner runner(session, workers);
+    std::istringstream in(script);
+    std::ostringstream out;
+    runner.run(in, out);
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::size_t cores = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    std::vector<std::size_t> workerCounts = {1, 2, 4};
+    if (std::find(workerCounts.begin(), workerCounts.end(), cores) == workerCounts.end()) {
+        workerCounts.push_back(cores);
+    }
+    std::string script = prologue() + makeScript(lines);
+    std::cout << "nucleos disponibles: " << cores << ", " << lines << " lineas (" << script.size() / 1024
+              << " KiB)" << std::endl;
+
+    std::string expected;
+    {
+        bench::Timer timer;
+        expected = runSerial(script);
+        bench::report("  bucle serie", timer.seconds(), lines);
+    }
+
+    bool ok = true;
+    for (std::size_t workers : workerCounts) {
+        std::string output;
+        double best = 0.0;
+        for (int round = 0; round < 3; ++round) {
+            bench::Timer timer;
+            output = runPipeline(script, workers);
+            double seconds = timer.seconds();
+            best = round == 0 ? seconds : std::min(best, seconds);
+        }
+        bench::report("  tuberia, " + std::to_string(workers) + " hilo(s) de analisis", best, lines);
+        if (output != expected) {
+            std::cout << "FALLA salida distinta con " << workers << " hilos" << std::endl;
+            ok = false;
+        }
+    }
+
+    std::string stopped = prologue() + makeScript(5000) + "exit\n" + makeScript(5000);
+    for (std::size_t workers : workerCounts) {
+        ok &= runPipeline(stopped, workers) == runSerial(stopped);
+    }
+    ok &= runPipeline("", 2) == runSerial("") && runPipeline("1 + 2", 2) == runSerial("1 + 2");
+
+    std::cout << std::endl
+              << (ok ? "ok    " : "FALLA ") << "salida identica al bucle serie, con y sin exit" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Polinomios con exponentes enteros: `^` via std::pow frente a los nodos
+// POWI que produce Optimizer::lowerIntegerPowers.
+#include "batch_evaluator.hpp"
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kRows = 200000;
+
+const char* const kPolynomials[] = {
+    "3*x^3 - 2*x^2 + x - 7",
+    "x^4 + 4*x^3*y + 6*x^2*y^2 + 4*x*y^3 + y^4",
+    "(x^2 + y^2)^3 - 5/x^2 + y^-3",
+    "x^10 - x^9 + x^8 - x^7 + x^6 - x^5 + x^4 - x^3 + x^2 - x + 1"
+};
+
+// Relativo lejos de cero y absoluto cerca de las raices, donde la
+// cancelacion entre terminos amplifica cualquier diferencia.
+double mixedError(double a, double b) {
+    return std::fabs(a - b) / std::max(std::fabs(b), 1.0);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(0.5, 2.0);
+    std::vector<double> xs(kRows);
+    std::vector<double> ys(kRows);
+    for (std::size_t i = 0; i < kRows; ++i) {
+        xs[i] = dist(rng);
+        ys[i] = dist(rng);
+    }
+
+    Tokenizer tokenizer;
+    Parser parser;
+    Optimizer optimizer;
+    Evaluator evaluator;
+    SymbolTable symbols;
+
+    for (const char* text : kPolynomials) {
+        std::cout << text << std::endl;
+        TokenList postfix = parser.toPostfix(tokenizer.tokenize(text));
+        Tree tree = parser.buildTreeFromPostfix(postfix);
+        optimizer.foldConstants(tree);
+        optimizer.lowerIntegerPowers(tree);
+        TokenList lowered = optimizer.toPostfix(tree);
+
+        std::vector<double> reference(kRows);
+        {
+            bench::Timer timer;
+            for (std::size_t i = 0; i < kRows; ++i) {
+                symbols.set("x", xs[i]);
+                symbols.set("y", ys[i]);
+                reference[i] = evaluator.evalPostfix(postfix, symbols);
+            }
+            bench::report("  Evaluator con std::pow", timer.seconds(), kRows);
+        }
+        double worst = 0.0;
+        {
+            bench::Timer timer;
+            for (std::size_t i = 0; i < kRows; ++i) {
+                symbols.set("x", xs[i]);
+                symbols.set("y", ys[i]);
+                double value = evaluator.evalPostfix(lowered, symbols);
+                double err = mixedError(value, reference[i]);
+                if (err > worst) {
+                    worst = err;
+                }
+            }
+            bench::report("  Evaluator con POWI", timer.seconds(), kRows);
+        }
+
+        BatchEvaluator::Columns columns;
+        columns["x"] = xs.data();
+        columns["y"] = ys.data();
+        std::vector<double> out(kRows);
+        BatchEvaluator batch(vecmath::Mode::Exact);
+        {
+            bench::Timer timer;
+            batch.evalPostfix(postfix, columns, symbols, out.data(), kRows);
+            bench::report("  BatchEvaluator con std::pow", timer.seconds(), kRows);
+        }
+        {
+            bench::Timer timer;
+            batch.evalPostfix(lowered, columns, symbols, out.data(), kRows);
+            bench::report("  BatchEvaluator con POWI", timer.seconds(), kRows);
+        }
+        std::cout << "  error maximo (relativo, absoluto cerca de 0): " << std::scientific << worst << std::fixed << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+// tree, postfix y prefix sobre arboles grandes: la version anterior
+// (recursiva, un std::string de prefijo por nivel y std::endl por linea)
+// contra la actual. Verifica que la salida sea identica byte a byte; los
+// tiempos se toman escribiendo a /dev/null para que cuente cada flush.
+#include "bench_util.hpp"
+#include "optimizer.hpp"
+#include "printer.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace edacal;
+
+namespace {
+
+// Implementacion anterior, copiada tal cual como referencia.
+void oldTreeNode(const Tree::Node* node, const std::string& prefix, bool isLeft, std::ostream& os) {
+    if (!node) {
+        return;
+    }
+    if (node->right) {
+        std::string nextPrefix = prefix + (isLeft ? "|   " : "    ");
+        oldTreeNode(node->right, nextPrefix, false, os);
+    }
+    os << prefix;
+    if (!prefix.empty()) {
+        os << (isLeft ? "|-- " : "\\-- ");
+    }
+    os << tokenToString(node->token) << std::endl;
+    if (node->left) {
+        std::string nextPrefix = prefix + (isLeft ? "|   " : "    ");
+        oldTreeNode(node->left, nextPrefix, true, os);
+    }
+}
+
+void oldPrintTree(const Tree& tree, std::ostream& os) {
+    oldTreeNode(tree.getRoot(), "", false, os);
+}
+
+void oldPrintPostfix(const TokenList& tokens, std::ostream& os) {
+    bool first = true;
+    for (auto it = tokens.begin(); it != tokens.end(); ++it) {
+        if (it->type == TokenType::END) {
+            break;
+        }
+        if (!first) {
+            os << ' ';
+        }
+        os << tokenToString(*it);
+        first = false;
+    }
+    os << std::endl;
+}
+
+void oldCollectPrefix(const Tree::Node* node, LinkedList<std::string>& output) {
+    if (!node) {
+        return;
+    }
+    output.push_back(tokenToString(node->token));
+    oldCollectPrefix(node->left, output);
+    oldCollectPrefix(node->right, output);
+}
+
+void oldPrintPrefix(const Tree& tree, std::ostream& os) {
+    LinkedList<std::string> items;
+    oldCollectPrefix(tree.getRoot(), items);
+    bool first = true;
+    for (auto it = items.begin(); it != items.end(); ++it) {
+        if (!first) {
+            os << ' ';
+        }
+        os << *it;
+        first = false;
+    }
+    os << std::endl;
+}
+
+Tree::Node* leaf(std::mt19937_64& rng) {
+    if (rng() % 2 == 0) {
+        return new Tree::Node(Token(TokenType::IDENT, "x" + std::to_string(rng() % 100)));
+    }
+    double value = static_cast<double>(rng() % 100000) / 64.0;
+    return new Tree::Node(Token(TokenType::NUMBER, std::to_string(value), value));
+}
+
+Tree::Node* op(std::mt19937_64& rng) {
+    static const TokenType types[] = {TokenType::PLUS, TokenType::MINUS, TokenType::MUL, TokenType::DIV};
+    static const char* const lexemes[] = {"+", "-", "*", "/"};
+    std::size_t pick = rng() % 4;
+    return new Tree::Node(Token(types[pick], lexemes[pick]));
+}
+
+// Arbol completo con `levels` niveles.
+Tree::Node* balanced(std::size_t levels, std::mt19937_64& rng) {
+    if (levels <= 1) {
+        return leaf(rng);
+    }
+    Tree::Node* node = op(rng);
+    node->left = balanced(levels - 1, rng);
+    node->right = balanced(levels - 1, rng);
+    return node;
+}
+
+// Peine: cada operador tiene una hoja a la derecha y sigue por la izquierda.
+Tree::Node* comb(std::size_t depth, std::mt19937_64& rng) {
+    Tree::Node* root = leaf(rng);
+    for (std::size_t i = 0; i < depth; ++i) {
+        Tree::Node* node = op(rng);
+        node->left = root;
+        node->right = leaf(rng);
+        root = node;
+    }
+    return root;
+}
+
+template <typename Print>
+std::string capture(Print print) {
+    std::ostringstream oss;
+    print(oss);
+    return oss.str();
+}
+
+template <typename Print>
+void time(const std::string& label, std::size_t nodes, Print print) {
+    std::ofstream sink("/dev/null");
+    bench::Timer timer;
+    print(sink);
+    bench::report(label, timer.seconds(), nodes);
+}
+
+bool compareCase(const std::string& name, const Tree& tree, std::size_t nodes) {
+    const Printer printer;
+    TokenList postfix = Optimizer().toPostfix(tree);
+
+    std::cout << name << " (" << nodes << " nodos)" << std::endl;
+    time("  tree anterior", nodes, [&](std::ostream& os) { oldPrintTree(tree, os); });
+    time("  tree actual", nodes, [&](std::ostream& os) { printer.printTree(tree, os); });
+    time("  postfix anterior", nodes, [&](std::ostream& os) { oldPrintPostfix(postfix, os); });
+    time("  postfix actual", nodes, [&](std::ostream& os) { printer.printPostfix(postfix, os); });
+    time("  prefix anterior", nodes, [&](std::ostream& os) { oldPrintPrefix(tree, os); });
+    time("  prefix actual", nodes, [&](std::ostream& os) { printer.printPrefix(tree, os); });
+
+    bool same = capture([&](std::ostream& os) { oldPrintTree(tree, os); }) ==
+                    capture([&](std::ostream& os) { printer.printTree(tree, os); }) &&
+                capture([&](std::ostream& os) { oldPrintPostfix(postfix, os); }) ==
+                    capture([&](std::ostream& os) { printer.printPostfix(postfix, os); }) &&
+                capture([&](std::ostream& os) { oldPrintPrefix(tree, os); }) ==
+                    capture([&](std::ostream& os) { printer.printPrefix(tree, os); });
+    std::cout << (same ? "ok    " : "FALLA ") << "salida identica byte a byte" << std::endl << std::endl;
+    return same;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(3);
+    bool ok = true;
+
+    for (std::size_t levels : {5, 17, 20}) {
+        Tree tree;
+        tree.setRoot(balanced(levels, rng));
+        ok &= compareCase("balanceado, " + std::to_string(levels) + " niveles", tree, (1u << levels) - 1);
+    }
+    {
+        const std::size_t depth = 2000;
+        Tree tree;
+        tree.setRoot(comb(depth, rng));
+        ok &= compareCase("peine de profundidad " + std::to_string(depth), tree, 2 * depth + 1);
+    }
+    {
+        Tree tree;
+        ok &= capture([&](std::ostream& os) { Printer().printTree(tree, os); }) == "(arbol vacio)\n";
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+// Optimizer::reassociate: latencia de sumas y productos largos con y sin
+// rebalanceo (Evaluator sobre la posfija y ParallelEvaluator sobre el arbol)
+// y exactitud de la suma secuencial, por pares y compensada frente a la
+// suma exacta en Rational. Verifica la profundidad O(log n), que el
+// compensado no pierda contra los otros dos, que ParallelEvaluator de el
+// mismo resultado que Evaluator sobre cadenas compensadas y que
+// Optimizer::optimize reasocie tambien cadenas largas.
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "parallel_evaluator.hpp"
+#include "parser.hpp"
+#include "rational.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+Token number(double value) {
+    return Token(TokenType::NUMBER, std::to_string(value), value);
+}
+
+// v0 op v1 op ... en posfija, intercalando la variable x cada 8 operandos
+// para que nada se pliegue.
+TokenList chain(const std::vector<double>& values, TokenType type, const char* lexeme) {
+    TokenList postfix;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i % 8 == 7) {
+            postfix.push_back(Token(TokenType::IDENT, "x"));
+        } else {
+            postfix.push_back(number(values[i]));
+        }
+        if (i > 0) {
+            postfix.push_back(Token(type, lexeme));
+        }
+    }
+    postfix.push_back(Token(TokenType::END, ""));
+    return postfix;
+}
+
+std::size_t depth(const Tree::Node* root) {
+    std::size_t deepest = 0;
+    std::vector<std::pair<const Tree::Node*, std::size_t>> pending(1, std::make_pair(root, std::size_t(1)));
+    while (!pending.empty()) {
+        std::pair<const Tree::Node*, std::size_t> item = pending.back();
+        pending.pop_back();
+        deepest = std::max(deepest, item.second);
+        if (item.first->left) {
+            pending.push_back(std::make_pair(item.first->left, item.second + 1));
+        }
+        if (item.first->right) {
+            pending.push_back(std::make_pair(item.first->right, item.second + 1));
+        }
+    }
+    return deepest;
+}
+
+template <typename Eval>
+double best(const std::string& label, std::size_t nodes, Eval eval) {
+    double fastest = 0.0;
+    double value = 0.0;
+    for (int round = 0; round < 5; ++round) {
+        bench::Timer timer;
+        value = eval();
+        double seconds = timer.seconds();
+        fastest = round == 0 ? seconds : std::min(fastest, seconds);
+    }
+    bench::report(label, fastest, nodes);
+    return value;
+}
+
+bool latency(const std::string& name, TokenType type, const char* lexeme, std::size_t count, std::mt19937_64& rng,
+             SymbolTable& symbols) {
+    std::uniform_real_distribution<double> dist(type == TokenType::MUL ? 0.999 : -1.0,
+                                                type == TokenType::MUL ? 1.001 : 1.0);
+    std::vector<double> values(count);
+    for (double& v : values) {
+        v = dist(rng);
+    }
+    TokenList postfix = chain(values, type, lexeme);
+    Parser parser;
+    Optimizer optimizer;
+    Tree original = parser.buildTreeFromPostfix(postfix);
+    Tree balanced = parser.buildTreeFromPostfix(postfix);
+    optimizer.reassociate(balanced);
+    Tree compensated = parser.buildTreeFromPostfix(postfix);
+    optimizer.reassociate(compensated, Optimizer::Summation::Compensated);
+    TokenList balancedPostfix = optimizer.toPostfix(balanced);
+    TokenList compensatedPostfix = optimizer.toPostfix(compensated);
+
+    std::size_t nodes = original.getRoot()->size;
+    std::size_t before = depth(original.getRoot());
+    std::size_t after = depth(balanced.getRoot());
+    std::cout << name << ": " << count << " operandos, profundidad " << before << " -> " << after << std::endl;
+
+    Evaluator evaluator;
+    ParallelEvaluator walker(1);
+    best("  Evaluator, peine", nodes, [&] { return evaluator.evalPostfix(postfix, symbols); });
+    best("  Evaluator, balanceado", nodes, [&] { return evaluator.evalPostfix(balancedPostfix, symbols); });
+    double sequential =
+        best("  Evaluator, compensado", nodes, [&] { return evaluator.evalPostfix(compensatedPostfix, symbols); });
+    best("  arbol, peine", nodes, [&] { return walker.evaluate(original, symbols); });
+    best("  arbol, balanceado", nodes, [&] { return walker.evaluate(balanced, symbols); });
+
+    ParallelEvaluator parallel(4);
+    double split = parallel.evaluate(compensated, symbols);
+    bool ok = after <= static_cast<std::size_t>(std::ceil(std::log2(static_cast<double>(count)))) + 1 &&
+              std::memcmp(&split, &sequential, sizeof(split)) == 0;
+    return ok;
+}
+
+// Suma mal condicionada: magnitudes de 1e-6 a 1e6 con signos mezclados.
+bool accuracy(std::size_t count, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> exponent(-6.0, 6.0);
+    std::vector<double> values(count);
+    Rational exact;
+    double absSum = 0.0;
+    for (double& v : values) {
+        v = std::pow(10.0, exponent(rng)) * (rng() % 2 ? 1.0 : -1.0);
+        exact = exact + Rational::fromDouble(v);
+        absSum += std::fabs(v);
+    }
+    TokenList postfix;
+    for (std::size_t i = 0; i < count; ++i) {
+        postfix.push_back(number(values[i]));
+        if (i > 0) {
+            postfix.push_back(Token(TokenType::PLUS, "+"));
+        }
+    }
+    postfix.push_back(Token(TokenType::END, ""));
+
+    Parser parser;
+    Optimizer optimizer;
+    Evaluator evaluator;
+    SymbolTable symbols;
+    Tree balanced = parser.buildTreeFromPostfix(postfix);
+    optimizer.reassociate(balanced);
+    Tree compensated = parser.buildTreeFromPostfix(postfix);
+    optimizer.reassociate(compensated, Optimizer::Summation::Compensated);
+
+    double reference = exact.toDouble();
+    double sequentialError = std::fabs(evaluator.evalPostfix(postfix, symbols) - reference);
+    double pairwiseError = std::fabs(evaluator.evalPostfix(optimizer.toPostfix(balanced), symbols) - reference);
+    double compensatedError =
+        std::fabs(evaluator.evalPostfix(optimizer.toPostfix(compensated), symbols) - reference);
+
+    const double eps = std::ldexp(1.0, -53);
+    double bound = 2.0 * eps * std::fabs(reference) + static_cast<double>(count) * eps * eps * absSum;
+    std::cout << "exactitud, " << count << " sumandos en [1e-6, 1e6] con signo (error absoluto)" << std::endl
+              << std::scientific << "  secuencial   " << sequentialError << std::endl
+              << "  por pares    " << pairwiseError << std::endl
+              << "  compensada   " << compensatedError << " (cota " << bound << ")" << std::fixed << std::endl;
+    return compensatedError <= bound && compensatedError <= sequentialError && compensatedError <= pairwiseError;
+}
+
+// p + o + ... + o + n con p = 10^16, o = 1 y n = -p: en orden se pierde
+// cada 1 y queda 0; Optimizer::optimize con fastMath reasocia la cadena
+// entera aunque sea larga.
+bool optimizeLongChain(std::size_t count) {
+    TokenList postfix;
+    for (std::size_t i = 0; i < count; ++i) {
+        postfix.push_back(Token(TokenType::IDENT, i == 0 ? "p" : (i + 1 == count ? "n" : "o")));
+        if (i > 0) {
+            postfix.push_back(Token(TokenType::PLUS, "+"));
+        }
+    }
+    postfix.push_back(Token(TokenType::END, ""));
+
+    SymbolTable symbols;
+    symbols.set("p", 1e16);
+    symbols.set("o", 1.0);
+    symbols.set("n", -1e16);
+    Evaluator evaluator;
+    double sequential = evaluator.evalPostfix(postfix, symbols);
+    double optimized = evaluator.evalPostfix(Optimizer().optimize(postfix, true), symbols);
+    bool ok = sequential == 0.0 && optimized > 0.0;
+    std::cout << (ok ? "ok    " : "FALLA ") << "optimize reasocia una cadena de " << count << " operandos ("
+              << sequential << " -> " << optimized << ")" << std::endl;
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(5);
+    SymbolTable symbols;
+    symbols.set("x", 1.0);
+
+    bool ok = true;
+    for (std::size_t count : {1000, 100000, 1000000}) {
+        ok &= latency("suma", TokenType::PLUS, "+", count, rng, symbols);
+        ok &= latency("producto", TokenType::MUL, "*", count, rng, symbols);
+        std::cout << std::endl;
+    }
+    ok &= accuracy(100000, rng);
+    std::cout << std::endl;
+    ok &= optimizeLongChain(20000);
+    std::cout << std::endl
+              << (ok ? "ok    " : "FALLA ")
+              << "profundidad O(log n), compensada dentro de la cota y ParallelEvaluator igual a Evaluator"
+              << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// sum(i, 1, N, cuerpo) frente al texto expandido cuerpo(1) + cuerpo(2) +
+// ... + cuerpo(N), de N = 10^2 a 10^6: tokenizar, pasar a posfija y evaluar
+// por separado y en total. Verifica que ambos den el mismo double bit a bit
+// (la reduccion suma en el mismo orden que el peine del Parser), lo mismo
+// con prod y con bucles anidados, y los errores de limites.
+// Uso: reduction [N maximo]
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using namespace edacal;
+
+namespace {
+
+struct Timing {
+    double tokenize;
+    double parse;
+    double evaluate;
+    double value;
+};
+
+Timing run(const std::string& text, SymbolTable& symbols) {
+    Tokenizer tokenizer;
+    Parser parser;
+    Evaluator evaluator;
+    Timing timing;
+    bench::Timer timer;
+    TokenList tokens = tokenizer.tokenize(text);
+    timing.tokenize = timer.seconds();
+    bench::Timer parseTimer;
+    TokenList postfix = parser.toPostfix(tokens);
+    timing.parse = parseTimer.seconds();
+    bench::Timer evalTimer;
+    timing.value = evaluator.evalPostfix(postfix, symbols);
+    timing.evaluate = evalTimer.seconds();
+    return timing;
+}
+
+// Reemplaza cada '#' del cuerpo por `index` (un numero o el nombre del indice).
+std::string instantiate(const std::string& body, const std::string& index) {
+    std::string out;
+    for (char c : body) {
+        if (c == '#') {
+            out += index;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string expand(const std::string& body, const char* op, std::size_t n) {
+    std::string text;
+    for (std::size_t i = 1; i <= n; ++i) {
+        if (i > 1) {
+            text += op;
+        }
+        text += '(';
+        text += instantiate(body, std::to_string(i));
+        text += ')';
+    }
+    return text;
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+void report(const std::string& label, const Timing& timing, std::size_t n) {
+    std::cout << "  " << label << std::endl;
+    bench::report("    tokenizar", timing.tokenize, n);
+    bench::report("    posfija", timing.parse, n);
+    bench::report("    evaluar", timing.evaluate, n);
+    bench::report("    total", timing.tokenize + timing.parse + timing.evaluate, n);
+}
+
+bool compare(const std::string& body, std::size_t n, SymbolTable& symbols) {
+    std::string expanded = expand(body, " + ", n);
+    std::string loop = "sum(i, 1, " + std::to_string(n) + ", " + instantiate(body, "i") + ")";
+    std::cout << "N = " << n << " (texto expandido: " << expanded.size() / 1024 << " KiB)" << std::endl;
+    Timing slow = run(expanded, symbols);
+    Timing fast = run(loop, symbols);
+    report("expandido", slow, n);
+    report("sum", fast, n);
+    std::cout << "    aceleracion total "
+              << (slow.tokenize + slow.parse + slow.evaluate) / (fast.tokenize + fast.parse + fast.evaluate)
+              << "x" << std::endl;
+    if (!sameBits(slow.value, fast.value)) {
+        std::cout << "FALLA valores distintos: " << slow.value << " vs " << fast.value << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool expectError(const std::string& text, const std::string& message, SymbolTable& symbols) {
+    try {
+        run(text, symbols);
+    } catch (const EdaError& err) {
+        return err.what() == message;
+    }
+    return false;
+}
+
+// Como expectError, y ademas la columna del error estructurado.
+bool expectErrorAt(const std::string& text, const std::string& message, std::size_t column, SymbolTable& symbols) {
+    TokenList postfix = Parser().toPostfix(Tokenizer().tokenize(text));
+    double value = 0.0;
+    Error error;
+    return !Evaluator().evalPostfix(postfix, symbols, value, error) && error.message() == message &&
+           error.column == column;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t maxN = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    SymbolTable symbols;
+    symbols.set("x", 0.5);
+    const std::string body = "sin(# * x) / # + x ^ 2";
+
+    bool ok = true;
+    for (std::size_t n = 100; n <= maxN; n *= 10) {
+        ok &= compare(body, n, symbols);
+        std::cout << std::endl;
+    }
+
+    ok &= sameBits(run("prod(i, 1, 20, 1 + x / i)", symbols).value,
+                   run(expand("1 + x / #", " * ", 20), symbols).value);
+    ok &= run("sum(i, 1, 30, sum(j, i, 30, i * j))", symbols).value == 112840.0;
+    ok &= run("sum(i, 5, 4, i) + prod(i, 5, 4, i)", symbols).value == 1.0;
+    ok &= expectError("sum(i, 1, x, i)", "sum requiere limites enteros", symbols);
+    ok &= expectError("prod(i, 1, 3)", "numero de argumentos invalido para 'prod'", symbols);
+    ok &= expectError("sum(i, 1, 3, 1 / (i - 2))", "division por cero", symbols);
+    ok &= expectErrorAt("1 + sum(i, 1, 10^15, i)", "sum excede el maximo de 10000000 iteraciones", 4, symbols);
+    ok &= expectErrorAt("sum(i, 1, 10^4, prod(j, 1, 10^4, 1))", "prod excede el maximo de 10000000 iteraciones", 16,
+                        symbols);
+    std::cout << (ok ? "ok    " : "FALLA ") << "sum/prod igual bit a bit a la expresion expandida" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// RegisterVM frente a Evaluator::evalPostfix (la maquina de pila) sobre un
+// corpus de formulas cortas dominadas por `var op const`, `var op var`,
+// `x^2` y `-x`, con la posfija del Parser y con la de
+// Optimizer::lowerIntegerPowers. Reporta evaluaciones por segundo de cada
+// formula y del corpus entero. Verifica que ambos den el mismo double bit a
+// bit con valores al azar y el mismo error (variable no definida, division
+// por cero, dominio, sum/prod sin compilar).
+// Uso: register_vm [evaluaciones por formula]
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "register_vm.hpp"
+#include "tokenizer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const char* const kCorpus[] = {
+    "x * 2 + y",
+    "x ^ 2 + 3 * x - 1",
+    "-x * y + z",
+    "(x - y) * (x + y) / z",
+    "x * x + y * y + z * z",
+    "2 * x ^ 3 - 4 * x ^ 2 + x / 3",
+    "sqrt(x ^ 2 + y ^ 2)",
+    "sin(x) * y / 2 + cos(z)",
+    "(x - 1.5) ^ 2 / (2 * z ^ 2)",
+    "max(x, y) - min(y, z) + abs(-x)",
+};
+
+TokenList compile(const std::string& text, bool lowered) {
+    TokenList postfix = Parser().toPostfix(Tokenizer().tokenize(text));
+    if (!lowered) {
+        return postfix;
+    }
+    Optimizer optimizer;
+    Tree tree = Parser().buildTreeFromPostfix(postfix);
+    optimizer.lowerIntegerPowers(tree);
+    return optimizer.toPostfix(tree);
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// Mismo valor o mismo mensaje de error que Evaluator.
+bool sameOutcome(const TokenList& postfix, const RegisterVM& vm, SymbolTable& symbols) {
+    double expected = 0.0;
+    double actual = 0.0;
+    Error expectedError;
+    Error actualError;
+    bool expectedOk = Evaluator().evalPostfix(postfix, symbols, expected, expectedError);
+    bool actualOk = vm.evaluate(symbols, actual, actualError);
+    if (expectedOk != actualOk) {
+        return false;
+    }
+    return expectedOk ? sameBits(expected, actual) : expectedError.message() == actualError.message();
+}
+
+bool checkCorpus(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> value(-4.0, 4.0);
+    for (const char* text : kCorpus) {
+        for (int lowered = 0; lowered < 2; ++lowered) {
+            TokenList postfix = compile(text, lowered != 0);
+            RegisterVM vm(postfix);
+            if (!vm.compiled()) {
+                return false;
+            }
+            for (int round = 0; round < 10000; ++round) {
+                SymbolTable symbols;
+                symbols.set("x", value(rng));
+                symbols.set("y", value(rng));
+                symbols.set("z", round % 100 == 0 ? 0.0 : value(rng));
+                if (!sameOutcome(postfix, vm, symbols)) {
+                    std::cout << "FALLA resultado distinto en " << text << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool checkEdgeCases() {
+    SymbolTable symbols;
+    symbols.set("x", 2.0);
+    symbols.set("ans", 0.5);
+    // La ultima pasa de los valores que evaluate() guarda sin pedir memoria.
+    std::string chain = "x";
+    for (int i = 1; i <= 100; ++i) {
+        chain += " + x * " + std::to_string(i);
+    }
+    const char* const texts[] = {"1 / (x - x)", "sqrt(-x) + 1", "x + nadie * 2", "log(x - 3)",
+                                 "ans * x", "7", "x", "sum(i, 1, 10, i * x)", chain.c_str()};
+    bool ok = true;
+    for (const char* text : texts) {
+        TokenList postfix = compile(text, false);
+        RegisterVM vm(postfix);
+        ok &= sameOutcome(postfix, vm, symbols);
+    }
+    ok &= !RegisterVM(compile("sum(i, 1, 10, i * x)", false)).compiled();
+    ok &= RegisterVM(compile("x ^ 2", true)).instructionCount() == 2;
+    ok &= RegisterVM(compile("x * 2 + y", false)).instructionCount() == 3;
+    return ok;
+}
+
+struct Timing {
+    double stack;
+    double registers;
+};
+
+Timing measure(const std::string& text, bool lowered, std::size_t evaluations, bool& same) {
+    TokenList postfix = compile(text, lowered);
+    RegisterVM vm(postfix);
+    SymbolTable symbols;
+    symbols.set("x", 1.25);
+    symbols.set("y", -0.5);
+    symbols.set("z", 3.0);
+    Evaluator evaluator;
+    Timing timing;
+
+    double stackSum = 0.0;
+    bench::Timer stackTimer;
+    for (std::size_t i = 0; i < evaluations; ++i) {
+        stackSum += evaluator.evalPostfix(postfix, symbols);
+    }
+    timing.stack = stackTimer.seconds();
+    bench::keep(stackSum);
+
+    double registerSum = 0.0;
+    bench::Timer registerTimer;
+    for (std::size_t i = 0; i < evaluations; ++i) {
+        registerSum += vm.evaluate(symbols);
+    }
+    timing.registers = registerTimer.seconds();
+    bench::keep(registerSum);
+
+    same &= sameBits(stackSum, registerSum);
+    return timing;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t evaluations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    bool same = true;
+
+    for (int lowered = 0; lowered < 2; ++lowered) {
+        std::cout << (lowered ? "con lowerIntegerPowers" : "posfija del Parser") << std::endl;
+        Timing total = {0.0, 0.0};
+        for (const char* text : kCorpus) {
+            Timing timing = measure(text, lowered != 0, evaluations, same);
+            total.stack += timing.stack;
+            total.registers += timing.registers;
+            std::cout << "  " << text << "  (" << RegisterVM(compile(text, lowered != 0)).instructionCount()
+                      << " instrucciones, " << timing.stack / timing.registers << "x)" << std::endl;
+        }
+        std::size_t count = evaluations * (sizeof(kCorpus) / sizeof(kCorpus[0]));
+        bench::report("  corpus, pila (Evaluator)", total.stack, count);
+        bench::report("  corpus, registros (RegisterVM)", total.registers, count);
+        std::cout << "    aceleracion " << total.stack / total.registers << "x" << std::endl << std::endl;
+    }
+
+    std::mt19937_64 rng(47);
+    bool corpus = checkCorpus(rng);
+    bool edges = checkEdgeCases();
+    bool ok = same && corpus && edges;
+    std::cout << (ok ? "ok    " : "FALLA ") << "RegisterVM igual bit a bit a Evaluator, con los mismos errores"
+              << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// Generador de carga para el modo servidor: muchas sesiones repartidas entre
+// pocos hilos cliente, cada peticion espera su respuesta (terminada en el
+// prompt ">> "). Reporta peticiones/s y latencias p50/p99. Verifica que las
+// sesiones del servidor rechacen save y load.
+//
+//   bench/bin/server_load                 levanta un Server en el proceso
+//   bench/bin/server_load <socket>        usa un `EdaCal --server <socket>`
+#include "bench_util.hpp"
+#include "server.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kClientThreads = 8;
+const std::size_t kSessionsPerThread = 128;
+const std::size_t kRequestsPerSession = 200;
+
+int connectTo(const std::string& path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "no se pudo conectar a " << path << std::endl;
+        std::exit(1);
+    }
+    return fd;
+}
+
+std::string readResponse(int fd) {
+    std::string buffer;
+    char chunk[512];
+    while (buffer.size() < 3 || buffer.compare(buffer.size() - 3, 3, ">> ") != 0) {
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            std::cerr << "conexion cerrada por el servidor" << std::endl;
+            std::exit(1);
+        }
+        buffer.append(chunk, static_cast<std::size_t>(received));
+    }
+    return buffer;
+}
+
+std::string request(int fd, const std::string& line) {
+    ::send(fd, line.data(), line.size(), MSG_NOSIGNAL);
+    return readResponse(fd);
+}
+
+// Un cliente no puede escribir ni mapear archivos con los permisos del servidor.
+bool checkNoFiles(const std::string& path) {
+    std::string file = "/tmp/edacal_bench_" + std::to_string(::getpid()) + ".bin";
+    int fd = connectTo(path);
+    readResponse(fd);
+    request(fd, "x = 1\n");
+    bool ok = request(fd, "save " + file + "\n").find("error") != std::string::npos;
+    ok &= ::access(file.c_str(), F_OK) != 0;
+    ok &= request(fd, "load /etc/passwd\n").find("error") != std::string::npos;
+    ::send(fd, "exit\n", 5, MSG_NOSIGNAL);
+    ::close(fd);
+    return ok;
+}
+
+void clientThread(const std::string& path, std::vector<double>& latencies) {
+    std::vector<int> sessions;
+    for (std::size_t i = 0; i < kSessionsPerThread; ++i) {
+        int fd = connectTo(path);
+        readResponse(fd);
+        request(fd, "x = " + std::to_string(i + 1) + "\n");
+        sessions.push_back(fd);
+    }
+    latencies.reserve(kSessionsPerThread * kRequestsPerSession);
+    for (std::size_t r = 0; r < kRequestsPerSession; ++r) {
+        for (int fd : sessions) {
+            bench::Timer timer;
+            request(fd, "x * 2 + sqrt(x) - ans / 3\n");
+            latencies.push_back(timer.seconds());
+        }
+    }
+    for (int fd : sessions) {
+        ::send(fd, "exit\n", 5, MSG_NOSIGNAL);
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path;
+    Server* server = nullptr;
+    std::thread serverThread;
+    if (argc > 1) {
+        path = argv[1];
+    } else {
+        path = "/tmp/edacal_bench_" + std::to_string(::getpid()) + ".sock";
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        server = new Server(path, threads);
+        serverThread = std::thread([server]() { server->run(); });
+        std::cout << "servidor en proceso con " << threads << " hilos" << std::endl;
+    }
+
+    std::vector<std::vector<double>> latencies(kClientThreads);
+    std::vector<std::thread> clients;
+    bench::Timer timer;
+    for (std::size_t i = 0; i < kClientThreads; ++i) {
+        clients.push_back(std::thread(clientThread, path, std::ref(latencies[i])));
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    double elapsed = timer.seconds();
+
+    std::vector<double> all;
+    for (const std::vector<double>& part : latencies) {
+        all.insert(all.end(), part.begin(), part.end());
+    }
+    std::sort(all.begin(), all.end());
+    std::size_t total = all.size();
+    std::cout << "sesiones: " << kClientThreads * kSessionsPerThread << ", peticiones: " << total << std::endl;
+    bench::report("peticiones totales", elapsed, total);
+    std::cout << "peticiones/s: " << static_cast<double>(total) / elapsed << std::endl;
+    std::cout << "p50: " << all[total / 2] * 1e6 << " us, p99: " << all[total * 99 / 100] * 1e6 << " us" << std::endl;
+
+    bool noFiles = checkNoFiles(path);
+    std::cout << (noFiles ? "ok    " : "FALLA ") << "save y load rechazados en las sesiones del servidor" << std::endl;
+
+    if (server) {
+        server->stop();
+        serverThread.join();
+        delete server;
+    }
+    return noFiles ? 0 : 1;
+}
@@ -0,0 +1,251 @@
+// Latencia por linea y memoria de una sesion del REPL donde los comandos de
+// inspeccion (tree, postfix, prefix) son raros. Compara el pipeline anterior
+// (copia de tokens, arbol construido en cada linea y copia de la posfija)
+// con el actual (posfija movida, arbol solo cuando se pide) y verifica que
+// la salida de tree/prefix de la sesion sea la del arbol construido aparte.
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "printer.hpp"
+#include "session.hpp"
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Contadores de memoria: cada bloque guarda su tamano delante.
+std::size_t gLiveBytes = 0;
+std::size_t gAllocatedBytes = 0;
+
+const std::size_t kHeader = 16;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    void* block = std::malloc(size + kHeader);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<std::size_t*>(block) = size;
+    gLiveBytes += size;
+    gAllocatedBytes += size;
+    return static_cast<char*>(block) + kHeader;
+}
+
+void operator delete(void* pointer) noexcept {
+    if (!pointer) {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - kHeader;
+    gLiveBytes -= *static_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kLines = 100000;
+const std::size_t kInspectEvery = 500;
+
+std::string randomExpression(std::mt19937_64& rng, std::size_t terms) {
+    static const char* const ops[] = {" + ", " - ", " * ", " / "};
+    static const char* const names[] = {"a", "b", "c", "ans"};
+    std::string text = "(a + 1)";
+    for (std::size_t i = 0; i < terms; ++i) {
+        text += ops[rng() % 4];
+        if (rng() % 3 == 0) {
+            text += "sqrt(abs(" + std::string(names[rng() % 4]) + ") + 1)";
+        } else if (rng() % 2 == 0) {
+            text += names[rng() % 4];
+        } else {
+            text += std::to_string(rng() % 97 + 1);
+        }
+    }
+    return text;
+}
+
+struct Line {
+    std::string text;
+    bool inspect;
+};
+
+std::vector<Line> buildScript(std::mt19937_64& rng) {
+    static const char* const commands[] = {"tree", "postfix", "prefix"};
+    static const char* const targets[] = {"a", "b", "c"};
+    std::vector<Line> script;
+    script.push_back(Line{"a = 2", false});
+    script.push_back(Line{"b = 3", false});
+    script.push_back(Line{"c = 5", false});
+    for (std::size_t i = 0; script.size() < kLines; ++i) {
+        if (i % kInspectEvery == kInspectEvery - 1) {
+            script.push_back(Line{commands[(i / kInspectEvery) % 3], true});
+            continue;
+        }
+        std::string expression = randomExpression(rng, 6 + rng() % 10);
+        if (rng() % 2 == 0) {
+            expression = std::string(targets[rng() % 3]) + " = " + expression;
+        }
+        script.push_back(Line{expression, false});
+    }
+    return script;
+}
+
+// Lo que hacia Session por cada expresion antes de este cambio.
+struct EagerPipeline {
+    Tokenizer tokenizer;
+    Parser parser;
+    Evaluator evaluator;
+    SymbolTable symbols;
+    TokenList lastPostfix;
+    Tree lastTree;
+
+    double run(const std::string& text) {
+        TokenList tokens = tokenizer.tokenize(text);
+        TokenList expressionTokens = tokens;
+        TokenList postfix = parser.toPostfix(expressionTokens);
+        double value = evaluator.evalPostfix(postfix, symbols);
+        Tree tree = parser.buildTreeFromPostfix(postfix);
+        lastPostfix = postfix;
+        lastTree = std::move(tree);
+        return value;
+    }
+};
+
+struct LazyPipeline {
+    Tokenizer tokenizer;
+    Parser parser;
+    Evaluator evaluator;
+    SymbolTable symbols;
+    TokenList lastPostfix;
+
+    double run(const std::string& text) {
+        TokenList tokens = tokenizer.tokenize(text);
+        TokenList postfix = parser.toPostfix(tokens);
+        double value = evaluator.evalPostfix(postfix, symbols);
+        lastPostfix = std::move(postfix);
+        return value;
+    }
+};
+
+template <typename Pipeline>
+void defineVariables(Pipeline& pipeline) {
+    pipeline.symbols.set("a", 2.0);
+    pipeline.symbols.set("b", 3.0);
+    pipeline.symbols.set("c", 5.0);
+    pipeline.symbols.set("ans", 7.0);
+}
+
+template <typename Pipeline>
+void timePipeline(const std::string& label, const std::vector<std::string>& expressions) {
+    Pipeline pipeline;
+    defineVariables(pipeline);
+    std::size_t allocatedBefore = gAllocatedBytes;
+    bench::Timer timer;
+    for (const std::string& text : expressions) {
+        bench::keep(pipeline.run(text));
+    }
+    double seconds = timer.seconds();
+    std::size_t perLine = (gAllocatedBytes - allocatedBefore) / expressions.size();
+    bench::report(label, seconds, expressions.size());
+    std::size_t liveBefore = gLiveBytes;
+    {
+        Pipeline retained;
+        defineVariables(retained);
+        liveBefore = gLiveBytes;
+        retained.run(expressions.back());
+        std::cout << "    " << perLine << " bytes pedidos por linea, " << gLiveBytes - liveBefore
+                  << " bytes retenidos tras la ultima" << std::endl;
+    }
+}
+
+double percentile(std::vector<double> samples, double fraction) {
+    std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(11);
+    std::vector<Line> script = buildScript(rng);
+    std::vector<std::string> expressions;
+    for (const Line& line : script) {
+        if (!line.inspect) {
+            std::string text = line.text;
+            std::size_t assign = text.find(" = ");
+            expressions.push_back(assign == std::string::npos ? text : text.substr(assign + 3));
+        }
+    }
+
+    std::cout << "pipeline por expresion (" << expressions.size() << " lineas)" << std::endl;
+    timePipeline<EagerPipeline>("  anterior: arbol y copias por linea", expressions);
+    timePipeline<LazyPipeline>("  actual: posfija movida", expressions);
+
+    std::cout << std::endl << "sesion completa (" << script.size() << " lineas, inspeccion cada "
+              << kInspectEvery << ")" << std::endl;
+    Session session;
+    std::ostringstream out;
+    std::vector<double> latencies;
+    latencies.reserve(script.size());
+    bench::Timer total;
+    for (const Line& line : script) {
+        bench::Timer timer;
+        session.handleLine(line.text, out);
+        latencies.push_back(timer.seconds() * 1e9);
+    }
+    bench::report("  Session::handleLine", total.seconds(), script.size());
+    std::cout << "    p50 " << percentile(latencies, 0.50) << " ns, p99 " << percentile(latencies, 0.99)
+              << " ns" << std::endl;
+
+    // Verificacion: la vista perezosa coincide con el arbol construido aparte
+    // y queda memorizada entre comandos.
+    bool ok = out.str().find("error") == std::string::npos;
+    const std::string last = expressions.back();
+    Tree expected = Parser().buildTreeFromPostfix(Parser().toPostfix(Tokenizer().tokenize(last)));
+    std::ostringstream expectedTree;
+    std::ostringstream expectedPrefix;
+    Printer().printTree(expected, expectedTree);
+    Printer().printPrefix(expected, expectedPrefix);
+
+    std::ostringstream sink;
+    session.handleLine(last, sink);
+    std::size_t liveBeforeTree = gLiveBytes;
+    {
+        std::ostringstream tree;
+        session.handleLine("tree", tree);
+        ok &= tree.str() == expectedTree.str();
+    }
+    std::size_t treeBytes = gLiveBytes - liveBeforeTree;
+    std::size_t liveBeforePrefix = gLiveBytes;
+    {
+        std::ostringstream prefix;
+        session.handleLine("prefix", prefix);
+        ok &= prefix.str() == expectedPrefix.str();
+    }
+    ok &= gLiveBytes == liveBeforePrefix;
+    std::cout << "    arbol materializado al pedir tree: " << treeBytes << " bytes" << std::endl;
+
+    session.handleLine("deriv a", sink);
+    std::ostringstream derivative;
+    session.handleLine("tree", derivative);
+    ok &= derivative.str().find("error") == std::string::npos;
+
+    std::cout << std::endl
+              << (ok ? "ok    " : "FALLA ") << "tree/prefix perezosos iguales al arbol construido aparte"
+              << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+// Lecturas concurrentes de variables compartidas con un escritor constante:
+// SharedSymbols (lectores sin lock, una SymbolTable local por lector) frente
+// a una SymbolTable comun protegida por un mutex. Cada lectura es una
+// evaluacion completa de la posfija "a * b + c - d".
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "shared_symbols.hpp"
+#include "tokenizer.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const double kWindowSeconds = 0.2;
+const char* const kNames[] = {"a", "b", "c", "d"};
+
+struct Shared {
+    SharedSymbols lockFree;
+    SymbolTable locked;
+    std::mutex lock;
+    std::atomic<bool> running;
+};
+
+void writer(Shared& shared, bool lockFree) {
+    double value = 0.0;
+    while (shared.running.load(std::memory_order_relaxed)) {
+        value += 1.0;
+        if (lockFree) {
+            shared.lockFree.set("a", value);
+        } else {
+            std::lock_guard<std::mutex> guard(shared.lock);
+            shared.locked.set("a", value);
+        }
+        std::this_thread::yield();
+    }
+}
+
+void reader(Shared& shared, const TokenList& postfix, bool lockFree, std::size_t& evaluations) {
+    Evaluator evaluator;
+    SymbolTable overlay(&shared.lockFree);
+    double sum = 0.0;
+    std::size_t count = 0;
+    while (shared.running.load(std::memory_order_relaxed)) {
+        if (lockFree) {
+            sum += evaluator.evalPostfix(postfix, overlay);
+        } else {
+            std::lock_guard<std::mutex> guard(shared.lock);
+            sum += evaluator.evalPostfix(postfix, shared.locked);
+        }
+        ++count;
+    }
+    bench::keep(sum);
+    evaluations = count;
+}
+
+double run(const TokenList& postfix, std::size_t readers, bool lockFree) {
+    Shared shared;
+    for (const char* name : kNames) {
+        shared.lockFree.set(name, 2.0);
+        shared.locked.set(name, 2.0);
+    }
+    shared.running = true;
+
+    std::vector<std::size_t> counts(readers, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < readers; ++i) {
+        threads.push_back(std::thread(reader, std::ref(shared), std::cref(postfix), lockFree, std::ref(counts[i])));
+    }
+    std::thread writerThread(writer, std::ref(shared), lockFree);
+
+    bench::Timer timer;
+    std::this_thread::sleep_for(std::chrono::duration<double>(kWindowSeconds));
+    shared.running = false;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    writerThread.join();
+    double elapsed = timer.seconds();
+
+    std::size_t total = 0;
+    for (std::size_t count : counts) {
+        total += count;
+    }
+    return static_cast<double>(total) / elapsed;
+}
+
+} // namespace
+
+int main() {
+    TokenList postfix = Parser().toPostfix(Tokenizer().tokenize("a * b + c - d"));
+    std::cout << "nucleos: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << "lectores   SharedSymbols (eval/s)   mutex (eval/s)" << std::endl;
+    for (std::size_t readers = 1; readers <= 64; readers *= 2) {
+        double lockFree = run(postfix, readers, true);
+        double locked = run(postfix, readers, false);
+        std::cout << std::setw(8) << readers << std::setw(25) << std::fixed << std::setprecision(0) << lockFree
+                  << std::setw(17) << locked << std::endl;
+    }
+    return 0;
+}
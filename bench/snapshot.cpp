@@ -0,0 +1,180 @@
+// Arranque con una biblioteca de 100k formulas: volver a tokenizar, parsear
+// y evaluar cada linea frente a cargar el snapshot mapeado en memoria.
+// Verifica ademas que load mezcle con lo que ya habia y que un archivo con
+// un registro corrupto (y checksum valido) no cambie nada.
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "formula_library.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kFormulas = 100000;
+const char* const kPath = "bench_snapshot.bin";
+
+std::vector<std::string> makeLibrary() {
+    std::vector<std::string> lines;
+    lines.reserve(kFormulas);
+    lines.push_back("f0 = 1.5");
+    for (std::size_t i = 1; i < kFormulas; ++i) {
+        std::string prev = "f" + std::to_string(i - 1);
+        lines.push_back("f" + std::to_string(i) + " = " + prev + " * 0.5 + sqrt(" + std::to_string(i) +
+                        ") - hypot(" + prev + ", 2) / 3");
+    }
+    return lines;
+}
+
+void defineLine(const std::string& line, Tokenizer& tokenizer, Parser& parser, Evaluator& evaluator,
+                SymbolTable& symbols, FormulaLibrary& formulas) {
+    std::size_t eq = line.find('=');
+    std::string name = line.substr(0, eq - 1);
+    TokenList postfix = parser.toPostfix(tokenizer.tokenize(line.substr(eq + 1)));
+    symbols.set(name, evaluator.evalPostfix(postfix, symbols));
+    formulas.define(name, postfix);
+}
+
+TokenList compile(const std::string& text) {
+    return Parser().toPostfix(Tokenizer().tokenize(text));
+}
+
+// El mismo FNV-1a por palabras de FormulaLibrary, para corromper un archivo
+// sin que lo detecte el checksum.
+std::uint64_t checksum(const char* data, std::size_t size) {
+    const std::uint64_t prime = 1099511628211ULL;
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
+
+// Encabezado de 64 bytes con el checksum en el byte 24; el primer registro
+// de variable empieza en el 64 con su nameOffset.
+void corruptFirstSymbol(const char* from, const char* to) {
+    std::ifstream in(from, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::uint32_t offset = 0xfffffff0u;
+    std::memcpy(&data[64], &offset, sizeof(offset));
+    std::uint64_t sum = checksum(data.data() + 64, data.size() - 64);
+    std::memcpy(&data[24], &sum, sizeof(sum));
+    std::ofstream(to, std::ios::binary | std::ios::trunc).write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+bool checkMergeAndCorruption() {
+    const char* const first = "bench_snapshot_a.bin";
+    const char* const second = "bench_snapshot_b.bin";
+    const char* const corrupt = "bench_snapshot_c.bin";
+    {
+        SymbolTable symbols;
+        FormulaLibrary formulas;
+        symbols.set("a", 1.0);
+        symbols.set("b", 2.0);
+        formulas.define("a", compile("1"));
+        formulas.define("b", compile("2"));
+        formulas.save(first, symbols);
+    }
+    {
+        SymbolTable symbols;
+        FormulaLibrary formulas;
+        symbols.set("b", 20.0);
+        symbols.set("c", 30.0);
+        formulas.define("b", compile("20"));
+        formulas.define("c", compile("30"));
+        formulas.save(second, symbols);
+    }
+    corruptFirstSymbol(second, corrupt);
+
+    Evaluator evaluator;
+    SymbolTable symbols;
+    FormulaLibrary formulas;
+    formulas.load(first, symbols);
+    symbols.set("d", 4.0);
+    formulas.define("d", compile("4"));
+    bool ok = true;
+    try {
+        formulas.load(corrupt, symbols);
+        ok = false;
+    } catch (const EdaError&) {
+    }
+    ok &= formulas.size() == 3 && !formulas.has("c") && symbols.get("b") == 2.0 && !symbols.has("c") &&
+          evaluator.evalPostfix(formulas.get("b"), symbols) == 2.0;
+
+    formulas.load(second, symbols);
+    ok &= formulas.size() == 4 && symbols.get("a") == 1.0 && symbols.get("b") == 20.0 && symbols.get("c") == 30.0 &&
+          symbols.get("d") == 4.0;
+    const char* const names[] = {"a", "b", "c", "d"};
+    const double values[] = {1.0, 20.0, 30.0, 4.0};
+    for (std::size_t i = 0; i < 4; ++i) {
+        ok &= formulas.has(names[i]) && evaluator.evalPostfix(formulas.get(names[i]), symbols) == values[i];
+    }
+    std::remove(first);
+    std::remove(second);
+    std::remove(corrupt);
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::string> lines = makeLibrary();
+    Tokenizer tokenizer;
+    Parser parser;
+    Evaluator evaluator;
+
+    {
+        SymbolTable symbols;
+        FormulaLibrary formulas;
+        for (const std::string& line : lines) {
+            defineLine(line, tokenizer, parser, evaluator, symbols, formulas);
+        }
+        bench::Timer timer;
+        formulas.save(kPath, symbols);
+        bench::report("save", timer.seconds(), kFormulas);
+    }
+
+    double reparsed = 0.0;
+    {
+        bench::Timer timer;
+        SymbolTable symbols;
+        FormulaLibrary formulas;
+        for (const std::string& line : lines) {
+            defineLine(line, tokenizer, parser, evaluator, symbols, formulas);
+        }
+        reparsed = symbols.get("f" + std::to_string(kFormulas - 1));
+        bench::report("arranque re-parseando", timer.seconds(), kFormulas);
+    }
+    {
+        bench::Timer timer;
+        SymbolTable symbols;
+        FormulaLibrary formulas;
+        formulas.load(kPath, symbols);
+        bench::report("arranque con load (mmap)", timer.seconds(), kFormulas);
+
+        std::string last = "f" + std::to_string(kFormulas - 1);
+        bool ok = symbols.get(last) == reparsed && formulas.size() == kFormulas &&
+                  evaluator.evalPostfix(formulas.get(last), symbols) == reparsed;
+        std::cout << (ok ? "ok" : "FALLA") << "    valores y formulas iguales tras load" << std::endl;
+        std::remove(kPath);
+        bool merged = checkMergeAndCorruption();
+        std::cout << (merged ? "ok" : "FALLA") << "    load mezcla y un archivo corrupto no cambia nada" << std::endl;
+        return ok && merged ? 0 : 1;
+    }
+}
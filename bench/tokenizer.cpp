@@ -0,0 +1,295 @@
+// Tokenizer con tabla de clases, saltos por bloques (char_scan.hpp) y
+// camino rapido para literales cortos frente al lexer anterior, caracter a
+// caracter con std::isspace/isdigit/isalpha y strtod para cada numero: MB/s
+// sobre expresiones generadas de varios MB con distintas densidades de
+// espacios y de digitos. Verifica que ambos den los mismos tokens (tipo,
+// lexema, valor, funcion y columna) y los mismos errores sobre entradas al
+// azar, y que skipSpaces/skipDigits coincidan con la version escalar desde
+// cada posicion.
+// Uso: tokenizer [MB]
+#include "bench_util.hpp"
+#include "char_scan.hpp"
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace edacal;
+
+namespace {
+
+void push(TokenList& tokens, Token token, std::size_t column) {
+    token.column = column;
+    tokens.push_back(std::move(token));
+}
+
+// El lexer tal como estaba antes de char_scan.hpp, mas las comparaciones y
+// select que se agregaron despues.
+bool legacyTokenize(const FunctionRegistry& functions, const std::string& input, TokenList& tokens, Error& error) {
+    std::size_t i = 0;
+    while (i < input.size()) {
+        char c = input[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+            continue;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            std::size_t start = i;
+            bool dotSeen = (c == '.');
+            ++i;
+            while (i < input.size()) {
+                char nc = input[i];
+                if (std::isdigit(static_cast<unsigned char>(nc))) {
+                    ++i;
+                } else if (nc == '.' && !dotSeen) {
+                    dotSeen = true;
+                    ++i;
+                } else {
+                    break;
+                }
+            }
+            const std::string lexeme = input.substr(start, i - start);
+            char* end = nullptr;
+            errno = 0;
+            double value = std::strtod(lexeme.c_str(), &end);
+            if (end != lexeme.c_str() + lexeme.size() || errno == ERANGE) {
+                error = Error(ErrorKind::INVALID_NUMBER, start, lexeme.size(), lexeme);
+                return false;
+            }
+            push(tokens, Token(TokenType::NUMBER, lexeme, value), start);
+            continue;
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            std::size_t start = i;
+            ++i;
+            while (i < input.size()) {
+                char nc = input[i];
+                if (std::isalnum(static_cast<unsigned char>(nc)) || nc == '_') {
+                    ++i;
+                } else {
+                    break;
+                }
+            }
+            const std::string lexeme = input.substr(start, i - start);
+            if (lexeme == "ans") {
+                push(tokens, Token(TokenType::ANS, lexeme), start);
+            } else if (lexeme == "sum") {
+                push(tokens, Token(TokenType::SUM, lexeme), start);
+            } else if (lexeme == "prod") {
+                push(tokens, Token(TokenType::PROD, lexeme), start);
+            } else if (lexeme == "select") {
+                push(tokens, Token(TokenType::SELECT, lexeme), start);
+            } else if (const Function* fn = functions.find(lexeme)) {
+                push(tokens, Token(fn, lexeme), start);
+            } else {
+                push(tokens, Token(TokenType::IDENT, lexeme), start);
+            }
+            continue;
+        }
+        if ((c == '<' || c == '>' || c == '=') && i + 1 < input.size() && input[i + 1] == '=') {
+            TokenType type = c == '<' ? TokenType::LESS_EQUAL
+                                      : c == '>' ? TokenType::GREATER_EQUAL : TokenType::EQUAL;
+            push(tokens, Token(type, input.substr(i, 2)), i);
+            i += 2;
+            continue;
+        }
+        static const char symbols[] = "+-*/^(),=<>";
+        static const TokenType types[] = {TokenType::PLUS,   TokenType::MINUS,  TokenType::MUL,
+                                          TokenType::DIV,    TokenType::POW,    TokenType::LPAREN,
+                                          TokenType::RPAREN, TokenType::COMMA,  TokenType::ASSIGN,
+                                          TokenType::LESS,   TokenType::GREATER};
+        const char* found = c ? std::strchr(symbols, c) : nullptr;
+        if (!found) {
+            error = Error(ErrorKind::UNKNOWN_TOKEN, i, 1, std::string(1, c));
+            return false;
+        }
+        push(tokens, Token(types[found - symbols], std::string(1, c)), i);
+        ++i;
+    }
+    push(tokens, Token(TokenType::END, ""), input.size());
+    return true;
+}
+
+bool sameTokens(const TokenList& a, const TokenList& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    auto it = b.begin();
+    for (const Token& token : a) {
+        const Token& other = *it++;
+        if (token.type != other.type || token.lexeme != other.lexeme ||
+            std::memcmp(&token.value, &other.value, sizeof(double)) != 0 || token.function != other.function ||
+            token.column != other.column) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Literal de 1 a 24 cifras con o sin punto, para el camino rapido de los
+// numeros cortos y su limite de 15 cifras.
+std::string randomNumber(std::mt19937_64& rng) {
+    std::string number;
+    std::size_t digits = 1 + rng() % 24;
+    std::size_t dot = rng() % (digits + 2);
+    for (std::size_t d = 0; d < digits; ++d) {
+        if (d == dot) {
+            number += '.';
+        }
+        number += static_cast<char>('0' + rng() % 10);
+    }
+    return number;
+}
+
+// Entradas cortas con de todo: espacios de cada tipo, numeros con y sin
+// punto, identificadores, funciones, operadores, bytes >= 128 y caracteres
+// invalidos.
+std::string randomInput(std::mt19937_64& rng) {
+    static const char* pieces[] = {" ", "  ", "\t", "\n", "\v", "\f", "\r", "                                     ",
+                                   "0", "7", "12345678901234567890123456789012345", "3.25", ".5", "1.", "1.2.3",
+                                   "..", "x", "_a1", "sin", "ans", "sum", "prod", "max", "+", "-", "*", "/",
+                                   "^", "(", ")", ",", "=", "<", ">", "<=", "==", "select", "\xe9", "$", "1e5",
+                                   "\x01"};
+    std::string input;
+    std::size_t count = rng() % 24;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (rng() % 4 == 0) {
+            input += randomNumber(rng);
+        } else {
+            input += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+        }
+    }
+    return input;
+}
+
+bool checkEquivalence(std::mt19937_64& rng) {
+    const FunctionRegistry& functions = FunctionRegistry::builtins();
+    Tokenizer tokenizer;
+    for (int round = 0; round < 200000; ++round) {
+        std::string input = randomInput(rng);
+        TokenList expected;
+        TokenList actual;
+        Error expectedError;
+        Error actualError;
+        bool expectedOk = legacyTokenize(functions, input, expected, expectedError);
+        bool actualOk = tokenizer.tokenize(input, actual, actualError);
+        bool same = expectedOk == actualOk &&
+                    (expectedOk ? sameTokens(expected, actual)
+                                : expectedError.kind == actualError.kind &&
+                                      expectedError.column == actualError.column &&
+                                      expectedError.length == actualError.length &&
+                                      expectedError.detail == actualError.detail);
+        if (!same) {
+            std::cout << "FALLA tokens distintos para \"" << input << "\"" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkScanners(std::mt19937_64& rng) {
+    for (int round = 0; round < 2000; ++round) {
+        std::string text;
+        std::size_t length = rng() % 200;
+        for (std::size_t i = 0; i < length; ++i) {
+            std::size_t kind = rng() % 8;
+            text += kind < 3 ? " \t\n\v\f\r"[rng() % 6] : kind < 6 ? static_cast<char>('0' + rng() % 10)
+                                                                    : static_cast<char>(rng() % 256);
+        }
+        for (std::size_t pos = 0; pos <= text.size(); ++pos) {
+            if (scan::skipSpaces(text.data(), pos, text.size()) !=
+                    scan::skipSpacesScalar(text.data(), pos, text.size()) ||
+                scan::skipDigits(text.data(), pos, text.size()) !=
+                    scan::skipDigitsScalar(text.data(), pos, text.size())) {
+                return false;
+            }
+        }
+    }
+    for (int c = 0; c < 256; ++c) {
+        char ch = static_cast<char>(c);
+        if (scan::isSpace(ch) != (std::isspace(c) != 0) || scan::isDigit(ch) != (std::isdigit(c) != 0) ||
+            scan::isLetter(ch) != (std::isalpha(c) != 0 || c == '_') ||
+            scan::isWordChar(ch) != (std::isalnum(c) != 0 || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Expresion de `bytes` bytes: terminos `coef * nombre` con `spaces`
+// espacios entre tokens y coeficientes de `digits` cifras.
+std::string generate(std::size_t bytes, std::size_t spaces, std::size_t digits, std::mt19937_64& rng) {
+    std::string gap(spaces, ' ');
+    std::string text;
+    text.reserve(bytes + 64);
+    static const char* names[] = {"x", "rate", "sin", "y_2", "ans"};
+    while (text.size() < bytes) {
+        if (!text.empty()) {
+            text += gap + (rng() % 2 ? "+" : "-") + gap;
+        }
+        for (std::size_t d = 0; d < digits; ++d) {
+            text += static_cast<char>('1' + rng() % 9);
+        }
+        text += gap + "*" + gap + names[rng() % 5];
+    }
+    return text;
+}
+
+bool measure(const std::string& label, const std::string& text) {
+    const FunctionRegistry& functions = FunctionRegistry::builtins();
+    Tokenizer tokenizer;
+    double mb = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+    double legacySeconds = 0.0;
+    double currentSeconds = 0.0;
+    bool same = true;
+    std::size_t count = 0;
+    for (int round = 0; round < 3; ++round) {
+        TokenList legacy;
+        TokenList current;
+        Error error;
+        bench::Timer legacyTimer;
+        legacyTokenize(functions, text, legacy, error);
+        double seconds = legacyTimer.seconds();
+        legacySeconds = round == 0 ? seconds : std::min(legacySeconds, seconds);
+        bench::Timer currentTimer;
+        tokenizer.tokenize(text, current, error);
+        seconds = currentTimer.seconds();
+        currentSeconds = round == 0 ? seconds : std::min(currentSeconds, seconds);
+        same &= sameTokens(legacy, current);
+        count = current.size();
+    }
+    std::cout << label << " (" << mb << " MB, " << count << " tokens)" << std::endl;
+    bench::report("  anterior", legacySeconds, text.size());
+    std::cout << "    " << mb / legacySeconds << " MB/s" << std::endl;
+    bench::report(std::string("  tabla + ") + scan::simdPath(), currentSeconds, text.size());
+    std::cout << "    " << mb / currentSeconds << " MB/s" << std::endl;
+    return same;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    std::size_t bytes = megabytes << 20;
+    std::mt19937_64 rng(46);
+
+    bool ok = true;
+    ok &= measure("compacta, 3 cifras", generate(bytes, 0, 3, rng));
+    ok &= measure("un espacio, 6 cifras", generate(bytes, 1, 6, rng));
+    ok &= measure("indentada, 24 espacios, 20 cifras", generate(bytes, 24, 20, rng));
+    std::cout << std::endl;
+
+    bool same = checkEquivalence(rng);
+    std::cout << (same ? "ok    " : "FALLA ") << "mismos tokens y errores que el lexer anterior" << std::endl;
+    bool scanners = checkScanners(rng);
+    std::cout << (scanners ? "ok    " : "FALLA ") << "skipSpaces/skipDigits y la tabla iguales a <cctype>"
+              << std::endl;
+    ok &= same && scanners;
+    return ok ? 0 : 1;
+}
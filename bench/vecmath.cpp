@@ -0,0 +1,228 @@
+// Precision de los kernels de vecmath frente a libm, rendimiento de los
+// kernels y de BatchEvaluator frente al Evaluator escalar fila por fila.
+// Termina con codigo 1 si alguna cota documentada en vecmath.hpp no se cumple.
+#include "batch_evaluator.hpp"
+#include "bench_util.hpp"
+#include "evaluator.hpp"
+#include "parser.hpp"
+#include "tokenizer.hpp"
+#include "vecmath.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace edacal;
+
+namespace {
+
+const std::size_t kSamples = 1 << 20;
+
+double ulpDistance(double a, double b) {
+    if (a == b || (std::isnan(a) && std::isnan(b))) {
+        return 0.0;
+    }
+    std::int64_t ia;
+    std::int64_t ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) {
+        ia = INT64_MIN - ia;
+    }
+    if (ib < 0) {
+        ib = INT64_MIN - ib;
+    }
+    return std::fabs(static_cast<double>(ia - ib));
+}
+
+double maxUlp(const std::vector<double>& got, const std::vector<double>& expected) {
+    double worst = 0.0;
+    for (std::size_t i = 0; i < got.size(); ++i) {
+        double d = ulpDistance(got[i], expected[i]);
+        if (d > worst) {
+            worst = d;
+        }
+    }
+    return worst;
+}
+
+bool check(const std::string& label, double worst, double bound) {
+    bool ok = worst <= bound;
+    std::cout << (ok ? "ok    " : "FALLA ") << label << ": " << worst << " ULP (cota " << bound << ")" << std::endl;
+    return ok;
+}
+
+std::vector<double> uniform(double lo, double hi, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> values(kSamples);
+    for (double& v : values) {
+        v = dist(rng);
+    }
+    return values;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(42);
+    std::vector<double> out(kSamples);
+    std::vector<double> expected(kSamples);
+    bool ok = true;
+
+    std::vector<double> expIn = uniform(-745.0, 710.0, rng);
+    std::vector<double> logIn = uniform(1e-300, 1e300, rng);
+    std::vector<double> unitIn = uniform(1e-3, 4.0, rng);
+    std::vector<double> powBase = uniform(0.01, 10.0, rng);
+    std::vector<double> powExp = uniform(-8.0, 8.0, rng);
+
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::sqrt(unitIn[i]);
+    }
+    vecmath::sqrt(unitIn.data(), out.data(), kSamples);
+    ok &= check("sqrt", maxUlp(out, expected), 0.0);
+
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::exp(expIn[i]);
+    }
+    vecmath::exp(expIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    ok &= check("exp (Fast)", maxUlp(out, expected), 2.0);
+    vecmath::exp(expIn.data(), out.data(), kSamples, vecmath::Mode::Exact);
+    ok &= check("exp (Exact)", maxUlp(out, expected), 0.0);
+
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::log(logIn[i]);
+    }
+    vecmath::log(logIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    ok &= check("log (Fast, rango completo)", maxUlp(out, expected), 1.0);
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::log(unitIn[i]);
+    }
+    vecmath::log(unitIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    ok &= check("log (Fast, cerca de 1)", maxUlp(out, expected), 1.0);
+
+    for (long n = -vecmath::kMaxIntegerExponent; n <= vecmath::kMaxIntegerExponent; ++n) {
+        std::vector<double> base(powBase.begin(), powBase.begin() + 4096);
+        std::vector<double> got(base.size());
+        std::vector<double> ref(base.size());
+        vecmath::powi(base.data(), n, got.data(), base.size());
+        for (std::size_t i = 0; i < base.size(); ++i) {
+            ref[i] = std::pow(base[i], static_cast<double>(n));
+        }
+        double bound = n == 0 ? 0.0 : static_cast<double>(n < 0 ? -n : n);
+        double worst = maxUlp(got, ref);
+        if (worst > bound) {
+            ok &= check("powi n=" + std::to_string(n), worst, bound);
+        }
+    }
+    std::cout << "ok    powi |n| <= " << vecmath::kMaxIntegerExponent << " dentro de |n| ULP" << std::endl;
+
+    // x^|n| se desborda o queda subnormal aunque x^n cabe: no debe quedar en
+    // 0 ni en infinito antes de tiempo.
+    const double edgeBase[] = {1e155, 1e160, 1.5e154, -1e103, 1e-155, 3e-104};
+    const long edgeExponent[] = {-2, -2, -3, -3, -2, -3};
+    double edgeWorst = 0.0;
+    for (std::size_t i = 0; i < sizeof(edgeBase) / sizeof(edgeBase[0]); ++i) {
+        double ref = std::pow(edgeBase[i], static_cast<double>(edgeExponent[i]));
+        edgeWorst = std::max(edgeWorst, ulpDistance(vecmath::powi(edgeBase[i], edgeExponent[i]), ref));
+    }
+    ok &= check("powi con x^|n| fuera del rango normal", edgeWorst, 0.0);
+
+    double powWorstExcess = 0.0;
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        expected[i] = std::pow(powBase[i], powExp[i]);
+    }
+    vecmath::pow(powBase.data(), powExp.data(), out.data(), kSamples, vecmath::Mode::Fast);
+    for (std::size_t i = 0; i < kSamples; ++i) {
+        double bound = 2.0 + 3.0 * std::fabs(powExp[i] * std::log(powBase[i]));
+        double excess = ulpDistance(out[i], expected[i]) - bound;
+        if (excess > powWorstExcess) {
+            powWorstExcess = excess;
+        }
+    }
+    ok &= check("pow (Fast) sobre 2 + 3|y ln x|", powWorstExcess, 0.0);
+
+    std::cout << std::endl;
+    {
+        bench::Timer timer;
+        for (std::size_t i = 0; i < kSamples; ++i) {
+            out[i] = std::exp(unitIn[i]);
+        }
+        bench::keep(out[kSamples / 2]);
+        bench::report("std::exp escalar", timer.seconds(), kSamples);
+    }
+    {
+        bench::Timer timer;
+        vecmath::exp(unitIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+        bench::keep(out[kSamples / 2]);
+        bench::report("vecmath::exp Fast", timer.seconds(), kSamples);
+    }
+    {
+        bench::Timer timer;
+        for (std::size_t i = 0; i < kSamples; ++i) {
+            out[i] = std::log(unitIn[i]);
+        }
+        bench::keep(out[kSamples / 2]);
+        bench::report("std::log escalar", timer.seconds(), kSamples);
+    }
+    {
+        bench::Timer timer;
+        vecmath::log(unitIn.data(), out.data(), kSamples, vecmath::Mode::Fast);
+        bench::keep(out[kSamples / 2]);
+        bench::report("vecmath::log Fast", timer.seconds(), kSamples);
+    }
+    {
+        bench::Timer timer;
+        for (std::size_t i = 0; i < kSamples; ++i) {
+            out[i] = std::pow(powBase[i], powExp[i]);
+        }
+        bench::keep(out[kSamples / 2]);
+        bench::report("std::pow escalar", timer.seconds(), kSamples);
+    }
+    {
+        bench::Timer timer;
+        vecmath::pow(powBase.data(), powExp.data(), out.data(), kSamples, vecmath::Mode::Fast);
+        bench::keep(out[kSamples / 2]);
+        bench::report("vecmath::pow Fast", timer.seconds(), kSamples);
+    }
+
+    std::cout << std::endl;
+    const std::size_t rows = 1 << 18;
+    TokenList postfix = Parser().toPostfix(Tokenizer().tokenize("sqrt(x) * exp(-y) + log(x + 1) ^ 2.5"));
+    SymbolTable symbols;
+    BatchEvaluator::Columns columns;
+    columns["x"] = unitIn.data();
+    columns["y"] = powBase.data();
+
+    std::vector<double> scalar(rows);
+    {
+        Evaluator evaluator;
+        bench::Timer timer;
+        for (std::size_t i = 0; i < rows; ++i) {
+            symbols.set("x", unitIn[i]);
+            symbols.set("y", powBase[i]);
+            scalar[i] = evaluator.evalPostfix(postfix, symbols);
+        }
+        bench::report("Evaluator fila por fila", timer.seconds(), rows);
+    }
+    std::vector<double> batch(rows);
+    {
+        BatchEvaluator evaluator(vecmath::Mode::Exact);
+        bench::Timer timer;
+        evaluator.evalPostfix(postfix, columns, symbols, batch.data(), rows);
+        bench::report("BatchEvaluator Exact", timer.seconds(), rows);
+        std::vector<double> head(scalar.begin(), scalar.end());
+        ok &= check("BatchEvaluator Exact vs Evaluator", maxUlp(batch, head), 0.0);
+    }
+    {
+        BatchEvaluator evaluator(vecmath::Mode::Fast);
+        bench::Timer timer;
+        evaluator.evalPostfix(postfix, columns, symbols, batch.data(), rows);
+        bench::report("BatchEvaluator Fast", timer.seconds(), rows);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,358 @@
+#include "autodiff.hpp"
+
+#include "stack.hpp"
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace edacal {
+
+namespace {
+
+// Valor de un operador o funcion; mismas operaciones y errores que Evaluator.
+double apply(const Token& token, const double* args) {
+    switch (token.type) {
+        case TokenType::UNARY_MINUS:
+            return -args[0];
+        case TokenType::PLUS:
+            return args[0] + args[1];
+        case TokenType::MINUS:
+            return args[0] - args[1];
+        case TokenType::MUL:
+            return args[0] * args[1];
+        case TokenType::DIV:
+            if (args[1] == 0.0) {
+                throw EdaError("division por cero");
+            }
+            return args[0] / args[1];
+        case TokenType::POW:
+            return std::pow(args[0], args[1]);
+        case TokenType::POWI:
+            return vecmath::powi(args[0], static_cast<long>(token.value));
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+            return compareValues(token.type, args[0], args[1]) ? 1.0 : 0.0;
+        case TokenType::FUNCTION:
+            return token.function->impl(args);
+        default:
+            throw EdaError("token inesperado en evaluacion: " + token.lexeme);
+    }
+}
+
+std::size_t operandCount(const Token& token) {
+    switch (token.type) {
+        case TokenType::UNARY_MINUS:
+        case TokenType::POWI:
+            return 1;
+        case TokenType::FUNCTION:
+            return token.function->arity;
+        default:
+            return 2;
+    }
+}
+
+// Parciales locales d valor / d args[i], dado el valor ya calculado.
+void partials(const Token& token, const double* args, double value, double* out) {
+    switch (token.type) {
+        case TokenType::UNARY_MINUS:
+            out[0] = -1.0;
+            return;
+        case TokenType::PLUS:
+            out[0] = 1.0;
+            out[1] = 1.0;
+            return;
+        case TokenType::MINUS:
+            out[0] = 1.0;
+            out[1] = -1.0;
+            return;
+        case TokenType::MUL:
+            out[0] = args[1];
+            out[1] = args[0];
+            return;
+        case TokenType::DIV:
+            out[0] = 1.0 / args[1];
+            out[1] = -value / args[1];
+            return;
+        case TokenType::POW:
+            out[0] = args[1] == 0.0 ? 0.0 : args[1] * std::pow(args[0], args[1] - 1.0);
+            if (args[0] > 0.0) {
+                out[1] = value * std::log(args[0]);
+            } else if (args[0] == 0.0 && args[1] > 0.0) {
+                out[1] = 0.0;
+            } else {
+                out[1] = std::numeric_limits<double>::quiet_NaN();
+            }
+            return;
+        case TokenType::POWI: {
+            long n = static_cast<long>(token.value);
+            out[0] = n == 0 ? 0.0 : static_cast<double>(n) * vecmath::powi(args[0], n - 1);
+            return;
+        }
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+            // Constante a trozos: el salto no se deriva.
+            out[0] = 0.0;
+            out[1] = 0.0;
+            return;
+        default:
+            break;
+    }
+
+    const std::string& name = token.function->name;
+    if (token.function != FunctionRegistry::builtins().find(name)) {
+        throw EdaError("funcion sin derivada: " + name);
+    }
+    if (name == "sqrt") {
+        out[0] = 0.5 / value;
+    } else if (name == "exp") {
+        out[0] = value;
+    } else if (name == "log") {
+        out[0] = 1.0 / args[0];
+    } else if (name == "sin") {
+        out[0] = std::cos(args[0]);
+    } else if (name == "cos") {
+        out[0] = -std::sin(args[0]);
+    } else if (name == "abs") {
+        out[0] = args[0] > 0.0 ? 1.0 : (args[0] < 0.0 ? -1.0 : 0.0);
+    } else if (name == "min" || name == "max") {
+        bool first = name == "min" ? args[0] <= args[1] : args[0] >= args[1];
+        out[0] = first ? 1.0 : 0.0;
+        out[1] = first ? 0.0 : 1.0;
+    } else if (name == "hypot") {
+        out[0] = value == 0.0 ? 0.0 : args[0] / value;
+        out[1] = value == 0.0 ? 0.0 : args[1] / value;
+    } else {
+        throw EdaError("funcion sin derivada: " + name);
+    }
+}
+
+const std::string& variableName(const Token& token) {
+    static const std::string kAns("ans");
+    return token.type == TokenType::ANS ? kAns : token.lexeme;
+}
+
+// En preorden con una pila explicita (el arbol de una suma larga es tan
+// profundo como terminos tiene): las variables salen de izquierda a derecha.
+void collectVariables(const Tree::Node* root, std::vector<std::string>& names) {
+    std::vector<const Tree::Node*> pending;
+    if (root) {
+        pending.push_back(root);
+    }
+    while (!pending.empty()) {
+        const Tree::Node* node = pending.back();
+        pending.pop_back();
+        if (node->token.type == TokenType::IDENT || node->token.type == TokenType::ANS) {
+            const std::string& name = variableName(node->token);
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                names.push_back(name);
+            }
+            continue;
+        }
+        if (node->right) {
+            pending.push_back(node->right);
+        }
+        if (node->left) {
+            pending.push_back(node->left);
+        }
+    }
+}
+
+} // namespace
+
+Dual DualEvaluator::evalPostfix(const TokenList& postfix, SymbolTable& symbols,
+                                const std::string& variable) const {
+    Stack<Dual> values;
+
+    for (auto it = postfix.begin(); it != postfix.end(); ++it) {
+        const Token& token = *it;
+        if (token.type == TokenType::END) {
+            break;
+        }
+
+        switch (token.type) {
+            case TokenType::NUMBER:
+                values.push(Dual{token.value, 0.0});
+                continue;
+            case TokenType::ANS:
+            case TokenType::IDENT: {
+                const std::string& name = variableName(token);
+                values.push(Dual{symbols.get(name), name == variable ? 1.0 : 0.0});
+                continue;
+            }
+            case TokenType::SELECT: {
+                // Valor y derivada de la rama elegida; la otra no aporta.
+                if (values.size() < 3) {
+                    throw EdaError("faltan operandos");
+                }
+                Dual otherwise = values.top();
+                values.pop();
+                Dual then = values.top();
+                values.pop();
+                Dual condition = values.top();
+                values.pop();
+                values.push(condition.value != 0.0 ? then : otherwise);
+                continue;
+            }
+            default:
+                break;
+        }
+
+        std::size_t count = operandCount(token);
+        Dual operands[Function::kMaxArity];
+        for (std::size_t i = count; i > 0; --i) {
+            if (values.empty()) {
+                throw EdaError("faltan operandos");
+            }
+            operands[i - 1] = values.top();
+            values.pop();
+        }
+        double args[Function::kMaxArity];
+        for (std::size_t i = 0; i < count; ++i) {
+            args[i] = operands[i].value;
+        }
+        double value = apply(token, args);
+
+        double local[Function::kMaxArity];
+        double derivative = 0.0;
+        partials(token, args, value, local);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (operands[i].derivative != 0.0) {
+                derivative += local[i] * operands[i].derivative;
+            }
+        }
+        values.push(Dual{value, derivative});
+    }
+
+    if (values.size() != 1) {
+        throw EdaError("expresion invalida");
+    }
+    return values.top();
+}
+
+std::vector<std::string> GradientEvaluator::variablesOf(const Tree& tree) const {
+    std::vector<std::string> names;
+    collectVariables(tree.getRoot(), names);
+    return names;
+}
+
+// Postorden iterativo: cada nodo entra a la cinta despues de sus hijos, y
+// sus indices se toman de `done`, donde quedan los de los hijos ya volcados.
+void GradientEvaluator::flatten(const Tree::Node* root, const std::vector<std::string>& variables,
+                                std::vector<Entry>& tape) const {
+    struct Frame {
+        const Tree::Node* node;
+        bool expanded;
+    };
+    std::vector<Frame> frames(1, Frame{root, false});
+    std::vector<int> done;
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+        frames.pop_back();
+        const Tree::Node* node = frame.node;
+        if (!frame.expanded && (node->left || node->right)) {
+            frames.push_back(Frame{node, true});
+            if (node->right) {
+                frames.push_back(Frame{node->right, false});
+            }
+            if (node->left) {
+                frames.push_back(Frame{node->left, false});
+            }
+            continue;
+        }
+
+        int right = -1;
+        int left = -1;
+        if (node->right) {
+            right = done.back();
+            done.pop_back();
+        }
+        if (node->left) {
+            left = done.back();
+            done.pop_back();
+        }
+        int variable = -1;
+        if (node->token.type == TokenType::IDENT || node->token.type == TokenType::ANS) {
+            auto found = std::find(variables.begin(), variables.end(), variableName(node->token));
+            if (found != variables.end()) {
+                variable = static_cast<int>(found - variables.begin());
+            }
+        }
+        tape.push_back(Entry{node, left, right, variable});
+        done.push_back(static_cast<int>(tape.size()) - 1);
+    }
+}
+
+GradientEvaluator::Result GradientEvaluator::evaluate(const Tree& tree, SymbolTable& symbols,
+                                                      const std::vector<std::string>& variables) const {
+    if (tree.empty()) {
+        throw EdaError("expresion invalida");
+    }
+    std::vector<Entry> tape;
+    flatten(tree.getRoot(), variables, tape);
+
+    // Hacia adelante: valor de cada nodo en postorden.
+    std::vector<double> values(tape.size());
+    for (std::size_t i = 0; i < tape.size(); ++i) {
+        const Entry& entry = tape[i];
+        const Token& token = entry.node->token;
+        if (token.type == TokenType::NUMBER) {
+            values[i] = token.value;
+        } else if (token.type == TokenType::IDENT || token.type == TokenType::ANS) {
+            values[i] = symbols.get(variableName(token));
+        } else if (token.type == TokenType::BRANCHES) {
+            // Sin valor propio: su SELECT lee las dos ramas.
+            values[i] = 0.0;
+        } else if (token.type == TokenType::SELECT) {
+            const Entry& branches = tape[entry.right];
+            values[i] = values[entry.left] == 0.0 ? values[branches.right] : values[branches.left];
+        } else {
+            if (entry.left < 0 || (operandCount(token) == 2 && entry.right < 0)) {
+                throw EdaError("faltan operandos");
+            }
+            double args[Function::kMaxArity] = {values[entry.left], entry.right >= 0 ? values[entry.right] : 0.0};
+            values[i] = apply(token, args);
+        }
+    }
+
+    // Hacia atras: adjunto de cada nodo, empezando por la raiz.
+    Result result;
+    result.value = values.back();
+    result.partials.assign(variables.size(), 0.0);
+    std::vector<double> adjoints(tape.size(), 0.0);
+    adjoints.back() = 1.0;
+    for (std::size_t i = tape.size(); i > 0; --i) {
+        const Entry& entry = tape[i - 1];
+        double adjoint = adjoints[i - 1];
+        if (entry.variable >= 0) {
+            result.partials[entry.variable] += adjoint;
+            continue;
+        }
+        if (adjoint == 0.0 || entry.left < 0) {
+            continue;
+        }
+        if (entry.node->token.type == TokenType::SELECT) {
+            // Todo el adjunto va a la rama elegida; la condicion no aporta.
+            const Entry& branches = tape[entry.right];
+            adjoints[values[entry.left] == 0.0 ? branches.right : branches.left] += adjoint;
+            continue;
+        }
+        double args[Function::kMaxArity] = {values[entry.left], entry.right >= 0 ? values[entry.right] : 0.0};
+        double local[Function::kMaxArity];
+        partials(entry.node->token, args, values[i - 1], local);
+        adjoints[entry.left] += adjoint * local[0];
+        if (entry.right >= 0) {
+            adjoints[entry.right] += adjoint * local[1];
+        }
+    }
+    return result;
+}
+
+} // namespace edacal
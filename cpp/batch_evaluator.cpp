@@ -0,0 +1,286 @@
+#include "batch_evaluator.hpp"
+
+#include <string>
+
+namespace edacal {
+
+namespace {
+
+void failAtRow(const std::string& message, std::size_t row) {
+    throw EdaError(message + " en fila " + std::to_string(row));
+}
+
+vecmath::Comparison comparison(TokenType type) {
+    switch (type) {
+        case TokenType::LESS:
+            return vecmath::Comparison::Less;
+        case TokenType::LESS_EQUAL:
+            return vecmath::Comparison::LessEqual;
+        case TokenType::GREATER:
+            return vecmath::Comparison::Greater;
+        case TokenType::GREATER_EQUAL:
+            return vecmath::Comparison::GreaterEqual;
+        default:
+            return vecmath::Comparison::Equal;
+    }
+}
+
+} // namespace
+
+BatchEvaluator::BatchEvaluator(vecmath::Mode mode) : mode_(mode) {}
+
+void BatchEvaluator::evalPostfix(const TokenList& postfix, const Columns& columns, SymbolTable& symbols,
+                                 double* out, std::size_t rows) const {
+    std::size_t maxDepth = 0;
+    std::vector<Step<double>> steps = compile(postfix, columns, symbols, maxDepth);
+    evalRows<double>(steps, maxDepth, out, rows);
+}
+
+void BatchEvaluator::evalPostfix(const TokenList& postfix, const FloatColumns& columns, SymbolTable& symbols,
+                                 float* out, std::size_t rows, Precision precision) const {
+    std::size_t maxDepth = 0;
+    std::vector<Step<float>> steps = compile(postfix, columns, symbols, maxDepth);
+    if (precision == Precision::Single) {
+        evalRows<float>(steps, maxDepth, out, rows);
+    } else {
+        evalRows<double>(steps, maxDepth, out, rows);
+    }
+}
+
+template <typename Real, typename Storage>
+void BatchEvaluator::evalRows(const std::vector<Step<Storage>>& steps, std::size_t maxDepth, Storage* out,
+                              std::size_t rows) const {
+    std::vector<Real> stack(maxDepth * kBlockSize);
+
+    for (std::size_t offset = 0; offset < rows; offset += kBlockSize) {
+        std::size_t count = rows - offset < kBlockSize ? rows - offset : kBlockSize;
+        evalBlock(steps, stack.data(), offset, count, out + offset);
+    }
+}
+
+template <typename Storage>
+std::vector<BatchEvaluator::Step<Storage>> BatchEvaluator::compile(
+    const TokenList& postfix, const std::unordered_map<std::string, const Storage*>& columns,
+    SymbolTable& symbols, std::size_t& maxDepth) const {
+    const FunctionRegistry& builtins = FunctionRegistry::builtins();
+    const Function* sqrtFn = builtins.find("sqrt");
+    const Function* expFn = builtins.find("exp");
+    const Function* logFn = builtins.find("log");
+    const Function* minFn = builtins.find("min");
+    const Function* maxFn = builtins.find("max");
+
+    std::vector<Step<Storage>> steps;
+    std::size_t depth = 0;
+    maxDepth = 0;
+
+    for (auto it = postfix.begin(); it != postfix.end(); ++it) {
+        const Token& token = *it;
+        if (token.type == TokenType::END) {
+            break;
+        }
+
+        Step<Storage> step = {token, nullptr, Kernel::NONE};
+        std::size_t operands = 0;
+        switch (token.type) {
+            case TokenType::NUMBER:
+                break;
+            case TokenType::ANS:
+                step.token = Token(TokenType::NUMBER, token.lexeme, symbols.get("ans"));
+                break;
+            case TokenType::IDENT: {
+                auto column = columns.find(token.lexeme);
+                if (column != columns.end()) {
+                    step.column = column->second;
+                } else {
+                    step.token = Token(TokenType::NUMBER, token.lexeme, symbols.get(token.lexeme));
+                }
+                break;
+            }
+            case TokenType::UNARY_MINUS:
+            case TokenType::POWI:
+                operands = 1;
+                break;
+            case TokenType::PLUS:
+            case TokenType::MINUS:
+            case TokenType::MUL:
+            case TokenType::DIV:
+            case TokenType::POW:
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL:
+                operands = 2;
+                break;
+            case TokenType::SELECT:
+                operands = 3;
+                break;
+            case TokenType::FUNCTION:
+                operands = token.function->arity;
+                if (token.function == sqrtFn) {
+                    step.kernel = Kernel::SQRT;
+                } else if (token.function == expFn) {
+                    step.kernel = Kernel::EXP;
+                } else if (token.function == logFn) {
+                    step.kernel = Kernel::LOG;
+                } else if (token.function == minFn) {
+                    step.kernel = Kernel::MIN;
+                } else if (token.function == maxFn) {
+                    step.kernel = Kernel::MAX;
+                }
+                break;
+            default:
+                throw EdaError("token inesperado en evaluacion: " + token.lexeme);
+        }
+
+        if (operands == 0) {
+            ++depth;
+        } else {
+            if (depth < operands) {
+                throw EdaError("faltan operandos");
+            }
+            depth -= operands - 1;
+        }
+        if (depth > maxDepth) {
+            maxDepth = depth;
+        }
+        steps.push_back(step);
+    }
+
+    if (depth != 1) {
+        throw EdaError("expresion invalida");
+    }
+    return steps;
+}
+
+template <typename Real, typename Storage>
+void BatchEvaluator::evalBlock(const std::vector<Step<Storage>>& steps, Real* stack, std::size_t offset,
+                               std::size_t count, Storage* out) const {
+    std::size_t depth = 0;
+
+    for (const Step<Storage>& step : steps) {
+        const Token& token = step.token;
+        Real* top = stack + depth * kBlockSize;
+        Real* right = depth >= 1 ? top - kBlockSize : nullptr;
+        Real* left = depth >= 2 ? top - 2 * kBlockSize : nullptr;
+
+        switch (token.type) {
+            case TokenType::NUMBER:
+                for (std::size_t i = 0; i < count; ++i) {
+                    top[i] = static_cast<Real>(token.value);
+                }
+                ++depth;
+                break;
+            case TokenType::IDENT:
+                for (std::size_t i = 0; i < count; ++i) {
+                    top[i] = static_cast<Real>(step.column[offset + i]);
+                }
+                ++depth;
+                break;
+            case TokenType::UNARY_MINUS:
+                for (std::size_t i = 0; i < count; ++i) {
+                    right[i] = -right[i];
+                }
+                break;
+            case TokenType::PLUS:
+                for (std::size_t i = 0; i < count; ++i) {
+                    left[i] += right[i];
+                }
+                --depth;
+                break;
+            case TokenType::MINUS:
+                for (std::size_t i = 0; i < count; ++i) {
+                    left[i] -= right[i];
+                }
+                --depth;
+                break;
+            case TokenType::MUL:
+                for (std::size_t i = 0; i < count; ++i) {
+                    left[i] *= right[i];
+                }
+                --depth;
+                break;
+            case TokenType::DIV:
+                for (std::size_t i = 0; i < count; ++i) {
+                    if (right[i] == 0) {
+                        failAtRow("division por cero", offset + i);
+                    }
+                }
+                for (std::size_t i = 0; i < count; ++i) {
+                    left[i] /= right[i];
+                }
+                --depth;
+                break;
+            case TokenType::POW:
+                vecmath::pow(left, right, left, count, mode_);
+                --depth;
+                break;
+            case TokenType::POWI:
+                vecmath::powi(right, static_cast<long>(token.value), right, count);
+                break;
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL:
+                vecmath::compare(comparison(token.type), left, right, left, count);
+                --depth;
+                break;
+            case TokenType::SELECT: {
+                Real* condition = top - 3 * kBlockSize;
+                vecmath::select(condition, left, right, condition, count);
+                depth -= 2;
+                break;
+            }
+            case TokenType::FUNCTION: {
+                const Function* fn = token.function;
+                if (step.kernel == Kernel::SQRT) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (right[i] < 0) {
+                            failAtRow("sqrt con argumento negativo", offset + i);
+                        }
+                    }
+                    vecmath::sqrt(right, right, count);
+                } else if (step.kernel == Kernel::EXP) {
+                    vecmath::exp(right, right, count, mode_);
+                } else if (step.kernel == Kernel::LOG) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (right[i] <= 0) {
+                            failAtRow("log con argumento no positivo", offset + i);
+                        }
+                    }
+                    vecmath::log(right, right, count, mode_);
+                } else if (step.kernel == Kernel::MIN) {
+                    vecmath::min(left, right, left, count);
+                    --depth;
+                } else if (step.kernel == Kernel::MAX) {
+                    vecmath::max(left, right, left, count);
+                    --depth;
+                } else {
+                    Real* first = top - fn->arity * kBlockSize;
+                    double args[Function::kMaxArity];
+                    for (std::size_t i = 0; i < count; ++i) {
+                        for (std::size_t a = 0; a < fn->arity; ++a) {
+                            args[a] = first[a * kBlockSize + i];
+                        }
+                        try {
+                            first[i] = static_cast<Real>(fn->impl(args));
+                        } catch (const EdaError& err) {
+                            failAtRow(err.what(), offset + i);
+                        }
+                    }
+                    depth -= fn->arity - 1;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<Storage>(stack[i]);
+    }
+}
+
+} // namespace edacal
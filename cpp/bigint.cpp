@@ -0,0 +1,415 @@
+#include "bigint.hpp"
+
+#include "errors.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace edacal {
+
+namespace {
+
+typedef std::vector<std::uint32_t> Magnitude;
+
+const std::uint64_t kBase = 1ULL << 32;
+const std::uint32_t kDecimalChunk = 1000000000U;
+const std::int64_t kSmallMax = INT64_MAX;
+
+void trim(Magnitude& a) {
+    while (!a.empty() && a.back() == 0) {
+        a.pop_back();
+    }
+}
+
+int compareMagnitude(const Magnitude& a, const Magnitude& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (std::size_t i = a.size(); i > 0; --i) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+Magnitude addMagnitude(const Magnitude& a, const Magnitude& b) {
+    const Magnitude& longer = a.size() >= b.size() ? a : b;
+    const Magnitude& shorter = a.size() >= b.size() ? b : a;
+    Magnitude sum(longer.size() + 1, 0);
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < longer.size(); ++i) {
+        std::uint64_t s = static_cast<std::uint64_t>(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+        sum[i] = static_cast<std::uint32_t>(s);
+        carry = s >> 32;
+    }
+    sum[longer.size()] = static_cast<std::uint32_t>(carry);
+    trim(sum);
+    return sum;
+}
+
+// Requiere a >= b.
+Magnitude subMagnitude(const Magnitude& a, const Magnitude& b) {
+    Magnitude diff(a.size(), 0);
+    std::int64_t borrow = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::int64_t d = static_cast<std::int64_t>(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+        borrow = d < 0 ? 1 : 0;
+        diff[i] = static_cast<std::uint32_t>(d + (borrow ? static_cast<std::int64_t>(kBase) : 0));
+    }
+    trim(diff);
+    return diff;
+}
+
+Magnitude mulMagnitude(const Magnitude& a, const Magnitude& b) {
+    if (a.empty() || b.empty()) {
+        return Magnitude();
+    }
+    Magnitude product(a.size() + b.size(), 0);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::uint64_t carry = 0;
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            std::uint64_t t = static_cast<std::uint64_t>(a[i]) * b[j] + product[i + j] + carry;
+            product[i + j] = static_cast<std::uint32_t>(t);
+            carry = t >> 32;
+        }
+        product[i + b.size()] = static_cast<std::uint32_t>(carry);
+    }
+    trim(product);
+    return product;
+}
+
+std::uint32_t divSmallMagnitude(Magnitude& a, std::uint32_t divisor) {
+    std::uint64_t remainder = 0;
+    for (std::size_t i = a.size(); i > 0; --i) {
+        std::uint64_t current = (remainder << 32) | a[i - 1];
+        a[i - 1] = static_cast<std::uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    trim(a);
+    return static_cast<std::uint32_t>(remainder);
+}
+
+int leadingZeros(std::uint32_t value) {
+    int count = 0;
+    while (!(value & 0x80000000U)) {
+        value <<= 1;
+        ++count;
+    }
+    return count;
+}
+
+// Division larga de Knuth (algoritmo D) sobre limbs de 32 bits.
+void divModMagnitude(const Magnitude& u, const Magnitude& v, Magnitude& quotient, Magnitude& remainder) {
+    if (compareMagnitude(u, v) < 0) {
+        quotient.clear();
+        remainder = u;
+        return;
+    }
+    if (v.size() == 1) {
+        quotient = u;
+        std::uint32_t r = divSmallMagnitude(quotient, v[0]);
+        remainder.assign(r ? 1 : 0, r);
+        return;
+    }
+
+    std::size_t n = v.size();
+    std::size_t m = u.size() - n;
+    int shift = leadingZeros(v[n - 1]);
+    Magnitude vn(n);
+    Magnitude un(u.size() + 1);
+    for (std::size_t i = n - 1; i > 0; --i) {
+        vn[i] = shift ? (v[i] << shift) | (v[i - 1] >> (32 - shift)) : v[i];
+    }
+    vn[0] = v[0] << shift;
+    un[u.size()] = shift ? u[u.size() - 1] >> (32 - shift) : 0;
+    for (std::size_t i = u.size() - 1; i > 0; --i) {
+        un[i] = shift ? (u[i] << shift) | (u[i - 1] >> (32 - shift)) : u[i];
+    }
+    un[0] = u[0] << shift;
+
+    quotient.assign(m + 1, 0);
+    for (std::size_t j = m + 1; j > 0; --j) {
+        std::size_t k = j - 1;
+        std::uint64_t numerator = (static_cast<std::uint64_t>(un[k + n]) << 32) | un[k + n - 1];
+        std::uint64_t qhat = numerator / vn[n - 1];
+        std::uint64_t rhat = numerator % vn[n - 1];
+        while (qhat >= kBase || qhat * vn[n - 2] > ((rhat << 32) | un[k + n - 2])) {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat >= kBase) {
+                break;
+            }
+        }
+
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint64_t p = qhat * vn[i];
+            std::int64_t t = static_cast<std::int64_t>(un[i + k]) - borrow - static_cast<std::int64_t>(p & 0xFFFFFFFFULL);
+            un[i + k] = static_cast<std::uint32_t>(t);
+            borrow = static_cast<std::int64_t>(p >> 32) - (t >> 32);
+        }
+        std::int64_t t = static_cast<std::int64_t>(un[k + n]) - borrow;
+        un[k + n] = static_cast<std::uint32_t>(t);
+
+        quotient[k] = static_cast<std::uint32_t>(qhat);
+        if (t < 0) {
+            --quotient[k];
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint64_t s = static_cast<std::uint64_t>(un[i + k]) + vn[i] + carry;
+                un[i + k] = static_cast<std::uint32_t>(s);
+                carry = s >> 32;
+            }
+            un[k + n] = static_cast<std::uint32_t>(un[k + n] + carry);
+        }
+    }
+
+    remainder.assign(n, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        remainder[i] = shift ? (un[i] >> shift) | (un[i + 1] << (32 - shift)) : un[i];
+    }
+    trim(quotient);
+    trim(remainder);
+}
+
+} // namespace
+
+BigInt::BigInt() : small_(0), negative_(false) {}
+
+BigInt::BigInt(std::int64_t value) : small_(value), negative_(false) {
+    if (value == INT64_MIN) {
+        *this = fromMagnitude(Magnitude{0U, 0x80000000U}, true);
+    }
+}
+
+BigInt BigInt::fromMagnitude(Magnitude magnitude, bool negative) {
+    trim(magnitude);
+    BigInt result;
+    if (magnitude.size() <= 2) {
+        std::uint64_t value = magnitude.empty() ? 0 : magnitude[0];
+        if (magnitude.size() == 2) {
+            value |= static_cast<std::uint64_t>(magnitude[1]) << 32;
+        }
+        if (value <= static_cast<std::uint64_t>(kSmallMax)) {
+            result.small_ = negative ? -static_cast<std::int64_t>(value) : static_cast<std::int64_t>(value);
+            return result;
+        }
+    }
+    result.limbs_ = std::move(magnitude);
+    result.negative_ = negative;
+    return result;
+}
+
+BigInt::Magnitude BigInt::magnitude() const {
+    if (!limbs_.empty()) {
+        return limbs_;
+    }
+    std::uint64_t value = small_ < 0 ? static_cast<std::uint64_t>(-small_) : static_cast<std::uint64_t>(small_);
+    Magnitude result;
+    if (value) {
+        result.push_back(static_cast<std::uint32_t>(value));
+        if (value >> 32) {
+            result.push_back(static_cast<std::uint32_t>(value >> 32));
+        }
+    }
+    return result;
+}
+
+BigInt BigInt::parse(const std::string& text) {
+    std::size_t start = 0;
+    bool negative = false;
+    if (!text.empty() && (text[0] == '-' || text[0] == '+')) {
+        negative = text[0] == '-';
+        start = 1;
+    }
+    if (start == text.size()) {
+        throw EdaError("entero invalido: " + text);
+    }
+    Magnitude magnitude;
+    for (std::size_t i = start; i < text.size(); i += 9) {
+        std::size_t end = std::min(text.size(), i + 9);
+        std::uint32_t chunk = 0;
+        std::uint32_t scale = 1;
+        for (std::size_t j = i; j < end; ++j) {
+            if (!std::isdigit(static_cast<unsigned char>(text[j]))) {
+                throw EdaError("entero invalido: " + text);
+            }
+            chunk = chunk * 10 + static_cast<std::uint32_t>(text[j] - '0');
+            scale *= 10;
+        }
+        std::uint64_t carry = chunk;
+        for (std::size_t k = 0; k < magnitude.size(); ++k) {
+            std::uint64_t t = static_cast<std::uint64_t>(magnitude[k]) * scale + carry;
+            magnitude[k] = static_cast<std::uint32_t>(t);
+            carry = t >> 32;
+        }
+        if (carry) {
+            magnitude.push_back(static_cast<std::uint32_t>(carry));
+        }
+    }
+    return fromMagnitude(magnitude, negative);
+}
+
+BigInt BigInt::powerOfTwo(unsigned exponent) {
+    Magnitude magnitude(exponent / 32 + 1, 0);
+    magnitude.back() = 1U << (exponent % 32);
+    return fromMagnitude(magnitude, false);
+}
+
+bool BigInt::isZero() const {
+    return limbs_.empty() && small_ == 0;
+}
+
+bool BigInt::isNegative() const {
+    return limbs_.empty() ? small_ < 0 : negative_;
+}
+
+bool BigInt::isSmall() const {
+    return limbs_.empty();
+}
+
+std::size_t BigInt::bitLength() const {
+    Magnitude digits = magnitude();
+    if (digits.empty()) {
+        return 0;
+    }
+    return 32 * digits.size() - static_cast<std::size_t>(leadingZeros(digits.back()));
+}
+
+int BigInt::compare(const BigInt& other) const {
+    if (isSmall() && other.isSmall()) {
+        return small_ < other.small_ ? -1 : (small_ > other.small_ ? 1 : 0);
+    }
+    bool negative = isNegative();
+    if (negative != other.isNegative()) {
+        return negative ? -1 : 1;
+    }
+    int magnitudeOrder = compareMagnitude(magnitude(), other.magnitude());
+    return negative ? -magnitudeOrder : magnitudeOrder;
+}
+
+BigInt BigInt::operator-() const {
+    if (isSmall()) {
+        BigInt result;
+        result.small_ = -small_;
+        return result;
+    }
+    return fromMagnitude(limbs_, !negative_);
+}
+
+BigInt BigInt::abs() const {
+    return isNegative() ? -*this : *this;
+}
+
+BigInt operator+(const BigInt& a, const BigInt& b) {
+    std::int64_t sum;
+    if (a.isSmall() && b.isSmall() && !__builtin_add_overflow(a.small_, b.small_, &sum) && sum != INT64_MIN) {
+        BigInt result;
+        result.small_ = sum;
+        return result;
+    }
+    bool aNegative = a.isNegative();
+    bool bNegative = b.isNegative();
+    BigInt::Magnitude am = a.magnitude();
+    BigInt::Magnitude bm = b.magnitude();
+    if (aNegative == bNegative) {
+        return BigInt::fromMagnitude(addMagnitude(am, bm), aNegative);
+    }
+    if (compareMagnitude(am, bm) >= 0) {
+        return BigInt::fromMagnitude(subMagnitude(am, bm), aNegative);
+    }
+    return BigInt::fromMagnitude(subMagnitude(bm, am), bNegative);
+}
+
+BigInt operator-(const BigInt& a, const BigInt& b) {
+    return a + (-b);
+}
+
+BigInt operator*(const BigInt& a, const BigInt& b) {
+    std::int64_t product;
+    if (a.isSmall() && b.isSmall() && !__builtin_mul_overflow(a.small_, b.small_, &product) && product != INT64_MIN) {
+        BigInt result;
+        result.small_ = product;
+        return result;
+    }
+    return BigInt::fromMagnitude(mulMagnitude(a.magnitude(), b.magnitude()), a.isNegative() != b.isNegative());
+}
+
+BigInt operator/(const BigInt& a, const BigInt& b) {
+    BigInt quotient;
+    BigInt remainder;
+    BigInt::divMod(a, b, quotient, remainder);
+    return quotient;
+}
+
+void BigInt::divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+    if (b.isZero()) {
+        throw EdaError("division por cero");
+    }
+    if (a.isSmall() && b.isSmall()) {
+        quotient = BigInt(a.small_ / b.small_);
+        remainder = BigInt(a.small_ % b.small_);
+        return;
+    }
+    Magnitude q;
+    Magnitude r;
+    divModMagnitude(a.magnitude(), b.magnitude(), q, r);
+    quotient = fromMagnitude(q, a.isNegative() != b.isNegative());
+    remainder = fromMagnitude(r, a.isNegative());
+}
+
+BigInt BigInt::gcd(const BigInt& a, const BigInt& b) {
+    BigInt x = a.abs();
+    BigInt y = b.abs();
+    while (!y.isZero()) {
+        if (x.isSmall() && y.isSmall()) {
+            std::uint64_t u = static_cast<std::uint64_t>(x.small_);
+            std::uint64_t v = static_cast<std::uint64_t>(y.small_);
+            while (v) {
+                std::uint64_t t = u % v;
+                u = v;
+                v = t;
+            }
+            return BigInt(static_cast<std::int64_t>(u));
+        }
+        BigInt quotient;
+        BigInt remainder;
+        divMod(x, y, quotient, remainder);
+        x = y;
+        y = remainder;
+    }
+    return x;
+}
+
+double BigInt::toDouble() const {
+    if (isSmall()) {
+        return static_cast<double>(small_);
+    }
+    double value = 0.0;
+    for (std::size_t i = limbs_.size(); i > 0; --i) {
+        value = value * static_cast<double>(kBase) + limbs_[i - 1];
+    }
+    return negative_ ? -value : value;
+}
+
+std::string BigInt::toString() const {
+    if (isSmall()) {
+        return std::to_string(small_);
+    }
+    Magnitude rest = limbs_;
+    std::vector<std::uint32_t> chunks;
+    while (!rest.empty()) {
+        chunks.push_back(divSmallMagnitude(rest, kDecimalChunk));
+    }
+    std::string text = negative_ ? "-" : "";
+    text += std::to_string(chunks.back());
+    for (std::size_t i = chunks.size() - 1; i > 0; --i) {
+        std::string part = std::to_string(chunks[i - 1]);
+        text += std::string(9 - part.size(), '0') + part;
+    }
+    return text;
+}
+
+} // namespace edacal
@@ -0,0 +1,128 @@
+#include "char_scan.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace edacal {
+namespace scan {
+
+// 1 = espacio (\t \n \v \f \r y ' '), 2 = digito, 4 = letra o '_'.
+const unsigned char kCharClass[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0,
+    0, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 0, 0, 0, 4,
+    0, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+namespace {
+
+#if defined(__AVX2__)
+const std::size_t kWidth = 32;
+typedef __m256i Block;
+
+Block load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+Block splat(char c) { return _mm256_set1_epi8(c); }
+Block inRange(Block x, char lo, unsigned char span) {
+    // x - lo <= span sin signo: min(x - lo, span) == x - lo.
+    Block shifted = _mm256_sub_epi8(x, splat(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, splat(static_cast<char>(span))), shifted);
+}
+Block either(Block a, Block b) { return _mm256_or_si256(a, b); }
+Block equal(Block x, char c) { return _mm256_cmpeq_epi8(x, splat(c)); }
+unsigned mask(Block m) { return static_cast<unsigned>(_mm256_movemask_epi8(m)); }
+const unsigned kAll = 0xFFFFFFFFu;
+#elif defined(__SSE2__)
+const std::size_t kWidth = 16;
+typedef __m128i Block;
+
+Block load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+Block splat(char c) { return _mm_set1_epi8(c); }
+Block inRange(Block x, char lo, unsigned char span) {
+    Block shifted = _mm_sub_epi8(x, splat(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, splat(static_cast<char>(span))), shifted);
+}
+Block either(Block a, Block b) { return _mm_or_si128(a, b); }
+Block equal(Block x, char c) { return _mm_cmpeq_epi8(x, splat(c)); }
+unsigned mask(Block m) { return static_cast<unsigned>(_mm_movemask_epi8(m)); }
+const unsigned kAll = 0xFFFFu;
+#endif
+
+std::size_t skipClass(const char* text, std::size_t pos, std::size_t size, unsigned char cls) {
+    while (pos < size && (kCharClass[static_cast<unsigned char>(text[pos])] & cls)) {
+        ++pos;
+    }
+    return pos;
+}
+
+} // namespace
+
+std::size_t skipSpacesScalar(const char* text, std::size_t pos, std::size_t size) {
+    return skipClass(text, pos, size, kSpace);
+}
+
+std::size_t skipDigitsScalar(const char* text, std::size_t pos, std::size_t size) {
+    return skipClass(text, pos, size, kDigit);
+}
+
+// Las corridas cortas (un espacio entre tokens, numeros de pocas cifras)
+// son las mas comunes: se mira el primer byte antes de cargar un bloque.
+std::size_t skipSpaces(const char* text, std::size_t pos, std::size_t size) {
+#if defined(__SSE2__)
+    if (pos >= size || !isSpace(text[pos])) {
+        return pos;
+    }
+    while (pos + kWidth <= size) {
+        Block x = load(text + pos);
+        unsigned spaces = mask(either(equal(x, ' '), inRange(x, '\t', '\r' - '\t')));
+        if (spaces != kAll) {
+            return pos + static_cast<std::size_t>(__builtin_ctz(~spaces));
+        }
+        pos += kWidth;
+    }
+#endif
+    return skipSpacesScalar(text, pos, size);
+}
+
+std::size_t skipDigits(const char* text, std::size_t pos, std::size_t size) {
+#if defined(__SSE2__)
+    if (pos >= size || !isDigit(text[pos])) {
+        return pos;
+    }
+    while (pos + kWidth <= size) {
+        unsigned digits = mask(inRange(load(text + pos), '0', 9));
+        if (digits != kAll) {
+            return pos + static_cast<std::size_t>(__builtin_ctz(~digits));
+        }
+        pos += kWidth;
+    }
+#endif
+    return skipDigitsScalar(text, pos, size);
+}
+
+const char* simdPath() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "escalar";
+#endif
+}
+
+} // namespace scan
+} // namespace edacal
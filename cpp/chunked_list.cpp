@@ -0,0 +1,12 @@
+#include "chunked_list.hpp"
+#include "token.hpp"
+
+#include <cstddef>
+
+namespace edacal {
+
+template class ChunkedList<Token>;
+template class ChunkedList<double, 64>;
+template class ChunkedList<std::size_t>;
+
+} // namespace edacal
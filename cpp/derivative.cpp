@@ -0,0 +1,492 @@
+#include "derivative.hpp"
+
+#include "printer.hpp"
+#include "vecmath.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace edacal {
+
+namespace {
+
+class Graph {
+public:
+    explicit Graph(const std::string& variable) : variable_(variable) {
+        const FunctionRegistry& builtins = FunctionRegistry::builtins();
+        sqrt_ = builtins.find("sqrt");
+        exp_ = builtins.find("exp");
+        log_ = builtins.find("log");
+        sin_ = builtins.find("sin");
+        cos_ = builtins.find("cos");
+        abs_ = builtins.find("abs");
+        hypot_ = builtins.find("hypot");
+    }
+
+    std::size_t size() const { return nodes_.size(); }
+
+    int fromTree(const Tree::Node* root);
+    int derive(int id);
+    std::size_t treeSize(int id, std::vector<double>& sizes) const;
+    Tree::Node* toTree(int id) const;
+
+private:
+    struct Node {
+        Token token;
+        int left;
+        int right;
+    };
+
+    struct Key {
+        TokenType type;
+        std::uint64_t bits;
+        const Function* function;
+        std::string name;
+        int left;
+        int right;
+
+        bool operator==(const Key& other) const {
+            return type == other.type && bits == other.bits && function == other.function &&
+                   name == other.name && left == other.left && right == other.right;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::size_t h = std::hash<std::string>()(key.name);
+            h = h * 31 + static_cast<std::size_t>(key.type);
+            h = h * 31 + std::hash<std::uint64_t>()(key.bits);
+            h = h * 31 + std::hash<const void*>()(key.function);
+            h = h * 31 + static_cast<std::size_t>(key.left + 1);
+            h = h * 31 + static_cast<std::size_t>(key.right + 1);
+            return h;
+        }
+    };
+
+    std::string variable_;
+    std::vector<Node> nodes_;
+    std::unordered_map<Key, int, KeyHash> index_;
+    std::unordered_map<int, int> derivatives_;
+    const Function* sqrt_;
+    const Function* exp_;
+    const Function* log_;
+    const Function* sin_;
+    const Function* cos_;
+    const Function* abs_;
+    const Function* hypot_;
+
+    int intern(const Token& token, int left, int right);
+    int make(const Token& token, int left, int right);
+    int number(double value) { return intern(Token(TokenType::NUMBER, formatNumber(value), value), -1, -1); }
+    int add(int a, int b) { return make(Token(TokenType::PLUS, "+"), a, b); }
+    int sub(int a, int b) { return make(Token(TokenType::MINUS, "-"), a, b); }
+    int mul(int a, int b) { return make(Token(TokenType::MUL, "*"), a, b); }
+    int div(int a, int b) { return make(Token(TokenType::DIV, "/"), a, b); }
+    int pow(int a, int b) { return make(Token(TokenType::POW, "^"), a, b); }
+    int neg(int a) { return make(Token(TokenType::UNARY_MINUS, "neg"), a, -1); }
+    int call(const Function* fn, int a, int b = -1) { return make(Token(fn, fn->name), a, b); }
+
+    bool isNumber(int id) const { return nodes_[id].token.type == TokenType::NUMBER; }
+    bool isNumber(int id, double value) const { return isNumber(id) && nodes_[id].token.value == value; }
+    bool dependsOnVariable(int id);
+    int deriveNode(int id);
+};
+
+// Postorden con una pila explicita (una suma larga da un arbol tan profundo
+// como terminos tiene); `done` guarda el id de cada subarbol ya internado.
+int Graph::fromTree(const Tree::Node* root) {
+    struct Frame {
+        const Tree::Node* node;
+        bool expanded;
+    };
+    std::vector<Frame> frames(1, Frame{root, false});
+    std::vector<int> done;
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+        frames.pop_back();
+        const Tree::Node* node = frame.node;
+        if (!frame.expanded && (node->left || node->right)) {
+            frames.push_back(Frame{node, true});
+            if (node->right) {
+                frames.push_back(Frame{node->right, false});
+            }
+            if (node->left) {
+                frames.push_back(Frame{node->left, false});
+            }
+            continue;
+        }
+        int right = -1;
+        int left = -1;
+        if (node->right) {
+            right = done.back();
+            done.pop_back();
+        }
+        if (node->left) {
+            left = done.back();
+            done.pop_back();
+        }
+        done.push_back(make(node->token, left, right));
+    }
+    return done.back();
+}
+
+int Graph::intern(const Token& token, int left, int right) {
+    Key key;
+    key.type = token.type;
+    std::memcpy(&key.bits, &token.value, sizeof(key.bits));
+    key.function = token.function;
+    key.name = token.type == TokenType::IDENT ? token.lexeme : std::string();
+    key.left = left;
+    key.right = right;
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        return found->second;
+    }
+    nodes_.push_back(Node{token, left, right});
+    int id = static_cast<int>(nodes_.size()) - 1;
+    index_.emplace(key, id);
+    return id;
+}
+
+// Construye un nodo ya simplificado. Los pliegues de constantes que fallarian
+// (division por cero, sqrt negativo) se dejan para que el error salga al evaluar.
+int Graph::make(const Token& token, int left, int right) {
+    bool constantLeft = left >= 0 && isNumber(left);
+    bool constantRight = right < 0 || isNumber(right);
+    bool foldable = token.type != TokenType::FUNCTION || token.function->pure;
+    if (constantLeft && constantRight && foldable) {
+        double a = nodes_[left].token.value;
+        double b = right >= 0 ? nodes_[right].token.value : 0.0;
+        switch (token.type) {
+            case TokenType::PLUS: return number(a + b);
+            case TokenType::MINUS: return number(a - b);
+            case TokenType::MUL: return number(a * b);
+            case TokenType::DIV:
+                if (b != 0.0) {
+                    return number(a / b);
+                }
+                break;
+            case TokenType::POW: return number(std::pow(a, b));
+            case TokenType::POWI: return number(vecmath::powi(a, static_cast<long>(token.value)));
+            case TokenType::UNARY_MINUS: return number(-a);
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL:
+                return number(compareValues(token.type, a, b) ? 1.0 : 0.0);
+            case TokenType::FUNCTION:
+                try {
+                    double args[Function::kMaxArity] = {a, b};
+                    return number(token.function->impl(args));
+                } catch (const EdaError&) {
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (token.type) {
+        case TokenType::PLUS:
+            if (isNumber(left, 0.0)) {
+                return right;
+            }
+            if (isNumber(right, 0.0)) {
+                return left;
+            }
+            if (nodes_[right].token.type == TokenType::UNARY_MINUS) {
+                return sub(left, nodes_[right].left);
+            }
+            if (isNumber(right) && !isNumber(left)) {
+                return intern(token, right, left);
+            }
+            break;
+        case TokenType::MINUS:
+            if (isNumber(right, 0.0)) {
+                return left;
+            }
+            if (isNumber(left, 0.0)) {
+                return neg(right);
+            }
+            if (left == right) {
+                return number(0.0);
+            }
+            if (nodes_[right].token.type == TokenType::UNARY_MINUS) {
+                return add(left, nodes_[right].left);
+            }
+            break;
+        case TokenType::MUL:
+            if (isNumber(right) && !isNumber(left)) {
+                return mul(right, left);
+            }
+            if (isNumber(left, 0.0)) {
+                return left;
+            }
+            if (isNumber(left, 1.0)) {
+                return right;
+            }
+            if (isNumber(left, -1.0)) {
+                return neg(right);
+            }
+            if (nodes_[left].token.type == TokenType::UNARY_MINUS) {
+                return neg(mul(nodes_[left].left, right));
+            }
+            if (nodes_[right].token.type == TokenType::UNARY_MINUS) {
+                return neg(mul(left, nodes_[right].left));
+            }
+            if (isNumber(left) && nodes_[right].token.type == TokenType::MUL && isNumber(nodes_[right].left)) {
+                return mul(number(nodes_[left].token.value * nodes_[nodes_[right].left].token.value),
+                           nodes_[right].right);
+            }
+            break;
+        case TokenType::DIV:
+            if (isNumber(right, 1.0)) {
+                return left;
+            }
+            if (isNumber(left, 0.0) && !isNumber(right, 0.0)) {
+                return left;
+            }
+            if (left == right && !isNumber(left)) {
+                return number(1.0);
+            }
+            break;
+        case TokenType::POW:
+            if (isNumber(right, 1.0)) {
+                return left;
+            }
+            if (isNumber(right, 0.0)) {
+                return number(1.0);
+            }
+            break;
+        case TokenType::POWI:
+            if (token.value == 1.0) {
+                return left;
+            }
+            if (token.value == 0.0) {
+                return number(1.0);
+            }
+            break;
+        case TokenType::UNARY_MINUS:
+            if (nodes_[left].token.type == TokenType::UNARY_MINUS) {
+                return nodes_[left].left;
+            }
+            break;
+        case TokenType::SELECT:
+            // Ramas iguales (como la derivada de select(c, 1, 2)) o condicion
+            // constante: el resultado es una sola rama.
+            if (nodes_[right].left == nodes_[right].right) {
+                return nodes_[right].left;
+            }
+            if (constantLeft) {
+                return nodes_[left].token.value != 0.0 ? nodes_[right].left : nodes_[right].right;
+            }
+            break;
+        default:
+            break;
+    }
+    return intern(token, left, right);
+}
+
+bool Graph::dependsOnVariable(int id) {
+    return !isNumber(derive(id), 0.0);
+}
+
+// Deriva primero, con una pila explicita, los operandos cuya derivada usa
+// cada nodo; deriveNode los encuentra ya memorizados y no vuelve a bajar.
+int Graph::derive(int id) {
+    std::vector<int> pending(1, id);
+    while (!pending.empty()) {
+        int current = pending.back();
+        if (derivatives_.count(current)) {
+            pending.pop_back();
+            continue;
+        }
+        const Node& node = nodes_[current];
+        int first = node.left;
+        int second = node.right;
+        switch (node.token.type) {
+            case TokenType::SELECT:
+                // Solo las ramas: la condicion no se deriva.
+                first = nodes_[node.right].left;
+                second = nodes_[node.right].right;
+                break;
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL:
+                first = -1;
+                second = -1;
+                break;
+            default:
+                break;
+        }
+        bool ready = true;
+        if (second >= 0 && !derivatives_.count(second)) {
+            pending.push_back(second);
+            ready = false;
+        }
+        if (first >= 0 && !derivatives_.count(first)) {
+            pending.push_back(first);
+            ready = false;
+        }
+        if (ready) {
+            pending.pop_back();
+            derivatives_[current] = deriveNode(current);
+        }
+    }
+    return derivatives_[id];
+}
+
+int Graph::deriveNode(int id) {
+    Node node = nodes_[id];
+    int u = node.left;
+    int v = node.right;
+    int result = -1;
+    switch (node.token.type) {
+        case TokenType::NUMBER:
+            result = number(0.0);
+            break;
+        case TokenType::IDENT:
+        case TokenType::ANS: {
+            static const std::string kAns("ans");
+            const std::string& name = node.token.type == TokenType::ANS ? kAns : node.token.lexeme;
+            result = number(name == variable_ ? 1.0 : 0.0);
+            break;
+        }
+        case TokenType::PLUS:
+            result = add(derive(u), derive(v));
+            break;
+        case TokenType::MINUS:
+            result = sub(derive(u), derive(v));
+            break;
+        case TokenType::UNARY_MINUS:
+            result = neg(derive(u));
+            break;
+        case TokenType::MUL:
+            result = add(mul(derive(u), v), mul(u, derive(v)));
+            break;
+        case TokenType::DIV:
+            result = div(sub(mul(derive(u), v), mul(u, derive(v))), pow(v, number(2.0)));
+            break;
+        case TokenType::POW:
+            if (!dependsOnVariable(v)) {
+                result = mul(mul(v, pow(u, sub(v, number(1.0)))), derive(u));
+            } else {
+                result = mul(id, add(mul(derive(v), call(log_, u)), div(mul(v, derive(u)), u)));
+            }
+            break;
+        case TokenType::POWI: {
+            double n = node.token.value;
+            Token lowered(TokenType::POWI, "^" + std::to_string(static_cast<long>(n - 1.0)), n - 1.0);
+            result = mul(mul(number(n), make(lowered, u, -1)), derive(u));
+            break;
+        }
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+            // Constante a trozos: 0 salvo en el salto, que no se deriva.
+            result = number(0.0);
+            break;
+        case TokenType::SELECT: {
+            // La derivada de la rama elegida, con la misma condicion.
+            Node branches = nodes_[v];
+            int then = derive(branches.left);
+            int otherwise = derive(branches.right);
+            result = make(node.token, u, make(branches.token, then, otherwise));
+            break;
+        }
+        case TokenType::FUNCTION: {
+            const Function* fn = node.token.function;
+            if (fn == sqrt_) {
+                result = div(derive(u), mul(number(2.0), id));
+            } else if (fn == exp_) {
+                result = mul(id, derive(u));
+            } else if (fn == log_) {
+                result = div(derive(u), u);
+            } else if (fn == sin_) {
+                result = mul(call(cos_, u), derive(u));
+            } else if (fn == cos_) {
+                result = neg(mul(call(sin_, u), derive(u)));
+            } else if (fn == abs_) {
+                result = mul(div(u, id), derive(u));
+            } else if (fn == hypot_) {
+                result = div(add(mul(u, derive(u)), mul(v, derive(v))), id);
+            } else {
+                throw EdaError("funcion sin derivada simbolica: " + fn->name);
+            }
+            break;
+        }
+        default:
+            throw EdaError("token inesperado en derivada: " + node.token.lexeme);
+    }
+    return result;
+}
+
+// Tamano del Tree que se obtiene al expandir el subgrafo (en double para no
+// desbordar en grafos con mucha comparticion).
+std::size_t Graph::treeSize(int id, std::vector<double>& sizes) const {
+    sizes.assign(nodes_.size(), 0.0);
+    for (std::size_t i = 0; i <= static_cast<std::size_t>(id); ++i) {
+        const Node& node = nodes_[i];
+        sizes[i] = 1.0 + (node.left >= 0 ? sizes[node.left] : 0.0) + (node.right >= 0 ? sizes[node.right] : 0.0);
+    }
+    double size = sizes[id];
+    return size > static_cast<double>(Differentiator::kMaxTreeNodes) ? Differentiator::kMaxTreeNodes + 1
+                                                                     : static_cast<std::size_t>(size);
+}
+
+// Expande el subgrafo con una pila explicita: cada entrada es un nodo del
+// grafo y el puntero del Tree donde va su copia.
+Tree::Node* Graph::toTree(int id) const {
+    Tree::Node* root = nullptr;
+    std::vector<std::pair<int, Tree::Node**>> pending(1, std::make_pair(id, &root));
+    while (!pending.empty()) {
+        const Node& node = nodes_[pending.back().first];
+        Tree::Node** slot = pending.back().second;
+        pending.pop_back();
+        *slot = new Tree::Node(node.token);
+        if (node.right >= 0) {
+            pending.push_back(std::make_pair(node.right, &(*slot)->right));
+        }
+        if (node.left >= 0) {
+            pending.push_back(std::make_pair(node.left, &(*slot)->left));
+        }
+    }
+    return root;
+}
+
+} // namespace
+
+Tree Differentiator::differentiate(const Tree& tree, const std::string& variable) const {
+    Stats stats;
+    return differentiate(tree, variable, stats);
+}
+
+Tree Differentiator::differentiate(const Tree& tree, const std::string& variable, Stats& stats) const {
+    if (tree.empty()) {
+        throw EdaError("expresion invalida");
+    }
+    Graph graph(variable);
+    int root = graph.derive(graph.fromTree(tree.getRoot()));
+
+    std::vector<double> sizes;
+    stats.graphNodes = graph.size();
+    stats.treeNodes = graph.treeSize(root, sizes);
+    if (stats.treeNodes > kMaxTreeNodes) {
+        throw EdaError("derivada demasiado grande");
+    }
+    Tree result;
+    result.setRoot(graph.toTree(root));
+    return result;
+}
+
+} // namespace edacal
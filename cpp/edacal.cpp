@@ -0,0 +1,219 @@
+#include "edacal.h"
+
+#include "errors.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "register_vm.hpp"
+#include "symbols.hpp"
+#include "tokenizer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+static_assert(static_cast<int>(edacal::ErrorKind::NONE) == EDACAL_OK &&
+                  static_cast<int>(edacal::ErrorKind::DOMAIN) == EDACAL_ERROR_DOMAIN,
+              "edacal_error_kind debe seguir a ErrorKind");
+
+struct edacal_context {
+    edacal::SymbolTable symbols;
+    edacal::Tokenizer tokenizer;
+    edacal::Parser parser;
+    edacal::Optimizer optimizer;
+};
+
+struct edacal_expr {
+    edacal_expr(edacal_context* owner, const edacal::TokenList& postfix)
+        : context(owner),
+          vm(postfix),
+          bound(vm.variables().size(), nullptr),
+          values(vm.variables().size(), 0.0) {}
+
+    edacal_context* context;
+    edacal::RegisterVM vm;
+    // Puntero ligado a cada variable de vm.variables(), o nullptr si se lee
+    // de la tabla del contexto.
+    std::vector<const double*> bound;
+    // Valores resueltos en cada evaluacion, sin pedir memoria.
+    std::vector<double> values;
+    // Todas las ligaduras por nombre, para evaluar sin la maquina compilada.
+    std::vector<std::pair<std::string, const double*>> bindings;
+};
+
+namespace {
+
+using edacal::Error;
+using edacal::ErrorKind;
+
+void clear(edacal_error* out) {
+    if (out) {
+        out->kind = EDACAL_OK;
+        out->column = 0;
+        out->length = 0;
+        out->message[0] = '\0';
+    }
+}
+
+void report(edacal_error* out, const Error& error) {
+    if (!out) {
+        return;
+    }
+    out->kind = static_cast<edacal_error_kind>(error.kind);
+    out->column = error.column;
+    out->length = error.length;
+    std::string message = error.message();
+    std::size_t length = std::min(message.size(), sizeof(out->message) - 1);
+    std::memcpy(out->message, message.data(), length);
+    out->message[length] = '\0';
+}
+
+// Lo que no es un Error estructurado (falta de memoria, sobre todo) no debe
+// cruzar la frontera de C.
+edacal_error_kind reportException(edacal_error* out, const std::exception& err) {
+    report(out, Error(ErrorKind::OTHER, 0, 0, err.what()));
+    return EDACAL_ERROR_OTHER;
+}
+
+// Evaluacion completa con Evaluator sobre una copia de la tabla con los
+// valores ligados: sum/prod sin compilar, variables no definidas y errores.
+edacal_error_kind evaluateSlow(const edacal_expr* expr, double* result, edacal_error* error) {
+    edacal::SymbolTable symbols(expr->context->symbols);
+    for (const auto& binding : expr->bindings) {
+        symbols.set(binding.first, *binding.second);
+    }
+    Error failure;
+    if (!expr->vm.evaluate(symbols, *result, failure)) {
+        report(error, failure);
+        return static_cast<edacal_error_kind>(failure.kind);
+    }
+    clear(error);
+    return EDACAL_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+edacal_context* edacal_context_new(void) {
+    try {
+        return new edacal_context();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void edacal_context_free(edacal_context* context) {
+    delete context;
+}
+
+edacal_error_kind edacal_set(edacal_context* context, const char* name, double value) {
+    if (!context || !name) {
+        return EDACAL_ERROR_OTHER;
+    }
+    try {
+        context->symbols.set(name, value);
+        return EDACAL_OK;
+    } catch (const std::exception&) {
+        return EDACAL_ERROR_OTHER;
+    }
+}
+
+int edacal_get(const edacal_context* context, const char* name, double* value) {
+    if (!context || !name || !value) {
+        return 0;
+    }
+    try {
+        return context->symbols.find(name, *value) ? 1 : 0;
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+edacal_expr* edacal_compile(edacal_context* context, const char* text, edacal_error* error) {
+    if (!context || !text) {
+        report(error, Error(ErrorKind::OTHER, 0, 0, "contexto o expresion nulos"));
+        return nullptr;
+    }
+    try {
+        edacal::TokenList tokens;
+        edacal::TokenList postfix;
+        Error failure;
+        if (!context->tokenizer.tokenize(text, tokens, failure) ||
+            !context->parser.toPostfix(tokens, postfix, failure)) {
+            report(error, failure);
+            return nullptr;
+        }
+        edacal_expr* expr = new edacal_expr(context, context->optimizer.optimize(postfix));
+        clear(error);
+        return expr;
+    } catch (const std::exception& err) {
+        reportException(error, err);
+        return nullptr;
+    }
+}
+
+void edacal_expr_free(edacal_expr* expr) {
+    delete expr;
+}
+
+edacal_error_kind edacal_bind(edacal_expr* expr, const char* name, const double* value) {
+    if (!expr || !name) {
+        return EDACAL_ERROR_OTHER;
+    }
+    try {
+        const std::vector<std::string>& variables = expr->vm.variables();
+        for (std::size_t i = 0; i < variables.size(); ++i) {
+            if (variables[i] == name) {
+                expr->bound[i] = value;
+            }
+        }
+        auto& bindings = expr->bindings;
+        auto found = std::find_if(bindings.begin(), bindings.end(),
+                                  [&](const std::pair<std::string, const double*>& b) { return b.first == name; });
+        if (found != bindings.end()) {
+            if (value) {
+                found->second = value;
+            } else {
+                bindings.erase(found);
+            }
+        } else if (value) {
+            bindings.push_back(std::make_pair(std::string(name), value));
+        }
+        return EDACAL_OK;
+    } catch (const std::exception&) {
+        return EDACAL_ERROR_OTHER;
+    }
+}
+
+edacal_error_kind edacal_eval(edacal_expr* expr, double* result, edacal_error* error) {
+    if (!expr || !result) {
+        report(error, Error(ErrorKind::OTHER, 0, 0, "expresion o resultado nulos"));
+        return EDACAL_ERROR_OTHER;
+    }
+    try {
+        // Camino rapido: variables ligadas o definidas y sin errores.
+        if (expr->vm.compiled()) {
+            const std::vector<std::string>& variables = expr->vm.variables();
+            bool resolved = true;
+            for (std::size_t i = 0; i < variables.size() && resolved; ++i) {
+                if (expr->bound[i]) {
+                    expr->values[i] = *expr->bound[i];
+                } else {
+                    resolved = expr->context->symbols.find(variables[i], expr->values[i]);
+                }
+            }
+            if (resolved && expr->vm.evaluate(expr->values.data(), *result)) {
+                clear(error);
+                return EDACAL_OK;
+            }
+        }
+        return evaluateSlow(expr, result, error);
+    } catch (const std::exception& err) {
+        return reportException(error, err);
+    }
+}
+
+} // extern "C"
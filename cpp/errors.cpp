@@ -0,0 +1,47 @@
+#include "errors.hpp"
+
+namespace edacal {
+
+std::string Error::message() const {
+    switch (kind) {
+        case ErrorKind::NONE:
+            return "sin error";
+        case ErrorKind::OTHER:
+            return detail;
+        case ErrorKind::INVALID_NUMBER:
+            return "numero invalido: " + detail;
+        case ErrorKind::UNKNOWN_TOKEN:
+            return "token no reconocido: " + detail;
+        case ErrorKind::EXPECTED_CALL:
+            return "se esperaba '(' despues de '" + detail + "'";
+        case ErrorKind::OPERAND_EXPECTED:
+            return "operando esperado antes del operador '" + detail + "'";
+        case ErrorKind::EMPTY_ARGUMENT:
+            return "argumento vacio en llamada a funcion";
+        case ErrorKind::STRAY_COMMA:
+            return "coma fuera de una llamada a funcion";
+        case ErrorKind::UNBALANCED_PARENS:
+            return "parentesis desbalanceados";
+        case ErrorKind::ARGUMENT_COUNT:
+            return "numero de argumentos invalido para '" + detail + "'";
+        case ErrorKind::UNEXPECTED_ASSIGN:
+            return "asignacion inesperada dentro de la expresion";
+        case ErrorKind::UNEXPECTED_TOKEN:
+            return "token inesperado: " + detail;
+        case ErrorKind::INCOMPLETE_EXPRESSION:
+            return "expresion incompleta";
+        case ErrorKind::MISSING_OPERANDS:
+            return "faltan operandos";
+        case ErrorKind::INVALID_EXPRESSION:
+            return "expresion invalida";
+        case ErrorKind::DIVISION_BY_ZERO:
+            return "division por cero";
+        case ErrorKind::UNDEFINED_VARIABLE:
+            return "variable no definida: " + detail;
+        case ErrorKind::DOMAIN:
+            return detail + " " + (reason ? reason : "fuera de dominio");
+    }
+    return detail;
+}
+
+} // namespace edacal
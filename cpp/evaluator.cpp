@@ -1,95 +1,324 @@
 #include "evaluator.hpp"
 
+#include "numeric.hpp"
+#include "rational.hpp"
+
 #include <cmath>
+#include <vector>
 
 namespace edacal {
 
-double Evaluator::evalPostfix(const LinkedList<Token>& postfix, SymbolTable& symbols) const {
-    Stack<double> values;
+namespace {
 
-    auto popValue = [&]() -> double {
-        if (values.empty()) {
-            throw EdaError("faltan operandos");
-        }
-        double v = values.top();
+bool fail(Error& error, ErrorKind kind, const Token& token, std::string detail = std::string()) {
+    error = Error(kind, token.column, token.lexeme.size(), std::move(detail));
+    return false;
+}
+
+// Dominio declarado por la funcion; solo existe para double.
+bool inDomain(const Function* fn, const double* args) {
+    return !fn->domain || fn->domain(args);
+}
+
+template <typename T>
+bool inDomain(const Function*, const T*) {
+    return true;
+}
+
+// Suma de Neumaier: devuelve a + b y deja en `lost` lo que perdio el
+// redondeo. En Rational la suma es exacta.
+double twoSum(double a, double b, double& lost) {
+    double sum = a + b;
+    lost = std::fabs(a) >= std::fabs(b) ? (a - sum) + b : (b - sum) + a;
+    return sum;
+}
+
+template <typename T>
+T twoSum(const T& a, const T& b, T& lost) {
+    lost = T();
+    return a + b;
+}
+
+// sum/prod en curso: el cuerpo va de `body` a `after` y se recorre de nuevo
+// mientras `index` no llegue a `last`. La primera vuelta deja su valor tal
+// cual, asi el resultado es el de la expresion expandida f(1) + f(2) + ...
+template <typename T>
+struct Reduction {
+    explicit Reduction(TokenList::ConstIterator start)
+        : body(start), after(start), index(0), last(0), product(false), started(false), current(), accumulated() {}
+
+    TokenList::ConstIterator body;
+    TokenList::ConstIterator after;
+    long index;
+    long last;
+    bool product;
+    bool started;
+    T current;
+    T accumulated;
+};
+
+} // namespace
+
+template <typename T>
+T BasicEvaluator<T>::evalPostfix(const TokenList& postfix, const BasicSymbolTable<T>& symbols) const {
+    T result;
+    Error error;
+    if (!evalPostfix(postfix, symbols, result, error)) {
+        throw EdaError(error);
+    }
+    return result;
+}
+
+template <typename T>
+bool BasicEvaluator<T>::evalPostfix(const TokenList& postfix, const BasicSymbolTable<T>& symbols, T& result,
+                                    Error& error) const {
+    typedef NumericTraits<T> Traits;
+    Stack<T> values;
+    // Error acumulado de cada cadena compensada abierta (ver SumMark).
+    Stack<T> compensation;
+    std::vector<Reduction<T>> loops;
+    // Vueltas que quedan de kMaxIterations.
+    unsigned long iterations = kMaxIterations;
+
+    auto popValue = [&]() -> T {
+        T v = values.top();
         values.pop();
         return v;
     };
 
-    for (auto it = postfix.begin(); it != postfix.end(); ++it) {
+    for (auto it = postfix.begin(); it != postfix.end();) {
+        if (!loops.empty() && it == loops.back().after) {
+            Reduction<T>& loop = loops.back();
+            if (values.empty()) {
+                error = Error(ErrorKind::INVALID_EXPRESSION, 0, 0);
+                return false;
+            }
+            T value = popValue();
+            if (!loop.started) {
+                loop.accumulated = value;
+                loop.started = true;
+            } else if (loop.product) {
+                loop.accumulated = loop.accumulated * value;
+            } else {
+                loop.accumulated = loop.accumulated + value;
+            }
+            if (loop.index < loop.last) {
+                ++loop.index;
+                loop.current = Traits::fromDouble(static_cast<double>(loop.index));
+                it = loop.body;
+            } else {
+                values.push(loop.accumulated);
+                loops.pop_back();
+            }
+            continue;
+        }
+
         const Token& token = *it;
+        ++it;
         if (token.type == TokenType::END) {
             break;
         }
 
+        std::size_t operands = 0;
         switch (token.type) {
-            case TokenType::NUMBER:
-                values.push(token.value);
-                break;
-            case TokenType::ANS:
-                values.push(symbols.get("ans"));
-                break;
-            case TokenType::IDENT:
-                values.push(symbols.get(token.lexeme));
-                break;
-            case TokenType::UNARY_MINUS: {
-                double operand = popValue();
-                values.push(-operand);
+            case TokenType::UNARY_MINUS:
+            case TokenType::POWI:
+                operands = 1;
                 break;
-            }
-            case TokenType::SQRT: {
-                double operand = popValue();
-                if (operand < 0.0) {
-                    throw EdaError("sqrt con argumento negativo");
-                }
-                values.push(std::sqrt(operand));
+            case TokenType::PLUS:
+            case TokenType::MINUS:
+            case TokenType::MUL:
+            case TokenType::DIV:
+            case TokenType::POW:
+            case TokenType::SUM:
+            case TokenType::PROD:
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL:
+                operands = 2;
                 break;
-            }
-            case TokenType::PLUS: {
-                double right = popValue();
-                double left = popValue();
-                values.push(left + right);
+            case TokenType::SELECT:
+                operands = 3;
                 break;
-            }
-            case TokenType::MINUS: {
-                double right = popValue();
-                double left = popValue();
-                values.push(left - right);
+            case TokenType::FUNCTION:
+                operands = token.function->arity;
                 break;
-            }
-            case TokenType::MUL: {
-                double right = popValue();
-                double left = popValue();
-                values.push(left * right);
+            default:
                 break;
-            }
-            case TokenType::DIV: {
-                double right = popValue();
-                if (right == 0.0) {
-                    throw EdaError("division por cero");
+        }
+        if (values.size() < operands) {
+            return fail(error, ErrorKind::MISSING_OPERANDS, token);
+        }
+
+        try {
+            switch (token.type) {
+                case TokenType::NUMBER:
+                    values.push(Traits::fromLiteral(token));
+                    break;
+                case TokenType::ANS:
+                case TokenType::IDENT: {
+                    static const std::string kAns("ans");
+                    const std::string& name = token.type == TokenType::ANS ? kAns : token.lexeme;
+                    T value;
+                    if (!symbols.find(name, value)) {
+                        return fail(error, ErrorKind::UNDEFINED_VARIABLE, token, name);
+                    }
+                    values.push(value);
+                    break;
                 }
-                double left = popValue();
-                values.push(left / right);
-                break;
-            }
-            case TokenType::POW: {
-                double right = popValue();
-                double left = popValue();
-                values.push(std::pow(left, right));
-                break;
+                case TokenType::INDEX: {
+                    std::size_t depth = static_cast<std::size_t>(token.value);
+                    if (depth >= loops.size()) {
+                        return fail(error, ErrorKind::OTHER, token, "indice fuera de su bucle: " + token.lexeme);
+                    }
+                    values.push(loops[depth].current);
+                    break;
+                }
+                case TokenType::SUM:
+                case TokenType::PROD: {
+                    T last = popValue();
+                    T first = popValue();
+                    Reduction<T> loop(it);
+                    if (!Traits::toIndex(first, loop.index) || !Traits::toIndex(last, loop.last)) {
+                        error = Error(ErrorKind::DOMAIN, token.column, token.lexeme.size(), token.lexeme,
+                                      "requiere limites enteros");
+                        return false;
+                    }
+                    for (std::size_t i = static_cast<std::size_t>(token.value); i > 0 && loop.after != postfix.end();
+                         --i) {
+                        ++loop.after;
+                    }
+                    loop.product = token.type == TokenType::PROD;
+                    if (loop.index > loop.last) {
+                        values.push(Traits::fromDouble(loop.product ? 1.0 : 0.0));
+                        it = loop.after;
+                        break;
+                    }
+                    unsigned long count =
+                        static_cast<unsigned long>(loop.last) - static_cast<unsigned long>(loop.index) + 1;
+                    if (count > iterations) {
+                        error = Error(ErrorKind::DOMAIN, token.column, token.lexeme.size(), token.lexeme,
+                                      "excede el maximo de 10000000 iteraciones");
+                        return false;
+                    }
+                    iterations -= count;
+                    loop.current = Traits::fromDouble(static_cast<double>(loop.index));
+                    loops.push_back(loop);
+                    break;
+                }
+                case TokenType::UNARY_MINUS: {
+                    T operand = popValue();
+                    values.push(-operand);
+                    break;
+                }
+                case TokenType::FUNCTION: {
+                    const Function* fn = token.function;
+                    T args[Function::kMaxArity];
+                    for (std::size_t i = fn->arity; i > 0; --i) {
+                        args[i - 1] = popValue();
+                    }
+                    if (!inDomain(fn, args)) {
+                        error = Error(ErrorKind::DOMAIN, token.column, token.lexeme.size(), fn->name, fn->domainError);
+                        return false;
+                    }
+                    values.push(Traits::call(fn, args));
+                    break;
+                }
+                case TokenType::PLUS: {
+                    T right = popValue();
+                    T left = popValue();
+                    SumMark mark = sumMark(token);
+                    if (mark == SumMark::NONE) {
+                        values.push(left + right);
+                        break;
+                    }
+                    T lost;
+                    T sum = twoSum(left, right, lost);
+                    if (mark == SumMark::OPEN) {
+                        compensation.push(lost);
+                    } else if (!compensation.empty()) {
+                        compensation.top() = compensation.top() + lost;
+                        if (mark == SumMark::CLOSE) {
+                            sum = sum + compensation.top();
+                            compensation.pop();
+                        }
+                    }
+                    values.push(sum);
+                    break;
+                }
+                case TokenType::MINUS: {
+                    T right = popValue();
+                    T left = popValue();
+                    values.push(left - right);
+                    break;
+                }
+                case TokenType::MUL: {
+                    T right = popValue();
+                    T left = popValue();
+                    values.push(left * right);
+                    break;
+                }
+                case TokenType::DIV: {
+                    T right = popValue();
+                    if (Traits::isZero(right)) {
+                        return fail(error, ErrorKind::DIVISION_BY_ZERO, token);
+                    }
+                    T left = popValue();
+                    values.push(left / right);
+                    break;
+                }
+                case TokenType::POW: {
+                    T right = popValue();
+                    T left = popValue();
+                    values.push(Traits::pow(left, right));
+                    break;
+                }
+                case TokenType::POWI: {
+                    T operand = popValue();
+                    values.push(Traits::powi(operand, static_cast<long>(token.value)));
+                    break;
+                }
+                case TokenType::LESS:
+                case TokenType::LESS_EQUAL:
+                case TokenType::GREATER:
+                case TokenType::GREATER_EQUAL:
+                case TokenType::EQUAL: {
+                    T right = popValue();
+                    T left = popValue();
+                    values.push(Traits::fromDouble(compareValues(token.type, left, right) ? 1.0 : 0.0));
+                    break;
+                }
+                case TokenType::SELECT: {
+                    T otherwise = popValue();
+                    T then = popValue();
+                    T condition = popValue();
+                    values.push(Traits::isZero(condition) ? otherwise : then);
+                    break;
+                }
+                default:
+                    return fail(error, ErrorKind::OTHER, token, "token inesperado en evaluacion: " + token.lexeme);
             }
-            default:
-                throw EdaError("token inesperado en evaluacion: " + token.lexeme);
+        } catch (const EdaError& err) {
+            error = err.error();
+            error.column = token.column;
+            error.length = token.lexeme.size();
+            return false;
         }
     }
 
-    if (values.size() != 1) {
-        throw EdaError("expresion invalida");
+    if (values.size() != 1 || !loops.empty()) {
+        error = Error(ErrorKind::INVALID_EXPRESSION, 0, 0);
+        return false;
     }
 
-    double result = values.top();
+    result = values.top();
     values.pop();
-    return result;
+    return true;
 }
 
+template class BasicEvaluator<double>;
+template class BasicEvaluator<Rational>;
+
 } // namespace edacal
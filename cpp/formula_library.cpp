@@ -0,0 +1,432 @@
+#include "formula_library.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace edacal {
+
+namespace {
+
+// Formato (endianness y alineacion nativas):
+//   Header                          64 bytes
+//   SymbolRecord[symbolCount]       nombre y valor de cada variable
+//   MappedFormula[formulaCount]     ordenadas por nombre para busqueda binaria
+//   FlatToken[tokenCount]           posfija de todas las formulas y de la ultima
+//   char[textSize]                  nombres y lexemas
+// El checksum cubre todo lo que sigue al encabezado.
+const char kMagic[8] = {'E', 'D', 'A', 'C', 'A', 'L', 'S', 'N'};
+const std::uint32_t kHasLast = 1;
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t payloadSize;
+    std::uint64_t checksum;
+    std::uint32_t symbolCount;
+    std::uint32_t formulaCount;
+    std::uint32_t tokenCount;
+    std::uint32_t lastFirst;
+    std::uint32_t lastCount;
+    std::uint32_t flags;
+    std::uint64_t textSize;
+};
+
+struct SymbolRecord {
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+    double value;
+};
+
+// FNV-1a aplicado a palabras de 8 bytes (y byte a byte en la cola).
+std::uint64_t checksum(const char* data, std::size_t size) {
+    const std::uint64_t prime = 1099511628211ULL;
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
+
+std::uint32_t appendText(std::string& text, const char* value, std::size_t length) {
+    std::uint32_t offset = static_cast<std::uint32_t>(text.size());
+    text.append(value, length);
+    return offset;
+}
+
+std::uint32_t appendText(std::string& text, const std::string& value) {
+    return appendText(text, value.data(), value.size());
+}
+
+template <typename T>
+void appendRecords(std::string& payload, const std::vector<T>& records) {
+    if (!records.empty()) {
+        payload.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(T));
+    }
+}
+
+} // namespace
+
+FormulaLibrary::FormulaLibrary() : FormulaLibrary(FunctionRegistry::builtins()) {}
+
+FormulaLibrary::FormulaLibrary(const FunctionRegistry& functions)
+    : functions_(&functions),
+      hasLast_(false),
+      mapping_(nullptr),
+      mappingSize_(0),
+      mappedFormulas_(nullptr),
+      mappedCount_(0),
+      mappedTokens_(nullptr),
+      mappedText_(nullptr),
+      mappedTextSize_(0) {}
+
+FormulaLibrary::~FormulaLibrary() {
+    unmap();
+}
+
+void FormulaLibrary::define(const std::string& name, const TokenList& postfix) {
+    defined_[name] = encode(postfix);
+}
+
+bool FormulaLibrary::has(const std::string& name) const {
+    return defined_.find(name) != defined_.end() || findMapped(name) != nullptr;
+}
+
+TokenList FormulaLibrary::get(const std::string& name) const {
+    auto it = defined_.find(name);
+    if (it != defined_.end()) {
+        return decode(it->second.tokens.data(), it->second.tokens.size(), it->second.text.data(),
+                      it->second.text.size());
+    }
+    const MappedFormula* mapped = findMapped(name);
+    if (!mapped) {
+        throw EdaError("formula no definida: " + name);
+    }
+    return decode(mappedTokens_ + mapped->firstToken, mapped->tokenCount, mappedText_, mappedTextSize_);
+}
+
+std::size_t FormulaLibrary::size() const {
+    std::size_t count = defined_.size();
+    for (std::size_t i = 0; i < mappedCount_; ++i) {
+        if (defined_.find(mappedName(mappedFormulas_[i])) == defined_.end()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void FormulaLibrary::setLast(const TokenList& postfix) {
+    last_ = encode(postfix);
+    hasLast_ = true;
+}
+
+bool FormulaLibrary::hasLast() const {
+    return hasLast_;
+}
+
+TokenList FormulaLibrary::last() const {
+    if (!hasLast_) {
+        throw EdaError("no hay expresion evaluada");
+    }
+    return decode(last_.tokens.data(), last_.tokens.size(), last_.text.data(), last_.text.size());
+}
+
+void FormulaLibrary::save(const std::string& path, const SymbolTable& symbols) const {
+    std::string text;
+    std::vector<SymbolRecord> symbolRecords;
+    symbolRecords.reserve(symbols.size());
+    for (auto it = symbols.begin(); it != symbols.end(); ++it) {
+        SymbolRecord record;
+        record.nameLength = static_cast<std::uint32_t>(it->first.size());
+        record.nameOffset = appendText(text, it->first);
+        record.value = it->second;
+        symbolRecords.push_back(record);
+    }
+
+    std::vector<std::string> names;
+    names.reserve(defined_.size() + mappedCount_);
+    for (auto it = defined_.begin(); it != defined_.end(); ++it) {
+        names.push_back(it->first);
+    }
+    for (std::size_t i = 0; i < mappedCount_; ++i) {
+        std::string name = mappedName(mappedFormulas_[i]);
+        if (defined_.find(name) == defined_.end()) {
+            names.push_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end());
+
+    std::vector<MappedFormula> formulaRecords;
+    std::vector<FlatToken> tokens;
+    formulaRecords.reserve(names.size());
+
+    auto appendCode = [&](const FlatToken* source, std::size_t count, const char* sourceText) {
+        for (std::size_t i = 0; i < count; ++i) {
+            FlatToken token = source[i];
+            token.textOffset = appendText(text, sourceText + source[i].textOffset, source[i].textLength);
+            tokens.push_back(token);
+        }
+    };
+
+    for (const std::string& name : names) {
+        MappedFormula record;
+        record.nameLength = static_cast<std::uint32_t>(name.size());
+        record.nameOffset = appendText(text, name);
+        record.firstToken = static_cast<std::uint32_t>(tokens.size());
+        auto ownedIt = defined_.find(name);
+        if (ownedIt != defined_.end()) {
+            appendCode(ownedIt->second.tokens.data(), ownedIt->second.tokens.size(), ownedIt->second.text.data());
+        } else {
+            const MappedFormula* mapped = findMapped(name);
+            appendCode(mappedTokens_ + mapped->firstToken, mapped->tokenCount, mappedText_);
+        }
+        record.tokenCount = static_cast<std::uint32_t>(tokens.size()) - record.firstToken;
+        formulaRecords.push_back(record);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kSnapshotVersion;
+    header.headerSize = sizeof(Header);
+    header.symbolCount = static_cast<std::uint32_t>(symbolRecords.size());
+    header.formulaCount = static_cast<std::uint32_t>(formulaRecords.size());
+    header.lastFirst = static_cast<std::uint32_t>(tokens.size());
+    if (hasLast_) {
+        appendCode(last_.tokens.data(), last_.tokens.size(), last_.text.data());
+        header.flags |= kHasLast;
+    }
+    header.lastCount = static_cast<std::uint32_t>(tokens.size()) - header.lastFirst;
+    header.tokenCount = static_cast<std::uint32_t>(tokens.size());
+    header.textSize = text.size();
+
+    std::string payload;
+    appendRecords(payload, symbolRecords);
+    appendRecords(payload, formulaRecords);
+    appendRecords(payload, tokens);
+    payload += text;
+    header.payloadSize = payload.size();
+    header.checksum = checksum(payload.data(), payload.size());
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw EdaError("no se pudo abrir el archivo: " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!out) {
+        throw EdaError("no se pudo escribir el archivo: " + path);
+    }
+}
+
+void FormulaLibrary::load(const std::string& path, SymbolTable& symbols) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw EdaError("no se pudo abrir el archivo: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw EdaError("snapshot invalido: " + path);
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw EdaError("no se pudo mapear el archivo: " + path);
+    }
+
+    const char* base = static_cast<const char*>(mapping);
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    const char* payload = base + sizeof(Header);
+
+    std::uint64_t expected = static_cast<std::uint64_t>(header.symbolCount) * sizeof(SymbolRecord) +
+                             static_cast<std::uint64_t>(header.formulaCount) * sizeof(MappedFormula) +
+                             static_cast<std::uint64_t>(header.tokenCount) * sizeof(FlatToken) + header.textSize;
+    const char* error = nullptr;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.headerSize != sizeof(Header)) {
+        error = "snapshot invalido: ";
+    } else if (header.version != kSnapshotVersion) {
+        error = "version de snapshot no soportada: ";
+    } else if (header.payloadSize != size - sizeof(Header) || expected != header.payloadSize ||
+               static_cast<std::uint64_t>(header.lastFirst) + header.lastCount > header.tokenCount) {
+        error = "snapshot truncado: ";
+    } else if (checksum(payload, header.payloadSize) != header.checksum) {
+        error = "checksum de snapshot invalido: ";
+    }
+    if (error) {
+        ::munmap(mapping, size);
+        throw EdaError(error + path);
+    }
+
+    const SymbolRecord* symbolRecords = reinterpret_cast<const SymbolRecord*>(payload);
+    const MappedFormula* formulas = reinterpret_cast<const MappedFormula*>(symbolRecords + header.symbolCount);
+    const FlatToken* tokens = reinterpret_cast<const FlatToken*>(formulas + header.formulaCount);
+    const char* text = reinterpret_cast<const char*>(tokens + header.tokenCount);
+
+    // Todo se valida y se prepara antes de tocar la biblioteca o la tabla:
+    // un archivo corrupto no deja la sesion a medio cargar.
+    std::vector<std::pair<std::string, double>> values;
+    std::unordered_map<std::string, Code> kept;
+    Code last;
+    try {
+        bool valid = true;
+        for (std::uint32_t i = 0; i < header.formulaCount && valid; ++i) {
+            const MappedFormula& formula = formulas[i];
+            valid = static_cast<std::uint64_t>(formula.nameOffset) + formula.nameLength <= header.textSize &&
+                    static_cast<std::uint64_t>(formula.firstToken) + formula.tokenCount <= header.tokenCount;
+        }
+        for (std::uint32_t i = 0; i < header.symbolCount && valid; ++i) {
+            const SymbolRecord& record = symbolRecords[i];
+            valid = static_cast<std::uint64_t>(record.nameOffset) + record.nameLength <= header.textSize;
+        }
+        if (!valid) {
+            throw EdaError("snapshot invalido: " + path);
+        }
+        last = encode(decode(tokens + header.lastFirst, header.lastCount, text, header.textSize));
+
+        values.reserve(header.symbolCount);
+        for (std::uint32_t i = 0; i < header.symbolCount; ++i) {
+            const SymbolRecord& record = symbolRecords[i];
+            values.push_back(std::make_pair(std::string(text + record.nameOffset, record.nameLength), record.value));
+        }
+
+        // Como con las variables, las formulas del snapshot reemplazan a las
+        // del mismo nombre y las demas (definidas o de un load anterior) se
+        // conservan.
+        for (auto it = defined_.begin(); it != defined_.end(); ++it) {
+            if (!findIn(formulas, header.formulaCount, text, it->first)) {
+                kept.insert(*it);
+            }
+        }
+        for (std::size_t i = 0; i < mappedCount_; ++i) {
+            const MappedFormula& formula = mappedFormulas_[i];
+            std::string name = mappedName(formula);
+            if (!findIn(formulas, header.formulaCount, text, name) && kept.find(name) == kept.end()) {
+                Code& code = kept[name];
+                for (std::uint32_t t = 0; t < formula.tokenCount; ++t) {
+                    FlatToken token = mappedTokens_[formula.firstToken + t];
+                    token.textOffset = appendText(code.text, mappedText_ + token.textOffset, token.textLength);
+                    code.tokens.push_back(token);
+                }
+            }
+        }
+    } catch (...) {
+        ::munmap(mapping, size);
+        throw;
+    }
+
+    unmap();
+    defined_.swap(kept);
+    mapping_ = mapping;
+    mappingSize_ = size;
+    mappedFormulas_ = formulas;
+    mappedCount_ = header.formulaCount;
+    mappedTokens_ = tokens;
+    mappedText_ = text;
+    mappedTextSize_ = header.textSize;
+    for (const auto& value : values) {
+        symbols.set(value.first, value.second);
+    }
+    hasLast_ = (header.flags & kHasLast) != 0;
+    last_ = std::move(last);
+}
+
+FormulaLibrary::Code FormulaLibrary::encode(const TokenList& postfix) {
+    Code code;
+    for (auto it = postfix.begin(); it != postfix.end(); ++it) {
+        if (it->type == TokenType::END) {
+            break;
+        }
+        FlatToken token;
+        token.type = static_cast<std::uint32_t>(it->type);
+        token.textLength = static_cast<std::uint32_t>(it->lexeme.size());
+        token.textOffset = appendText(code.text, it->lexeme);
+        token.reserved = 0;
+        token.value = it->value;
+        code.tokens.push_back(token);
+    }
+    return code;
+}
+
+TokenList FormulaLibrary::decode(const FlatToken* tokens, std::size_t count, const char* text,
+                                         std::size_t textSize) const {
+    TokenList postfix;
+    for (std::size_t i = 0; i < count; ++i) {
+        const FlatToken& flat = tokens[i];
+        if (flat.type > static_cast<std::uint32_t>(TokenType::SELECT) ||
+            static_cast<std::uint64_t>(flat.textOffset) + flat.textLength > textSize) {
+            throw EdaError("token invalido en snapshot");
+        }
+        TokenType type = static_cast<TokenType>(flat.type);
+        std::string lexeme(text + flat.textOffset, flat.textLength);
+        if (type == TokenType::FUNCTION) {
+            const Function* fn = functions_->find(lexeme);
+            if (!fn) {
+                throw EdaError("funcion desconocida en snapshot: " + lexeme);
+            }
+            postfix.push_back(Token(fn, lexeme));
+        } else {
+            postfix.push_back(Token(type, lexeme, flat.value));
+        }
+    }
+    postfix.push_back(Token(TokenType::END, ""));
+    return postfix;
+}
+
+const FormulaLibrary::MappedFormula* FormulaLibrary::findMapped(const std::string& name) const {
+    return findIn(mappedFormulas_, mappedCount_, mappedText_, name);
+}
+
+const FormulaLibrary::MappedFormula* FormulaLibrary::findIn(const MappedFormula* formulas, std::size_t count,
+                                                            const char* text, const std::string& name) {
+    std::size_t lo = 0;
+    std::size_t hi = count;
+    while (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        const MappedFormula& formula = formulas[mid];
+        int cmp = name.compare(0, std::string::npos, text + formula.nameOffset, formula.nameLength);
+        if (cmp == 0) {
+            return &formula;
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+std::string FormulaLibrary::mappedName(const MappedFormula& formula) const {
+    return std::string(mappedText_ + formula.nameOffset, formula.nameLength);
+}
+
+void FormulaLibrary::unmap() {
+    if (mapping_) {
+        ::munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    mappedFormulas_ = nullptr;
+    mappedCount_ = 0;
+    mappedTokens_ = nullptr;
+    mappedText_ = nullptr;
+    mappedTextSize_ = 0;
+}
+
+} // namespace edacal
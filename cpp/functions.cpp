@@ -0,0 +1,109 @@
+#include "functions.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace edacal {
+
+namespace {
+
+bool nonNegative(const double* args) {
+    return !(args[0] < 0.0);
+}
+
+bool positive(const double* args) {
+    return !(args[0] <= 0.0);
+}
+
+double fnSqrt(const double* args) {
+    if (!nonNegative(args)) {
+        throw EdaError("sqrt con argumento negativo");
+    }
+    return std::sqrt(args[0]);
+}
+
+double fnExp(const double* args) {
+    return std::exp(args[0]);
+}
+
+double fnLog(const double* args) {
+    if (!positive(args)) {
+        throw EdaError("log con argumento no positivo");
+    }
+    return std::log(args[0]);
+}
+
+double fnSin(const double* args) {
+    return std::sin(args[0]);
+}
+
+double fnCos(const double* args) {
+    return std::cos(args[0]);
+}
+
+double fnAbs(const double* args) {
+    return std::fabs(args[0]);
+}
+
+double fnMin(const double* args) {
+    return std::min(args[0], args[1]);
+}
+
+double fnMax(const double* args) {
+    return std::max(args[0], args[1]);
+}
+
+double fnHypot(const double* args) {
+    return std::hypot(args[0], args[1]);
+}
+
+FunctionRegistry makeBuiltins() {
+    FunctionRegistry registry;
+    registry.add("sqrt", 1, true, &fnSqrt, &nonNegative, "con argumento negativo");
+    registry.add("exp", 1, true, &fnExp);
+    registry.add("log", 1, true, &fnLog, &positive, "con argumento no positivo");
+    registry.add("sin", 1, true, &fnSin);
+    registry.add("cos", 1, true, &fnCos);
+    registry.add("abs", 1, true, &fnAbs);
+    registry.add("min", 2, true, &fnMin);
+    registry.add("max", 2, true, &fnMax);
+    registry.add("hypot", 2, true, &fnHypot);
+    return registry;
+}
+
+} // namespace
+
+const FunctionRegistry& FunctionRegistry::builtins() {
+    static const FunctionRegistry registry = makeBuiltins();
+    return registry;
+}
+
+void FunctionRegistry::add(const std::string& name, std::size_t arity, bool pure, Function::Impl impl,
+                           Function::Domain domain, const char* domainError) {
+    if (arity == 0 || arity > Function::kMaxArity) {
+        throw EdaError("aridad no soportada para la funcion: " + name);
+    }
+    if (!impl) {
+        throw EdaError("funcion sin implementacion: " + name);
+    }
+    if (name == "ans") {
+        throw EdaError("nombre reservado: " + name);
+    }
+    Function& fn = functions_[name];
+    fn.name = name;
+    fn.arity = arity;
+    fn.pure = pure;
+    fn.impl = impl;
+    fn.domain = domain;
+    fn.domainError = domainError;
+}
+
+const Function* FunctionRegistry::find(const std::string& name) const {
+    auto it = functions_.find(name);
+    if (it == functions_.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+} // namespace edacal
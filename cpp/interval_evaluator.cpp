@@ -0,0 +1,451 @@
+#include "interval_evaluator.hpp"
+
+#include "stack.hpp"
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+namespace edacal {
+
+namespace {
+
+const double kInf = std::numeric_limits<double>::infinity();
+const double kPi = 3.14159265358979323846;
+// Cota de error de libm (glibc) para exp, log, pow, sin, cos e hypot.
+const int kLibmUlps = 2;
+
+double down(double value) {
+    return std::nextafter(value, -kInf);
+}
+
+double up(double value) {
+    return std::nextafter(value, kInf);
+}
+
+// Amplia `ulps` ULP hacia afuera; |x| * ulps * DBL_EPSILON ya es al menos
+// `ulps` ULP de x y el nextafter final cubre el redondeo de la resta. Un
+// extremo infinito (desborde) solo se mueve con nextafter: inf - inf daria NaN.
+Interval widen(double lo, double hi, int ulps) {
+    if (ulps <= 1) {
+        return Interval{down(lo), up(hi)};
+    }
+    double scale = static_cast<double>(ulps) * DBL_EPSILON;
+    double wideLo = std::isinf(lo) ? lo : lo - std::fabs(lo) * scale;
+    double wideHi = std::isinf(hi) ? hi : hi + std::fabs(hi) * scale;
+    return Interval{down(wideLo), up(wideHi)};
+}
+
+// Redondeo dirigido exacto para + - * / sqrt: se calcula en redondeo al mas
+// cercano, el signo del error se obtiene sin perdida (TwoSum, fma) y solo si
+// el resultado quedo del lado equivocado se mueve un ULP. Con desborde o
+// resultados casi subnormales el error no es fiable y se mueve siempre.
+const double kTiny = DBL_MIN * 9007199254740992.0 * 2.0; // 2^-968
+
+double directed(double result, double error, bool reliable, bool upward) {
+    if (!reliable || std::isnan(error)) {
+        return upward ? up(result) : down(result);
+    }
+    if (upward) {
+        return error > 0.0 ? up(result) : result;
+    }
+    return error < 0.0 ? down(result) : result;
+}
+
+double addRounded(double a, double b, bool upward) {
+    double sum = a + b;
+    double bv = sum - a;
+    double error = (a - (sum - bv)) + (b - bv);
+    return directed(sum, error, std::isfinite(sum), upward);
+}
+
+// 0 * inf = 0: en un extremo infinito el 0 es exacto y el producto acotado.
+double mulRounded(double a, double b, bool upward) {
+    if (a == 0.0 || b == 0.0) {
+        return 0.0;
+    }
+    double product = a * b;
+    double error = std::fma(a, b, -product);
+    return directed(product, error, std::isfinite(product) && std::fabs(product) >= kTiny, upward);
+}
+
+double divRounded(double a, double b, bool upward) {
+    if (a == 0.0) {
+        return 0.0;
+    }
+    double quotient = a / b;
+    double remainder = std::fma(-quotient, b, a);
+    double error = b > 0.0 ? remainder : -remainder;
+    bool reliable = std::isfinite(quotient) && std::isfinite(b) && std::fabs(quotient) >= kTiny && std::fabs(a) >= kTiny;
+    return directed(quotient, error, reliable, upward);
+}
+
+double sqrtRounded(double x, bool upward) {
+    if (x == 0.0) {
+        return 0.0;
+    }
+    double root = std::sqrt(x);
+    double error = std::fma(-root, root, x);
+    return directed(root, error, std::isfinite(x) && x >= kTiny, upward);
+}
+
+// Un extremo infinito puede ser un inf de verdad (0^-1, exp(1000)) y entonces
+// 0 * inf, inf / inf o sin(inf) dan NaN en Evaluator. Esos casos devuelven la
+// recta completa: min, max y las comparaciones no la pueden acotar, que es
+// lo correcto porque con NaN descartan el argumento o no se cumplen.
+const Interval kAnything = {-kInf, kInf};
+
+bool unbounded(const Interval& a) {
+    return std::isinf(a.lo) || std::isinf(a.hi);
+}
+
+Interval add(const Interval& a, const Interval& b) {
+    return Interval{addRounded(a.lo, b.lo, false), addRounded(a.hi, b.hi, true)};
+}
+
+Interval sub(const Interval& a, const Interval& b) {
+    return Interval{addRounded(a.lo, -b.hi, false), addRounded(a.hi, -b.lo, true)};
+}
+
+Interval mul(const Interval& a, const Interval& b) {
+    if ((a.contains(0.0) && unbounded(b)) || (b.contains(0.0) && unbounded(a))) {
+        return kAnything;
+    }
+    double lo = std::min(std::min(mulRounded(a.lo, b.lo, false), mulRounded(a.lo, b.hi, false)),
+                         std::min(mulRounded(a.hi, b.lo, false), mulRounded(a.hi, b.hi, false)));
+    double hi = std::max(std::max(mulRounded(a.lo, b.lo, true), mulRounded(a.lo, b.hi, true)),
+                         std::max(mulRounded(a.hi, b.lo, true), mulRounded(a.hi, b.hi, true)));
+    return Interval{lo, hi};
+}
+
+// Un divisor que contiene el cero pero no es exactamente cero da un
+// resultado no acotado (semirrecta o recta completa), igual que el limite.
+Interval div(const Interval& a, const Interval& b) {
+    if (b.lo == 0.0 && b.hi == 0.0) {
+        throw EdaError("division por cero");
+    }
+    if (b.lo > 0.0 || b.hi < 0.0) {
+        if (unbounded(a) && unbounded(b)) {
+            return kAnything;
+        }
+        double lo = std::min(std::min(divRounded(a.lo, b.lo, false), divRounded(a.lo, b.hi, false)),
+                             std::min(divRounded(a.hi, b.lo, false), divRounded(a.hi, b.hi, false)));
+        double hi = std::max(std::max(divRounded(a.lo, b.lo, true), divRounded(a.lo, b.hi, true)),
+                             std::max(divRounded(a.hi, b.lo, true), divRounded(a.hi, b.hi, true)));
+        return Interval{lo, hi};
+    }
+    if (b.lo < 0.0 && b.hi > 0.0) {
+        return Interval{-kInf, kInf};
+    }
+    Interval reciprocal = b.lo == 0.0 ? Interval{divRounded(1.0, b.hi, false), kInf}
+                                      : Interval{-kInf, divRounded(1.0, b.lo, true)};
+    return mul(a, reciprocal);
+}
+
+Interval powi(const Interval& base, long exponent) {
+    if (exponent == 0) {
+        return Interval::point(1.0);
+    }
+    long magnitude = exponent < 0 ? -exponent : exponent;
+    int ulps = static_cast<int>(magnitude) + 1;
+    Interval result;
+    if (magnitude % 2 == 1 || base.lo >= 0.0) {
+        result = widen(vecmath::powi(base.lo, magnitude), vecmath::powi(base.hi, magnitude), ulps);
+    } else if (base.hi <= 0.0) {
+        result = widen(vecmath::powi(base.hi, magnitude), vecmath::powi(base.lo, magnitude), ulps);
+    } else {
+        double largest = std::max(-base.lo, base.hi);
+        result = Interval{0.0, widen(0.0, vecmath::powi(largest, magnitude), ulps).hi};
+    }
+    if (magnitude % 2 == 0) {
+        result.lo = std::max(result.lo, 0.0);
+    }
+    return exponent < 0 ? div(Interval::point(1.0), result) : result;
+}
+
+// x^y es monotona en cada argumento para x >= 0, asi que basta con las esquinas.
+Interval pow(const Interval& base, const Interval& exponent) {
+    if (exponent.lo == exponent.hi && std::fabs(exponent.lo) <= vecmath::kMaxIntegerExponent &&
+        exponent.lo == std::floor(exponent.lo)) {
+        return powi(base, static_cast<long>(exponent.lo));
+    }
+    if (base.lo == base.hi && exponent.lo == exponent.hi) {
+        double value = std::pow(base.lo, exponent.lo);
+        if (std::isnan(value)) {
+            return Interval{value, value};
+        }
+        return widen(value, value, kLibmUlps);
+    }
+    if (base.lo < 0.0) {
+        throw EdaError("potencia no entera de un intervalo con negativos");
+    }
+    double c1 = std::pow(base.lo, exponent.lo);
+    double c2 = std::pow(base.lo, exponent.hi);
+    double c3 = std::pow(base.hi, exponent.lo);
+    double c4 = std::pow(base.hi, exponent.hi);
+    Interval result = widen(std::min(std::min(c1, c2), std::min(c3, c4)),
+                            std::max(std::max(c1, c2), std::max(c3, c4)), kLibmUlps);
+    result.lo = std::max(result.lo, 0.0);
+    return result;
+}
+
+Interval sqrt(const Interval& a) {
+    if (a.hi < 0.0) {
+        throw EdaError("sqrt con argumento negativo");
+    }
+    return Interval{sqrtRounded(std::max(a.lo, 0.0), false), sqrtRounded(a.hi, true)};
+}
+
+Interval exp(const Interval& a) {
+    Interval result = widen(std::exp(a.lo), std::exp(a.hi), kLibmUlps);
+    result.lo = std::max(result.lo, 0.0);
+    return result;
+}
+
+Interval log(const Interval& a) {
+    if (a.hi <= 0.0) {
+        throw EdaError("log con argumento no positivo");
+    }
+    double lo = a.lo > 0.0 ? std::log(a.lo) : -kInf;
+    return widen(lo, std::log(a.hi), kLibmUlps);
+}
+
+Interval abs(const Interval& a) {
+    if (a.lo >= 0.0) {
+        return a;
+    }
+    if (a.hi <= 0.0) {
+        return Interval{-a.hi, -a.lo};
+    }
+    return Interval{0.0, std::max(-a.lo, a.hi)};
+}
+
+// sin sobre [lo, hi]: los extremos mas los maximos (pi/2 + 2k pi) y minimos
+// (-pi/2 + 2k pi) que caigan dentro. La comprobacion se hace con un margen,
+// asi que ante la duda se incluye el extremo (sigue siendo una cota valida).
+bool containsPeak(const Interval& a, double phase) {
+    const double period = 2.0 * kPi;
+    double slack = 4.0 * DBL_EPSILON * std::max(std::fabs(a.lo), std::fabs(a.hi)) + DBL_MIN;
+    double k = std::ceil((a.lo - slack - phase) / period);
+    return phase + k * period <= a.hi + slack;
+}
+
+Interval periodic(const Interval& a, double (*fn)(double), double maxPhase, double minPhase) {
+    if (unbounded(a)) {
+        return kAnything;
+    }
+    if (!(a.hi - a.lo < 2.0 * kPi)) {
+        return Interval{-1.0, 1.0};
+    }
+    double v1 = fn(a.lo);
+    double v2 = fn(a.hi);
+    Interval result = widen(std::min(v1, v2), std::max(v1, v2), kLibmUlps);
+    if (containsPeak(a, maxPhase)) {
+        result.hi = 1.0;
+    }
+    if (containsPeak(a, minPhase)) {
+        result.lo = -1.0;
+    }
+    result.lo = std::max(result.lo, -1.0);
+    result.hi = std::min(result.hi, 1.0);
+    return result;
+}
+
+// Comparacion de intervalos: [1, 1] si se cumple para cualquier par de
+// valores, [0, 0] si no se cumple para ninguno y [0, 1] si depende.
+Interval truth(bool always, bool never) {
+    return always ? Interval::point(1.0) : never ? Interval::point(0.0) : Interval{0.0, 1.0};
+}
+
+Interval less(const Interval& a, const Interval& b) {
+    return truth(a.hi < b.lo, a.lo >= b.hi);
+}
+
+Interval lessEqual(const Interval& a, const Interval& b) {
+    return truth(a.hi <= b.lo, a.lo > b.hi);
+}
+
+Interval compare(TokenType type, const Interval& a, const Interval& b) {
+    switch (type) {
+        case TokenType::LESS:
+            return less(a, b);
+        case TokenType::LESS_EQUAL:
+            return lessEqual(a, b);
+        case TokenType::GREATER:
+            return less(b, a);
+        case TokenType::GREATER_EQUAL:
+            return lessEqual(b, a);
+        default:
+            return truth(a.lo == a.hi && b.lo == b.hi && a.lo == b.lo, a.hi < b.lo || b.hi < a.lo);
+    }
+}
+
+// La rama que corresponda, o las dos si la condicion puede ser 0 y no 0.
+Interval select(const Interval& condition, const Interval& then, const Interval& otherwise) {
+    if (condition.lo > 0.0 || condition.hi < 0.0) {
+        return then;
+    }
+    if (condition.lo == 0.0 && condition.hi == 0.0) {
+        return otherwise;
+    }
+    return Interval{std::min(then.lo, otherwise.lo), std::max(then.hi, otherwise.hi)};
+}
+
+double sinOf(double x) { return std::sin(x); }
+double cosOf(double x) { return std::cos(x); }
+
+} // namespace
+
+Interval IntervalEvaluator::applyFunction(const Function* fn, const Interval* args) const {
+    const std::string& name = fn->name;
+    if (fn != FunctionRegistry::builtins().find(name)) {
+        throw EdaError("funcion sin version de intervalos: " + name);
+    }
+    if (name == "sqrt") {
+        return sqrt(args[0]);
+    } else if (name == "exp") {
+        return exp(args[0]);
+    } else if (name == "log") {
+        return log(args[0]);
+    } else if (name == "abs") {
+        return abs(args[0]);
+    } else if (name == "sin") {
+        return periodic(args[0], sinOf, 0.5 * kPi, -0.5 * kPi);
+    } else if (name == "cos") {
+        return periodic(args[0], cosOf, 0.0, kPi);
+    } else if (name == "min") {
+        return Interval{std::min(args[0].lo, args[1].lo), std::min(args[0].hi, args[1].hi)};
+    } else if (name == "max") {
+        return Interval{std::max(args[0].lo, args[1].lo), std::max(args[0].hi, args[1].hi)};
+    } else if (name == "hypot") {
+        Interval x = abs(args[0]);
+        Interval y = abs(args[1]);
+        Interval result = widen(std::hypot(x.lo, y.lo), std::hypot(x.hi, y.hi), kLibmUlps);
+        result.lo = std::max(result.lo, 0.0);
+        return result;
+    }
+    throw EdaError("funcion sin version de intervalos: " + name);
+}
+
+Interval IntervalEvaluator::evalPostfix(const TokenList& postfix, SymbolTable& symbols,
+                                        const Inputs& inputs) const {
+    Stack<Interval> values;
+
+    auto popValue = [&]() -> Interval {
+        if (values.empty()) {
+            throw EdaError("faltan operandos");
+        }
+        Interval v = values.top();
+        values.pop();
+        return v;
+    };
+
+    for (auto it = postfix.begin(); it != postfix.end(); ++it) {
+        const Token& token = *it;
+        if (token.type == TokenType::END) {
+            break;
+        }
+
+        switch (token.type) {
+            case TokenType::NUMBER:
+                values.push(Interval::point(token.value));
+                break;
+            case TokenType::ANS:
+            case TokenType::IDENT: {
+                static const std::string kAns("ans");
+                const std::string& name = token.type == TokenType::ANS ? kAns : token.lexeme;
+                auto input = inputs.find(name);
+                values.push(input != inputs.end() ? input->second : Interval::point(symbols.get(name)));
+                break;
+            }
+            case TokenType::UNARY_MINUS: {
+                Interval operand = popValue();
+                values.push(Interval{-operand.hi, -operand.lo});
+                break;
+            }
+            case TokenType::FUNCTION: {
+                const Function* fn = token.function;
+                Interval args[Function::kMaxArity];
+                for (std::size_t i = fn->arity; i > 0; --i) {
+                    args[i - 1] = popValue();
+                }
+                values.push(applyFunction(fn, args));
+                break;
+            }
+            case TokenType::PLUS: {
+                Interval right = popValue();
+                Interval left = popValue();
+                values.push(add(left, right));
+                break;
+            }
+            case TokenType::MINUS: {
+                Interval right = popValue();
+                Interval left = popValue();
+                values.push(sub(left, right));
+                break;
+            }
+            case TokenType::MUL: {
+                Interval right = popValue();
+                Interval left = popValue();
+                values.push(mul(left, right));
+                break;
+            }
+            case TokenType::DIV: {
+                Interval right = popValue();
+                Interval left = popValue();
+                values.push(div(left, right));
+                break;
+            }
+            case TokenType::POW: {
+                Interval right = popValue();
+                Interval left = popValue();
+                values.push(pow(left, right));
+                break;
+            }
+            case TokenType::POWI: {
+                Interval operand = popValue();
+                values.push(powi(operand, static_cast<long>(token.value)));
+                break;
+            }
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL: {
+                Interval right = popValue();
+                Interval left = popValue();
+                values.push(compare(token.type, left, right));
+                break;
+            }
+            case TokenType::SELECT: {
+                Interval otherwise = popValue();
+                Interval then = popValue();
+                Interval condition = popValue();
+                values.push(select(condition, then, otherwise));
+                break;
+            }
+            default:
+                throw EdaError("token inesperado en evaluacion: " + token.lexeme);
+        }
+
+        // Un extremo NaN (inf - inf, potencia no entera de un negativo) no
+        // acota nada, y ni la recta completa sirve: min/max de Evaluator
+        // pueden descartar el NaN y devolver el otro argumento.
+        const Interval& top = values.top();
+        if (std::isnan(top.lo) || std::isnan(top.hi)) {
+            throw EdaError("resultado indefinido en el intervalo");
+        }
+    }
+
+    if (values.size() != 1) {
+        throw EdaError("expresion invalida");
+    }
+
+    Interval result = values.top();
+    values.pop();
+    return result;
+}
+
+} // namespace edacal
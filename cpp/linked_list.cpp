@@ -2,13 +2,15 @@
 #include "token.hpp"
 #include "tree.hpp"
 
+#include <cstddef>
 #include <string>
 
 namespace edacal {
 
-template class LinkedList<Token>;
 template class LinkedList<Tree::Node*>;
 template class LinkedList<std::string>;
 template class LinkedList<double>;
+template class LinkedList<bool>;
+template class LinkedList<std::size_t>;
 
 } // namespace edacal
@@ -0,0 +1,285 @@
+#include "memo_evaluator.hpp"
+
+#include "evaluator.hpp"
+#include "functions.hpp"
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace edacal {
+
+namespace {
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// Posicion del bit encendido mas bajo; `bits` no es 0.
+unsigned lowestBit(std::uint64_t bits) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+    unsigned position = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        ++position;
+    }
+    return position;
+#endif
+}
+
+} // namespace
+
+double MemoEvaluator::Stats::hitRate() const {
+    std::size_t total = reused + recomputed;
+    return total ? static_cast<double>(reused) / static_cast<double>(total) : 0.0;
+}
+
+MemoEvaluator::MemoEvaluator(const Tree& tree)
+    : dirtyCount_(0), incremental_(true) {
+    resetStats();
+    const Tree::Node* root = tree.getRoot();
+    if (!root) {
+        incremental_ = false;
+        postfix_.push_back(Token(TokenType::END, ""));
+        return;
+    }
+
+    // Postorden iterativo. Con los tamanos de cada subarbol ya volcado, el
+    // hijo derecho es el nodo anterior y el izquierdo el anterior a todo el
+    // subarbol derecho. El mismo recorrido arma postfix_ (sin los BRANCHES,
+    // que solo existen en el arbol).
+    struct Frame {
+        const Tree::Node* node;
+        bool expanded;
+    };
+    std::vector<Frame> frames(1, Frame{root, false});
+    std::vector<std::uint32_t> sizes;
+    std::unordered_map<std::string, std::uint32_t> names;
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+        frames.pop_back();
+        const Tree::Node* source = frame.node;
+        if (!frame.expanded && (source->left || source->right)) {
+            frames.push_back(Frame{source, true});
+            if (source->right) {
+                frames.push_back(Frame{source->right, false});
+            }
+            if (source->left) {
+                frames.push_back(Frame{source->left, false});
+            }
+            continue;
+        }
+
+        std::uint32_t index = static_cast<std::uint32_t>(nodes_.size());
+        const Token& token = source->token;
+        Node node = {token.type, kNone, kNone, kNone, kNone, token.value, token.function};
+        std::uint32_t size = 1;
+        if (source->right) {
+            node.right = index - 1;
+            size += sizes[node.right];
+            if (source->left) {
+                node.left = node.right - sizes[node.right];
+                size += sizes[node.left];
+            }
+        } else if (source->left) {
+            node.left = index - 1;
+            size += sizes[node.left];
+        }
+
+        if (token.type == TokenType::IDENT || token.type == TokenType::ANS) {
+            static const std::string kAns("ans");
+            const std::string& name = token.type == TokenType::ANS ? kAns : token.lexeme;
+            auto found = names.find(name);
+            if (found == names.end()) {
+                found = names.insert(std::make_pair(name, static_cast<std::uint32_t>(variables_.size()))).first;
+                variables_.push_back(Variable{name, std::vector<std::uint32_t>(), 0, 0.0, false});
+            }
+            node.variable = found->second;
+            variables_[node.variable].leaves.push_back(index);
+        } else if (token.type == TokenType::FUNCTION && !token.function->pure) {
+            impure_.push_back(index);
+        } else if (sumMark(token) != SumMark::NONE) {
+            incremental_ = false;
+        }
+
+        nodes_.push_back(node);
+        sizes.push_back(size);
+        if (token.type != TokenType::BRANCHES) {
+            postfix_.push_back(token);
+        }
+    }
+    postfix_.push_back(Token(TokenType::END, ""));
+    values_.assign(nodes_.size(), 0.0);
+    // Al principio hay que calcular todo.
+    dirty_.assign((nodes_.size() + 63) / 64, ~std::uint64_t(0));
+    if (nodes_.size() % 64) {
+        dirty_.back() = (std::uint64_t(1) << (nodes_.size() % 64)) - 1;
+    }
+    dirtyCount_ = nodes_.size();
+    for (std::uint32_t i = 0; i < nodes_.size(); ++i) {
+        if (nodes_[i].left != kNone) {
+            nodes_[nodes_[i].left].parent = i;
+        }
+        if (nodes_[i].right != kNone) {
+            nodes_[nodes_[i].right].parent = i;
+        }
+    }
+}
+
+void MemoEvaluator::resetStats() {
+    stats_ = Stats{0, 0, 0};
+}
+
+double MemoEvaluator::evaluate(const SymbolTable& symbols) {
+    double result;
+    Error error;
+    if (!evaluate(symbols, result, error)) {
+        throw EdaError(error);
+    }
+    return result;
+}
+
+bool MemoEvaluator::evaluate(const SymbolTable& symbols, double& result, Error& error) {
+    ++stats_.evaluations;
+    if (!incremental_) {
+        stats_.recomputed += nodes_.size();
+        return fallback(symbols, result, error);
+    }
+
+    bool missing = false;
+    for (Variable& variable : variables_) {
+        double value;
+        std::uint64_t version;
+        if (!symbols.find(variable.name, value, version)) {
+            missing = true;
+            continue;
+        }
+        bool changed = !variable.seen || version != variable.version ||
+                       (version == 0 && !sameBits(value, variable.value));
+        if (changed) {
+            variable.value = value;
+            variable.version = version;
+            variable.seen = true;
+            for (std::uint32_t leaf : variable.leaves) {
+                invalidate(leaf);
+            }
+        }
+    }
+    for (std::uint32_t node : impure_) {
+        invalidate(node);
+    }
+    if (missing) {
+        stats_.recomputed += nodes_.size();
+        return fallback(symbols, result, error);
+    }
+
+    // En orden de indice, que es postorden: los hijos antes que el padre.
+    // Las marcas se borran solo si todo salio bien.
+    for (std::size_t word = 0; word < dirty_.size(); ++word) {
+        for (std::uint64_t bits = dirty_[word]; bits; bits &= bits - 1) {
+            std::uint32_t index = static_cast<std::uint32_t>(word * 64 + lowestBit(bits));
+            if (!recompute(index)) {
+                stats_.recomputed += nodes_.size();
+                return fallback(symbols, result, error);
+            }
+        }
+    }
+    std::fill(dirty_.begin(), dirty_.end(), 0);
+    stats_.reused += nodes_.size() - dirtyCount_;
+    stats_.recomputed += dirtyCount_;
+    dirtyCount_ = 0;
+    result = values_.back();
+    return true;
+}
+
+// Marca el nodo y sus ancestros; corta en el primero ya marcado, porque
+// entonces todos los de encima tambien lo estan.
+void MemoEvaluator::invalidate(std::uint32_t node) {
+    while (node != kNone && !isDirty(node)) {
+        dirty_[node >> 6] |= std::uint64_t(1) << (node & 63);
+        ++dirtyCount_;
+        node = nodes_[node].parent;
+    }
+}
+
+// Valor del nodo a partir de los de sus hijos, con la aritmetica de
+// Evaluator; false donde Evaluator daria un error.
+bool MemoEvaluator::recompute(std::uint32_t index) {
+    const Node& node = nodes_[index];
+    double left = node.left != kNone ? values_[node.left] : 0.0;
+    double right = node.right != kNone ? values_[node.right] : 0.0;
+    double& value = values_[index];
+    switch (node.type) {
+        case TokenType::NUMBER:
+            value = node.constant;
+            return true;
+        case TokenType::ANS:
+        case TokenType::IDENT:
+            value = variables_[node.variable].value;
+            return true;
+        case TokenType::UNARY_MINUS:
+            value = -left;
+            return true;
+        case TokenType::POWI:
+            value = vecmath::powi(left, static_cast<long>(node.constant));
+            return true;
+        case TokenType::PLUS:
+            value = left + right;
+            return true;
+        case TokenType::MINUS:
+            value = left - right;
+            return true;
+        case TokenType::MUL:
+            value = left * right;
+            return true;
+        case TokenType::DIV:
+            if (right == 0.0) {
+                return false;
+            }
+            value = left / right;
+            return true;
+        case TokenType::POW:
+            value = std::pow(left, right);
+            return true;
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+            value = compareValues(node.type, left, right) ? 1.0 : 0.0;
+            return true;
+        case TokenType::BRANCHES:
+            // Sin valor propio: su SELECT lee las dos ramas.
+            return true;
+        case TokenType::SELECT: {
+            const Node& branches = nodes_[node.right];
+            value = left == 0.0 ? values_[branches.right] : values_[branches.left];
+            return true;
+        }
+        case TokenType::FUNCTION: {
+            const Function* fn = node.function;
+            double args[Function::kMaxArity] = {left, right};
+            if (fn->domain && !fn->domain(args)) {
+                return false;
+            }
+            try {
+                value = fn->impl(args);
+            } catch (const EdaError&) {
+                return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool MemoEvaluator::fallback(const SymbolTable& symbols, double& result, Error& error) const {
+    return Evaluator().evalPostfix(postfix_, symbols, result, error);
+}
+
+} // namespace edacal
@@ -0,0 +1,64 @@
+#include "numeric.hpp"
+
+#include "errors.hpp"
+
+namespace edacal {
+
+namespace {
+
+// Raiz exacta de un entero no negativo pequeno, o false si no es un cuadrado.
+bool exactSquareRoot(const BigInt& value, BigInt& root) {
+    if (!value.isSmall() || value.isNegative()) {
+        return false;
+    }
+    double estimate = std::sqrt(value.toDouble());
+    std::int64_t candidate = static_cast<std::int64_t>(estimate);
+    for (std::int64_t r = candidate > 0 ? candidate - 1 : 0; r <= candidate + 1; ++r) {
+        BigInt square = BigInt(r) * BigInt(r);
+        if (square == value) {
+            root = BigInt(r);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+Rational NumericTraits<Rational>::pow(const Rational& base, const Rational& exponent) {
+    if (!exponent.isInteger() || !exponent.numerator().isSmall()) {
+        throw EdaError("potencia no entera en modo racional");
+    }
+    double value = exponent.numerator().toDouble();
+    if (value > kMaxExponent || value < -kMaxExponent) {
+        throw EdaError("exponente demasiado grande en modo racional");
+    }
+    return base.pow(static_cast<long>(value));
+}
+
+Rational NumericTraits<Rational>::call(const Function* fn, const Rational* args) {
+    const std::string& name = fn->name;
+    if (fn == FunctionRegistry::builtins().find(name)) {
+        if (name == "abs") {
+            return args[0].isNegative() ? -args[0] : args[0];
+        } else if (name == "min") {
+            return args[1] < args[0] ? args[1] : args[0];
+        } else if (name == "max") {
+            return args[0] < args[1] ? args[1] : args[0];
+        } else if (name == "sqrt") {
+            if (args[0].isNegative()) {
+                throw EdaError("sqrt con argumento negativo");
+            }
+            BigInt numerator;
+            BigInt denominator;
+            if (exactSquareRoot(args[0].numerator(), numerator) &&
+                exactSquareRoot(args[0].denominator(), denominator)) {
+                return Rational(numerator, denominator);
+            }
+            throw EdaError("sqrt no exacta en modo racional");
+        }
+    }
+    throw EdaError("funcion no disponible en modo racional: " + name);
+}
+
+} // namespace edacal
@@ -0,0 +1,294 @@
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "printer.hpp"
+#include "symbols.hpp"
+#include "vecmath.hpp"
+
+#include <string>
+#include <vector>
+
+namespace edacal {
+
+namespace {
+
+bool isFoldable(const Token& token) {
+    switch (token.type) {
+        case TokenType::PLUS:
+        case TokenType::MINUS:
+        case TokenType::MUL:
+        case TokenType::DIV:
+        case TokenType::POW:
+        case TokenType::UNARY_MINUS:
+        case TokenType::POWI:
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+        case TokenType::SELECT:
+            return true;
+        case TokenType::FUNCTION:
+            return token.function->pure;
+        default:
+            return false;
+    }
+}
+
+bool constantExponent(const Tree::Node* node, long& exponent) {
+    double value = 0.0;
+    if (node->token.type == TokenType::NUMBER) {
+        value = node->token.value;
+    } else if (node->token.type == TokenType::UNARY_MINUS && node->left->token.type == TokenType::NUMBER) {
+        value = -node->left->token.value;
+    } else {
+        return false;
+    }
+    if (!(value >= -vecmath::kMaxIntegerExponent && value <= vecmath::kMaxIntegerExponent)) {
+        return false;
+    }
+    exponent = static_cast<long>(value);
+    return static_cast<double>(exponent) == value;
+}
+
+// Nodos del arbol en postorden, con una pila explicita: el arbol de una suma
+// larga es tan profundo como terminos tiene. Las pasadas que reescriben un
+// nodo despues de sus hijos recorren esta lista.
+void postorder(Tree::Node* root, std::vector<Tree::Node*>& nodes) {
+    struct Frame {
+        Tree::Node* node;
+        bool expanded;
+    };
+    std::vector<Frame> frames;
+    if (root) {
+        frames.push_back(Frame{root, false});
+    }
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+        frames.pop_back();
+        Tree::Node* node = frame.node;
+        if (!frame.expanded && (node->left || node->right)) {
+            frames.push_back(Frame{node, true});
+            if (node->right) {
+                frames.push_back(Frame{node->right, false});
+            }
+            if (node->left) {
+                frames.push_back(Frame{node->left, false});
+            }
+            continue;
+        }
+        nodes.push_back(node);
+    }
+}
+
+// Si un subarbol ya plegado es constante: un NUMBER, o las ramas de un
+// SELECT si las dos lo son.
+bool isFolded(const Tree::Node* node) {
+    if (!node) {
+        return true;
+    }
+    if (node->token.type == TokenType::BRANCHES) {
+        return isFolded(node->left) && isFolded(node->right);
+    }
+    return node->token.type == TokenType::NUMBER;
+}
+
+// Arma un arbol balanceado sobre operands[lo, hi) reutilizando los nodos de
+// la cadena original. Los nodos se crean en orden posfijo; `created` los
+// recibe en ese orden. Profundidad log2(n), la recursion es corta.
+Tree::Node* balance(const std::vector<Tree::Node*>& operands, std::size_t lo, std::size_t hi,
+                    std::vector<Tree::Node*>& pool, std::vector<Tree::Node*>& created) {
+    if (hi - lo == 1) {
+        return operands[lo];
+    }
+    std::size_t mid = lo + (hi - lo) / 2;
+    Tree::Node* left = balance(operands, lo, mid, pool, created);
+    Tree::Node* right = balance(operands, mid, hi, pool, created);
+    Tree::Node* node = pool.back();
+    pool.pop_back();
+    node->left = left;
+    node->right = right;
+    node->size = 1 + left->size + right->size;
+    created.push_back(node);
+    return node;
+}
+
+} // namespace
+
+void Optimizer::reassociate(Tree& tree, Summation summation) const {
+    Tree::Node* root = tree.release();
+    std::vector<Tree::Node**> pending(1, &root);
+    std::vector<Tree::Node*> walk;
+    std::vector<Tree::Node*> operands;
+    std::vector<Tree::Node*> chain;
+    std::vector<Tree::Node*> created;
+
+    while (!pending.empty()) {
+        Tree::Node** slot = pending.back();
+        pending.pop_back();
+        Tree::Node* node = *slot;
+        if (!node) {
+            continue;
+        }
+        TokenType type = node->token.type;
+        if (type != TokenType::PLUS && type != TokenType::MUL) {
+            pending.push_back(&node->right);
+            pending.push_back(&node->left);
+            continue;
+        }
+
+        // Operandos de la cadena, de izquierda a derecha.
+        operands.clear();
+        chain.clear();
+        walk.assign(1, node);
+        while (!walk.empty()) {
+            Tree::Node* current = walk.back();
+            walk.pop_back();
+            if (current->token.type == type) {
+                chain.push_back(current);
+                walk.push_back(current->right);
+                walk.push_back(current->left);
+            } else {
+                operands.push_back(current);
+            }
+        }
+
+        if (operands.size() >= 3) {
+            created.clear();
+            *slot = balance(operands, 0, operands.size(), chain, created);
+            chain.swap(created);
+            bool compensate = summation == Summation::Compensated && type == TokenType::PLUS;
+            for (Tree::Node* sum : chain) {
+                sum->token.value = static_cast<double>(compensate ? SumMark::INNER : SumMark::NONE);
+            }
+            if (compensate) {
+                chain.front()->token.value = static_cast<double>(SumMark::OPEN);
+                chain.back()->token.value = static_cast<double>(SumMark::CLOSE);
+            }
+        }
+        // Los operandos pueden tener cadenas propias: se visitan por el
+        // puntero que los cuelga de la cadena.
+        for (Tree::Node* sum : chain) {
+            if (sum->left->token.type != type) {
+                pending.push_back(&sum->left);
+            }
+            if (sum->right->token.type != type) {
+                pending.push_back(&sum->right);
+            }
+        }
+    }
+
+    tree.setRoot(root);
+}
+
+void Optimizer::foldConstants(Tree& tree) const {
+    std::vector<Tree::Node*> nodes;
+    postorder(tree.getRoot(), nodes);
+    for (Tree::Node* node : nodes) {
+        foldNode(node);
+    }
+}
+
+void Optimizer::lowerIntegerPowers(Tree& tree) const {
+    std::vector<Tree::Node*> nodes;
+    postorder(tree.getRoot(), nodes);
+    for (Tree::Node* node : nodes) {
+        lowerNode(node);
+    }
+}
+
+TokenList Optimizer::toPostfix(const Tree& tree) const {
+    TokenList output;
+    collectPostfix(tree.getRoot(), output);
+    output.push_back(Token(TokenType::END, ""));
+    return output;
+}
+
+TokenList Optimizer::optimize(const TokenList& postfix, bool fastMath) const {
+    Tree tree;
+    try {
+        tree = Parser().buildTreeFromPostfix(postfix);
+    } catch (const EdaError&) {
+        return postfix;
+    }
+    foldConstants(tree);
+    lowerIntegerPowers(tree);
+    if (fastMath) {
+        reassociate(tree);
+    }
+    return toPostfix(tree);
+}
+
+// Los hijos ya estan plegados (postorden). Las ramas de un SELECT se
+// pliegan con el.
+void Optimizer::foldNode(Tree::Node* node) const {
+    if (!isFoldable(node->token) || !isFolded(node->left) || !isFolded(node->right)) {
+        return;
+    }
+
+    TokenList postfix;
+    collectPostfix(node, postfix);
+    postfix.push_back(Token(TokenType::END, ""));
+
+    double value = 0.0;
+    try {
+        SymbolTable scratch;
+        value = Evaluator().evalPostfix(postfix, scratch);
+    } catch (const EdaError&) {
+        return;
+    }
+
+    if (node->right && node->right->token.type == TokenType::BRANCHES) {
+        delete node->right->left;
+        delete node->right->right;
+    }
+    delete node->left;
+    delete node->right;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->token = Token(TokenType::NUMBER, formatNumber(value), value);
+}
+
+void Optimizer::lowerNode(Tree::Node* node) const {
+    long exponent = 0;
+    if (node->token.type != TokenType::POW || !constantExponent(node->right, exponent)) {
+        return;
+    }
+    Tree::Node* exponentNode = node->right;
+    delete exponentNode->left;
+    delete exponentNode;
+    node->right = nullptr;
+    node->token = Token(TokenType::POWI, "^" + std::to_string(exponent), static_cast<double>(exponent));
+}
+
+// Postorden con una pila explicita: el arbol de una suma larga es tan
+// profundo como terminos tiene.
+void Optimizer::collectPostfix(const Tree::Node* root, TokenList& output) const {
+    struct Frame {
+        const Tree::Node* node;
+        bool expanded;
+    };
+    std::vector<Frame> frames;
+    if (root) {
+        frames.push_back(Frame{root, false});
+    }
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+        frames.pop_back();
+        const Tree::Node* node = frame.node;
+        if (!frame.expanded && (node->left || node->right)) {
+            frames.push_back(Frame{node, true});
+            if (node->right) {
+                frames.push_back(Frame{node->right, false});
+            }
+            if (node->left) {
+                frames.push_back(Frame{node->left, false});
+            }
+            continue;
+        }
+        if (node->token.type != TokenType::BRANCHES) {
+            output.push_back(node->token);
+        }
+    }
+}
+
+} // namespace edacal
@@ -0,0 +1,397 @@
+#include "parallel_evaluator.hpp"
+
+#include "functions.hpp"
+#include "numeric.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+
+namespace edacal {
+
+namespace {
+
+typedef NumericTraits<double> Traits;
+
+bool fail(Error& error, ErrorKind kind, const Token& token, std::string detail = std::string()) {
+    error = Error(kind, token.column, token.lexeme.size(), std::move(detail));
+    return false;
+}
+
+std::size_t operandCount(const Token& token) {
+    switch (token.type) {
+        case TokenType::UNARY_MINUS:
+        case TokenType::POWI:
+            return 1;
+        case TokenType::PLUS:
+        case TokenType::MINUS:
+        case TokenType::MUL:
+        case TokenType::DIV:
+        case TokenType::POW:
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+            return 2;
+        case TokenType::SELECT:
+            return 3;
+        case TokenType::FUNCTION:
+            return token.function->arity;
+        default:
+            return 0;
+    }
+}
+
+// Aplica un nodo sobre los valores de sus hijos, que estan al tope de
+// `values`. Misma aritmetica y mismos errores que BasicEvaluator<double>.
+bool applyNode(const Token& token, const SymbolTable& symbols, std::vector<double>& values,
+               std::vector<double>& compensation, Error& error) {
+    std::size_t operands = operandCount(token);
+    if (values.size() < operands) {
+        return fail(error, ErrorKind::MISSING_OPERANDS, token);
+    }
+    double* args = values.data() + values.size() - operands;
+    double value = 0.0;
+
+    try {
+        switch (token.type) {
+            case TokenType::NUMBER:
+                value = Traits::fromLiteral(token);
+                break;
+            case TokenType::ANS:
+            case TokenType::IDENT: {
+                static const std::string kAns("ans");
+                const std::string& name = token.type == TokenType::ANS ? kAns : token.lexeme;
+                if (!symbols.find(name, value)) {
+                    return fail(error, ErrorKind::UNDEFINED_VARIABLE, token, name);
+                }
+                break;
+            }
+            case TokenType::UNARY_MINUS:
+                value = -args[0];
+                break;
+            case TokenType::FUNCTION: {
+                const Function* fn = token.function;
+                if (fn->domain && !fn->domain(args)) {
+                    error = Error(ErrorKind::DOMAIN, token.column, token.lexeme.size(), fn->name, fn->domainError);
+                    return false;
+                }
+                value = Traits::call(fn, args);
+                break;
+            }
+            case TokenType::PLUS: {
+                SumMark mark = sumMark(token);
+                value = args[0] + args[1];
+                if (mark == SumMark::NONE) {
+                    break;
+                }
+                double lost = std::fabs(args[0]) >= std::fabs(args[1]) ? (args[0] - value) + args[1]
+                                                                       : (args[1] - value) + args[0];
+                if (mark == SumMark::OPEN) {
+                    compensation.push_back(lost);
+                } else if (!compensation.empty()) {
+                    compensation.back() += lost;
+                    if (mark == SumMark::CLOSE) {
+                        value += compensation.back();
+                        compensation.pop_back();
+                    }
+                }
+                break;
+            }
+            case TokenType::MINUS:
+                value = args[0] - args[1];
+                break;
+            case TokenType::MUL:
+                value = args[0] * args[1];
+                break;
+            case TokenType::DIV:
+                if (Traits::isZero(args[1])) {
+                    return fail(error, ErrorKind::DIVISION_BY_ZERO, token);
+                }
+                value = args[0] / args[1];
+                break;
+            case TokenType::POW:
+                value = Traits::pow(args[0], args[1]);
+                break;
+            case TokenType::POWI:
+                value = Traits::powi(args[0], static_cast<long>(token.value));
+                break;
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL:
+                value = compareValues(token.type, args[0], args[1]) ? 1.0 : 0.0;
+                break;
+            case TokenType::SELECT:
+                value = Traits::isZero(args[0]) ? args[2] : args[1];
+                break;
+            case TokenType::BRANCHES:
+                // Deja las dos ramas en la pila para su SELECT.
+                return true;
+            default:
+                return fail(error, ErrorKind::OTHER, token, "token inesperado en evaluacion: " + token.lexeme);
+        }
+    } catch (const EdaError& err) {
+        error = err.error();
+        error.column = token.column;
+        error.length = token.lexeme.size();
+        return false;
+    }
+
+    values.resize(values.size() - operands);
+    values.push_back(value);
+    return true;
+}
+
+// Valores ya calculados de los subarboles cortados, en el orden en que el
+// recorrido los encuentra (preorden, izquierda antes que derecha).
+struct Frontier {
+    std::size_t grain;
+    const std::vector<double>* values;
+    const std::vector<unsigned char>* failed;
+    std::size_t next;
+};
+
+// Las sumas internas de una cadena compensada no se cortan: el error que
+// acumulan tiene que llegar a su CLOSE en el mismo recorrido. Tampoco las
+// ramas de un select, que son dos valores y no uno.
+bool isCut(const Tree::Node* node, std::size_t grain) {
+    SumMark mark = sumMark(node->token);
+    return node->size <= grain && mark != SumMark::OPEN && mark != SumMark::INNER &&
+           node->token.type != TokenType::BRANCHES;
+}
+
+struct Frame {
+    const Tree::Node* node;
+    bool expanded;
+};
+
+// Pilas del recorrido, reutilizadas entre los subarboles de una tarea.
+struct Scratch {
+    std::vector<Frame> frames;
+    std::vector<double> values;
+    std::vector<double> compensation;
+};
+
+bool isLeaf(const Tree::Node* node) {
+    return !node->left && !node->right;
+}
+
+// Posorden iterativo sobre `root`. Con `frontier`, los subarboles cortados
+// no se recorren: se toma su valor; si su tarea fallo se evaluan aqui de
+// nuevo para obtener el error exacto. Las hojas se aplican al expandir a su
+// padre cuando nada queda entre ambos en el orden posfijo.
+bool walk(const Tree::Node* root, const SymbolTable& symbols, Frontier* frontier, Scratch& scratch, double& result,
+          Error& error) {
+    std::vector<Frame>& frames = scratch.frames;
+    std::vector<double>& values = scratch.values;
+    frames.clear();
+    values.clear();
+    scratch.compensation.clear();
+    frames.push_back(Frame{root, false});
+
+    while (!frames.empty()) {
+        Frame frame = frames.back();
+        frames.pop_back();
+        const Tree::Node* node = frame.node;
+
+        if (!frame.expanded) {
+            if (frontier && isCut(node, frontier->grain)) {
+                std::size_t index = frontier->next++;
+                if ((*frontier->failed)[index]) {
+                    Scratch fresh;
+                    double ignored;
+                    return walk(node, symbols, nullptr, fresh, ignored, error);
+                }
+                values.push_back((*frontier->values)[index]);
+                continue;
+            }
+            if (!isLeaf(node)) {
+                frames.push_back(Frame{node, true});
+                if (node->right) {
+                    frames.push_back(Frame{node->right, false});
+                }
+                const Tree::Node* left = node->left;
+                if (left && isLeaf(left) && !(frontier && isCut(left, frontier->grain))) {
+                    if (!applyNode(left->token, symbols, values, scratch.compensation, error)) {
+                        return false;
+                    }
+                } else if (left) {
+                    frames.push_back(Frame{left, false});
+                }
+                continue;
+            }
+        }
+        if (!applyNode(node->token, symbols, values, scratch.compensation, error)) {
+            return false;
+        }
+    }
+
+    if (values.size() != 1) {
+        error = Error(ErrorKind::INVALID_EXPRESSION, 0, 0);
+        return false;
+    }
+    result = values.back();
+    return true;
+}
+
+void collectFrontier(const Tree::Node* root, std::size_t grain, std::vector<const Tree::Node*>& frontier) {
+    std::vector<const Tree::Node*> pending(1, root);
+    while (!pending.empty()) {
+        const Tree::Node* node = pending.back();
+        pending.pop_back();
+        if (isCut(node, grain)) {
+            frontier.push_back(node);
+            continue;
+        }
+        if (node->right) {
+            pending.push_back(node->right);
+        }
+        if (node->left) {
+            pending.push_back(node->left);
+        }
+    }
+}
+
+} // namespace
+
+// Una evaluacion: los subarboles cortados, agrupados en rangos contiguos
+// de costo parecido que los hilos toman por orden de llegada.
+struct ParallelEvaluator::Job {
+    const SymbolTable* symbols;
+    const std::vector<const Tree::Node*>* frontier;
+    std::vector<std::size_t> rangeStarts;
+    std::vector<double> values;
+    std::vector<unsigned char> failed;
+    std::atomic<std::size_t> nextRange;
+};
+
+ParallelEvaluator::ParallelEvaluator(std::size_t threads, std::size_t minNodes)
+    : minNodes_(minNodes), job_(nullptr), generation_(0), busy_(0), stopping_(false) {
+    if (threads == 0) {
+        threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers_.push_back(std::thread(&ParallelEvaluator::workerLoop, this));
+    }
+}
+
+ParallelEvaluator::~ParallelEvaluator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+double ParallelEvaluator::evaluate(const Tree& tree, const SymbolTable& symbols) {
+    double result;
+    Error error;
+    if (!evaluate(tree, symbols, result, error)) {
+        throw EdaError(error);
+    }
+    return result;
+}
+
+bool ParallelEvaluator::evaluate(const Tree& tree, const SymbolTable& symbols, double& result, Error& error) {
+    const Tree::Node* root = tree.getRoot();
+    if (!root) {
+        error = Error(ErrorKind::INVALID_EXPRESSION, 0, 0);
+        return false;
+    }
+    if (workers_.empty() || root->size < minNodes_) {
+        Scratch scratch;
+        return walk(root, symbols, nullptr, scratch, result, error);
+    }
+
+    std::lock_guard<std::mutex> evaluating(evaluateMutex_);
+    std::size_t grain = std::max<std::size_t>(1, root->size / (threads() * kTasksPerThread));
+    std::vector<const Tree::Node*> frontier;
+    collectFrontier(root, grain, frontier);
+
+    Job job;
+    job.symbols = &symbols;
+    job.frontier = &frontier;
+    job.values.resize(frontier.size());
+    job.failed.assign(frontier.size(), 0);
+    job.nextRange = 0;
+    std::size_t accumulated = 0;
+    for (std::size_t i = 0; i < frontier.size(); ++i) {
+        if (accumulated == 0) {
+            job.rangeStarts.push_back(i);
+        }
+        accumulated += frontier[i]->size;
+        if (accumulated >= grain) {
+            accumulated = 0;
+        }
+    }
+    job.rangeStarts.push_back(frontier.size());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        busy_ = workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+    runTasks(job);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+
+    Frontier cut = {grain, &job.values, &job.failed, 0};
+    Scratch scratch;
+    return walk(root, symbols, &cut, scratch, result, error);
+}
+
+void ParallelEvaluator::runTasks(Job& job) {
+    std::size_t ranges = job.rangeStarts.size() - 1;
+    Scratch scratch;
+    for (;;) {
+        std::size_t range = job.nextRange.fetch_add(1);
+        if (range >= ranges) {
+            return;
+        }
+        for (std::size_t i = job.rangeStarts[range]; i < job.rangeStarts[range + 1]; ++i) {
+            Error error;
+            try {
+                job.failed[i] = !walk((*job.frontier)[i], *job.symbols, nullptr, scratch, job.values[i], error);
+            } catch (...) {
+                // Se repite en el hilo que llama, que propaga la excepcion.
+                job.failed[i] = 1;
+            }
+        }
+    }
+}
+
+void ParallelEvaluator::workerLoop() {
+    std::size_t seen = 0;
+    for (;;) {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            job = job_;
+        }
+        runTasks(*job);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+}
+
+} // namespace edacal
@@ -4,8 +4,20 @@ namespace edacal {
 
 namespace {
 
-Token makeUnaryMinusToken() {
-    return Token(TokenType::UNARY_MINUS, "neg");
+Token makeUnaryMinusToken(const Token& minus) {
+    Token token(TokenType::UNARY_MINUS, "neg");
+    token.column = minus.column;
+    return token;
+}
+
+bool fail(Error& error, ErrorKind kind, const Token& token, bool withLexeme = false) {
+    error = Error(kind, token.column, token.lexeme.size(), withLexeme ? token.lexeme : std::string());
+    return false;
+}
+
+// Cantidad de argumentos de una llamada: la de la funcion o 3 para select.
+std::size_t callArity(const Token& call) {
+    return call.type == TokenType::SELECT ? 3 : call.function->arity;
 }
 
 bool isValue(const Token& token) {
@@ -16,31 +28,60 @@ bool isValue(const Token& token) {
 
 } // namespace
 
-LinkedList<Token> Parser::toPostfix(const LinkedList<Token>& tokens) const {
-    LinkedList<Token> output;
+TokenList Parser::toPostfix(const TokenList& tokens) const {
+    TokenList output;
+    Error error;
+    if (!toPostfix(tokens, output, error)) {
+        throw EdaError(error);
+    }
+    return output;
+}
+
+bool Parser::toPostfix(const TokenList& tokens, TokenList& output, Error& error) const {
     Stack<Token> opStack;
+    Stack<bool> callParens;
+    Stack<std::size_t> argCounts;
     bool expectOperand = true;
+    bool afterFunction = false;
 
+    Token end(TokenType::END, "");
     for (auto it = tokens.begin(); it != tokens.end(); ++it) {
         const Token& token = *it;
         if (token.type == TokenType::END) {
+            end = token;
             break;
         }
 
+        bool isCall = afterFunction && token.type == TokenType::LPAREN;
+        if (afterFunction && !isCall && callArity(opStack.top()) != 1) {
+            return fail(error, ErrorKind::EXPECTED_CALL, opStack.top(), true);
+        }
+        afterFunction = false;
+
         if (isValue(token)) {
             output.push_back(token);
             expectOperand = false;
             continue;
         }
 
+        if (token.type == TokenType::SUM || token.type == TokenType::PROD) {
+            if (!reductionToPostfix(it, tokens.end(), output, error)) {
+                return false;
+            }
+            expectOperand = false;
+            continue;
+        }
+
         switch (token.type) {
-            case TokenType::SQRT:
+            case TokenType::FUNCTION:
+            case TokenType::SELECT:
                 opStack.push(token);
                 expectOperand = true;
+                afterFunction = true;
                 break;
             case TokenType::MINUS:
                 if (expectOperand) {
-                    opStack.push(makeUnaryMinusToken());
+                    opStack.push(makeUnaryMinusToken(token));
                 } else {
                     auto handleOperator = [&]() {
                         while (!opStack.empty()) {
@@ -71,9 +112,14 @@ LinkedList<Token> Parser::toPostfix(const LinkedList<Token>& tokens) const {
             case TokenType::PLUS:
             case TokenType::MUL:
             case TokenType::DIV:
-            case TokenType::POW: {
+            case TokenType::POW:
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL: {
                 if (expectOperand) {
-                    throw EdaError("operando esperado antes del operador '" + token.lexeme + "'");
+                    return fail(error, ErrorKind::OPERAND_EXPECTED, token, true);
                 }
                 while (!opStack.empty()) {
                     Token top = opStack.top();
@@ -101,8 +147,27 @@ LinkedList<Token> Parser::toPostfix(const LinkedList<Token>& tokens) const {
             }
             case TokenType::LPAREN:
                 opStack.push(token);
+                callParens.push(isCall);
+                if (isCall) {
+                    argCounts.push(1);
+                }
                 expectOperand = true;
                 break;
+            case TokenType::COMMA: {
+                if (expectOperand) {
+                    return fail(error, ErrorKind::EMPTY_ARGUMENT, token);
+                }
+                while (!opStack.empty() && opStack.top().type != TokenType::LPAREN) {
+                    output.push_back(opStack.top());
+                    opStack.pop();
+                }
+                if (opStack.empty() || !callParens.top()) {
+                    return fail(error, ErrorKind::STRAY_COMMA, token);
+                }
+                ++argCounts.top();
+                expectOperand = true;
+                break;
+            }
             case TokenType::RPAREN: {
                 bool found = false;
                 while (!opStack.empty()) {
@@ -116,40 +181,139 @@ LinkedList<Token> Parser::toPostfix(const LinkedList<Token>& tokens) const {
                     opStack.pop();
                 }
                 if (!found) {
-                    throw EdaError("parentesis desbalanceados");
+                    return fail(error, ErrorKind::UNBALANCED_PARENS, token);
                 }
-                if (!opStack.empty() && isFunction(opStack.top().type)) {
-                    output.push_back(opStack.top());
+                bool closesCall = callParens.top();
+                callParens.pop();
+                if (closesCall) {
+                    const Token& call = opStack.top();
+                    if (expectOperand) {
+                        return fail(error, ErrorKind::EMPTY_ARGUMENT, token);
+                    }
+                    if (argCounts.top() != callArity(call)) {
+                        return fail(error, ErrorKind::ARGUMENT_COUNT, call, true);
+                    }
+                    argCounts.pop();
+                    output.push_back(call);
                     opStack.pop();
                 }
                 expectOperand = false;
                 break;
             }
             case TokenType::ASSIGN:
-                throw EdaError("asignacion inesperada dentro de la expresion");
+                return fail(error, ErrorKind::UNEXPECTED_ASSIGN, token);
             default:
-                throw EdaError("token inesperado: " + token.lexeme);
+                return fail(error, ErrorKind::UNEXPECTED_TOKEN, token, true);
         }
     }
 
     if (expectOperand && !output.empty()) {
-        throw EdaError("expresion incompleta");
+        return fail(error, ErrorKind::INCOMPLETE_EXPRESSION, end);
     }
 
     while (!opStack.empty()) {
         Token top = opStack.top();
         opStack.pop();
         if (top.type == TokenType::LPAREN || top.type == TokenType::RPAREN) {
-            throw EdaError("parentesis desbalanceados");
+            return fail(error, ErrorKind::UNBALANCED_PARENS, top);
         }
         output.push_back(top);
     }
 
-    output.push_back(Token(TokenType::END, ""));
-    return output;
+    output.push_back(end);
+    return true;
 }
 
-Tree Parser::buildTreeFromPostfix(const LinkedList<Token>& postfix) const {
+bool Parser::reductionToPostfix(TokenList::ConstIterator& it, TokenList::ConstIterator end, TokenList& output,
+                                Error& error) const {
+    const Token& keyword = *it;
+    ++it;
+    if (it == end || it->type != TokenType::LPAREN) {
+        return fail(error, ErrorKind::EXPECTED_CALL, keyword, true);
+    }
+    ++it;
+    if (it == end || it->type != TokenType::IDENT) {
+        const Token& found = it == end ? keyword : *it;
+        error = Error(ErrorKind::OTHER, found.column, found.lexeme.size(),
+                      "se esperaba el nombre del indice en '" + keyword.lexeme + "'");
+        return false;
+    }
+    const std::string& index = it->lexeme;
+    ++it;
+    if (it == end || it->type != TokenType::COMMA) {
+        return fail(error, ErrorKind::ARGUMENT_COUNT, keyword, true);
+    }
+
+    // Desde, hasta y cuerpo: se separan por las comas de primer nivel y
+    // cada uno se pasa a posfija por su cuenta.
+    TokenList args[3];
+    std::size_t count = 0;
+    std::size_t depth = 0;
+    for (++it;; ++it) {
+        if (it == end || it->type == TokenType::END) {
+            return fail(error, ErrorKind::UNBALANCED_PARENS, keyword);
+        }
+        const Token& token = *it;
+        bool closes = token.type == TokenType::RPAREN && depth == 0;
+        if (closes || (token.type == TokenType::COMMA && depth == 0)) {
+            if (count == 3) {
+                return fail(error, ErrorKind::ARGUMENT_COUNT, keyword, true);
+            }
+            if (args[count].empty()) {
+                return fail(error, ErrorKind::EMPTY_ARGUMENT, token);
+            }
+            Token argEnd(TokenType::END, "");
+            argEnd.column = token.column;
+            args[count++].push_back(argEnd);
+            if (closes) {
+                break;
+            }
+            continue;
+        }
+        if (token.type == TokenType::LPAREN) {
+            ++depth;
+        } else if (token.type == TokenType::RPAREN) {
+            --depth;
+        }
+        if (count < 3) {
+            args[count].push_back(token);
+        }
+    }
+    if (count != 3) {
+        return fail(error, ErrorKind::ARGUMENT_COUNT, keyword, true);
+    }
+
+    TokenList postfix[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (!toPostfix(args[i], postfix[i], error)) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < 2; ++i) {
+        for (auto arg = postfix[i].begin(); arg != postfix[i].end() && arg->type != TokenType::END; ++arg) {
+            output.push_back(*arg);
+        }
+    }
+
+    Token header(keyword.type, keyword.lexeme, static_cast<double>(postfix[2].size() - 1));
+    header.column = keyword.column;
+    output.push_back(header);
+    // Los bucles anidados del cuerpo quedan un nivel mas adentro; las
+    // referencias libres al indice pasan a ser el nivel 0.
+    for (auto body = postfix[2].begin(); body != postfix[2].end() && body->type != TokenType::END; ++body) {
+        Token token = *body;
+        if (token.type == TokenType::INDEX) {
+            token.value += 1.0;
+        } else if (token.type == TokenType::IDENT && token.lexeme == index) {
+            token.type = TokenType::INDEX;
+            token.value = 0.0;
+        }
+        output.push_back(std::move(token));
+    }
+    return true;
+}
+
+Tree Parser::buildTreeFromPostfix(const TokenList& postfix) const {
     Stack<Tree::Node*> nodeStack;
 
     auto cleanup = [&]() {
@@ -171,7 +335,28 @@ Tree Parser::buildTreeFromPostfix(const LinkedList<Token>& postfix) const {
             continue;
         }
 
-        if (token.type == TokenType::UNARY_MINUS || token.type == TokenType::SQRT) {
+        if (token.type == TokenType::FUNCTION) {
+            std::size_t arity = token.function->arity;
+            if (nodeStack.size() < arity) {
+                cleanup();
+                throw EdaError("faltan argumentos para '" + token.lexeme + "'");
+            }
+            Tree::Node* args[Function::kMaxArity] = {};
+            for (std::size_t i = arity; i > 0; --i) {
+                args[i - 1] = nodeStack.top();
+                nodeStack.pop();
+            }
+            Tree::Node* node = new Tree::Node(token);
+            node->left = args[0];
+            node->right = args[1];
+            for (std::size_t i = 0; i < arity; ++i) {
+                node->size += args[i]->size;
+            }
+            nodeStack.push(node);
+            continue;
+        }
+
+        if (token.type == TokenType::UNARY_MINUS || token.type == TokenType::POWI) {
             if (nodeStack.empty()) {
                 cleanup();
                 throw EdaError("falta operando para operador '" + token.lexeme + "'");
@@ -180,6 +365,7 @@ Tree Parser::buildTreeFromPostfix(const LinkedList<Token>& postfix) const {
             nodeStack.pop();
             Tree::Node* node = new Tree::Node(token);
             node->left = operand;
+            node->size += operand->size;
             nodeStack.push(node);
             continue;
         }
@@ -188,7 +374,8 @@ Tree Parser::buildTreeFromPostfix(const LinkedList<Token>& postfix) const {
             token.type == TokenType::MINUS ||
             token.type == TokenType::MUL ||
             token.type == TokenType::DIV ||
-            token.type == TokenType::POW) {
+            token.type == TokenType::POW ||
+            isComparison(token.type)) {
             if (nodeStack.size() < 2) {
                 cleanup();
                 throw EdaError("falta operando para operador '" + token.lexeme + "'");
@@ -200,11 +387,37 @@ Tree Parser::buildTreeFromPostfix(const LinkedList<Token>& postfix) const {
             Tree::Node* node = new Tree::Node(token);
             node->left = left;
             node->right = right;
+            node->size += left->size + right->size;
+            nodeStack.push(node);
+            continue;
+        }
+
+        if (token.type == TokenType::SELECT) {
+            if (nodeStack.size() < 3) {
+                cleanup();
+                throw EdaError("faltan argumentos para '" + token.lexeme + "'");
+            }
+            Tree::Node* branches = new Tree::Node(Token(TokenType::BRANCHES, "ramas"));
+            branches->token.column = token.column;
+            branches->right = nodeStack.top();
+            nodeStack.pop();
+            branches->left = nodeStack.top();
+            nodeStack.pop();
+            branches->size += branches->left->size + branches->right->size;
+            Tree::Node* node = new Tree::Node(token);
+            node->left = nodeStack.top();
+            nodeStack.pop();
+            node->right = branches;
+            node->size += node->left->size + branches->size;
             nodeStack.push(node);
             continue;
         }
 
         cleanup();
+        if (token.type == TokenType::SUM || token.type == TokenType::PROD) {
+            // El bucle reevalua su cuerpo: solo existe en posfija.
+            throw EdaError("'" + token.lexeme + "' no tiene representacion como arbol");
+        }
         throw EdaError("token no manejado en arbol: " + token.lexeme);
     }
 
@@ -223,15 +436,22 @@ Tree Parser::buildTreeFromPostfix(const LinkedList<Token>& postfix) const {
 int Parser::precedence(TokenType type) {
     switch (type) {
         case TokenType::UNARY_MINUS:
-        case TokenType::SQRT:
-            return 4;
+        case TokenType::FUNCTION:
+        case TokenType::SELECT:
+            return 5;
         case TokenType::POW:
-            return 3;
+            return 4;
         case TokenType::MUL:
         case TokenType::DIV:
-            return 2;
+            return 3;
         case TokenType::PLUS:
         case TokenType::MINUS:
+            return 2;
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
             return 1;
         default:
             return 0;
@@ -239,11 +459,12 @@ int Parser::precedence(TokenType type) {
 }
 
 bool Parser::isRightAssociative(TokenType type) {
-    return type == TokenType::POW || type == TokenType::UNARY_MINUS || type == TokenType::SQRT;
+    return type == TokenType::POW || type == TokenType::UNARY_MINUS || type == TokenType::FUNCTION ||
+           type == TokenType::SELECT;
 }
 
 bool Parser::isFunction(TokenType type) {
-    return type == TokenType::SQRT;
+    return type == TokenType::FUNCTION || type == TokenType::SELECT;
 }
 
 } // namespace edacal
@@ -1,30 +1,76 @@
 #include "printer.hpp"
 
 #include <cmath>
-#include <iomanip>
-#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <vector>
 
 namespace edacal {
 
-std::string formatNumber(double value) {
+namespace {
+
+// DBL_MAX con 12 decimales ocupa 322 caracteres.
+const std::size_t kNumberBuffer = 400;
+
+// La salida se junta en un string y se escribe en bloques de este tamano;
+// el stream se vacia una sola vez al final.
+const std::size_t kFlushThreshold = 1 << 16;
+
+// Igual que std::fixed con setprecision(12) (libstdc++ formatea con el
+// mismo printf) sin ceros finales, pero sin ostringstream ni strings
+// intermedios.
+void appendNumber(std::string& out, double value) {
     if (std::fabs(value) < 1e-12) {
-        return "0";
+        out += '0';
+        return;
     }
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(12) << value;
-    std::string text = oss.str();
-    std::size_t pos = text.find('.');
-    if (pos != std::string::npos) {
-        while (!text.empty() && text.back() == '0') {
-            text.pop_back();
+    char buffer[kNumberBuffer];
+    int written = std::snprintf(buffer, sizeof(buffer), "%.12f", value);
+    std::size_t length = written > 0 ? static_cast<std::size_t>(written) : 0;
+    if (std::memchr(buffer, '.', length)) {
+        while (length > 0 && buffer[length - 1] == '0') {
+            --length;
         }
-        if (!text.empty() && text.back() == '.') {
-            text.pop_back();
+        if (length > 0 && buffer[length - 1] == '.') {
+            --length;
         }
     }
-    if (text.empty()) {
-        text = "0";
+    if (length == 0) {
+        out += '0';
+        return;
+    }
+    out.append(buffer, length);
+}
+
+void appendToken(std::string& out, const Token& token) {
+    if (token.type == TokenType::NUMBER) {
+        appendNumber(out, token.value);
+    } else if (token.type == TokenType::UNARY_MINUS) {
+        out += "neg";
+    } else if (token.type == TokenType::SUM || token.type == TokenType::PROD) {
+        // Largo del cuerpo, para que la posfija se pueda leer sin ambiguedad.
+        out += token.lexeme;
+        out += '[';
+        out += std::to_string(static_cast<long>(token.value));
+        out += ']';
+    } else if (token.type != TokenType::END) {
+        out += token.lexeme;
+    }
+}
+
+void drain(std::string& out, std::ostream& os, std::size_t threshold) {
+    if (out.size() >= threshold) {
+        os.write(out.data(), static_cast<std::streamsize>(out.size()));
+        out.clear();
     }
+}
+
+} // namespace
+
+std::string formatNumber(double value) {
+    std::string text;
+    appendNumber(text, value);
     return text;
 }
 
@@ -41,10 +87,22 @@ std::string tokenToString(const Token& token) {
         case TokenType::POW:
         case TokenType::LPAREN:
         case TokenType::RPAREN:
+        case TokenType::COMMA:
         case TokenType::ASSIGN:
+        case TokenType::FUNCTION:
+        case TokenType::POWI:
+        case TokenType::INDEX:
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+        case TokenType::SELECT:
+        case TokenType::BRANCHES:
             return token.lexeme;
-        case TokenType::SQRT:
-            return "sqrt";
+        case TokenType::SUM:
+        case TokenType::PROD:
+            return token.lexeme + "[" + std::to_string(static_cast<long>(token.value)) + "]";
         case TokenType::UNARY_MINUS:
             return "neg";
         case TokenType::END:
@@ -58,10 +116,59 @@ void Printer::printTree(const Tree& tree, std::ostream& os) const {
         os << "(arbol vacio)" << std::endl;
         return;
     }
-    printTreeNode(tree.getRoot(), "", false, os);
+
+    // Recorrido derecho-nodo-izquierdo con pila explicita. `prefix` es un
+    // unico buffer: un nodo de profundidad d usa sus primeros 4d caracteres
+    // y sus descendientes solo escriben de ahi en adelante.
+    struct Item {
+        const Tree::Node* node;
+        std::size_t prefixLength;
+        bool isLeft;
+        bool emit;
+        const char* segment;
+    };
+    std::vector<Item> pending;
+    pending.push_back(Item{tree.getRoot(), 0, false, false, nullptr});
+    std::string prefix;
+    std::string out;
+    out.reserve(kFlushThreshold + 1024);
+
+    while (!pending.empty()) {
+        Item item = pending.back();
+        pending.pop_back();
+        const Tree::Node* node = item.node;
+
+        if (item.emit) {
+            out.append(prefix, 0, item.prefixLength);
+            if (item.prefixLength > 0) {
+                out += item.isLeft ? "|-- " : "\\-- ";
+            }
+            appendToken(out, node->token);
+            out += '\n';
+            drain(out, os, kFlushThreshold);
+            continue;
+        }
+
+        if (item.segment) {
+            prefix.resize(item.prefixLength - 4);
+            prefix += item.segment;
+        }
+        const char* childSegment = item.isLeft ? "|   " : "    ";
+        std::size_t childLength = item.prefixLength + 4;
+        if (node->left) {
+            pending.push_back(Item{node->left, childLength, true, false, childSegment});
+        }
+        pending.push_back(Item{node, item.prefixLength, item.isLeft, true, nullptr});
+        if (node->right) {
+            pending.push_back(Item{node->right, childLength, false, false, childSegment});
+        }
+    }
+    drain(out, os, 0);
+    os.flush();
 }
 
-void Printer::printPostfix(const LinkedList<Token>& tokens, std::ostream& os) const {
+void Printer::printPostfix(const TokenList& tokens, std::ostream& os) const {
+    std::string out;
     bool first = true;
     for (auto it = tokens.begin(); it != tokens.end(); ++it) {
         const Token& token = *it;
@@ -69,12 +176,15 @@ void Printer::printPostfix(const LinkedList<Token>& tokens, std::ostream& os) co
             break;
         }
         if (!first) {
-            os << ' ';
+            out += ' ';
         }
-        os << tokenToString(token);
+        appendToken(out, token);
+        drain(out, os, kFlushThreshold);
         first = false;
     }
-    os << std::endl;
+    out += '\n';
+    drain(out, os, 0);
+    os.flush();
 }
 
 void Printer::printPrefix(const Tree& tree, std::ostream& os) const {
@@ -82,45 +192,31 @@ void Printer::printPrefix(const Tree& tree, std::ostream& os) const {
         os << "(arbol vacio)" << std::endl;
         return;
     }
-    LinkedList<std::string> items;
-    collectPrefix(tree.getRoot(), items);
+    std::vector<const Tree::Node*> pending(1, tree.getRoot());
+    std::string out;
     bool first = true;
-    for (auto it = items.begin(); it != items.end(); ++it) {
-        if (!first) {
-            os << ' ';
+    while (!pending.empty()) {
+        const Tree::Node* node = pending.back();
+        pending.pop_back();
+        // select tiene aridad fija: `select c a b` se lee sin el nodo de ramas.
+        if (node->token.type != TokenType::BRANCHES) {
+            if (!first) {
+                out += ' ';
+            }
+            appendToken(out, node->token);
+            drain(out, os, kFlushThreshold);
+            first = false;
+        }
+        if (node->right) {
+            pending.push_back(node->right);
+        }
+        if (node->left) {
+            pending.push_back(node->left);
         }
-        os << *it;
-        first = false;
-    }
-    os << std::endl;
-}
-
-void Printer::printTreeNode(const Tree::Node* node, const std::string& prefix, bool isLeft, std::ostream& os) const {
-    if (!node) {
-        return;
-    }
-    if (node->right) {
-        std::string nextPrefix = prefix + (isLeft ? "|   " : "    ");
-        printTreeNode(node->right, nextPrefix, false, os);
-    }
-    os << prefix;
-    if (!prefix.empty()) {
-        os << (isLeft ? "|-- " : "\\-- ");
-    }
-    os << tokenToString(node->token) << std::endl;
-    if (node->left) {
-        std::string nextPrefix = prefix + (isLeft ? "|   " : "    ");
-        printTreeNode(node->left, nextPrefix, true, os);
-    }
-}
-
-void Printer::collectPrefix(const Tree::Node* node, LinkedList<std::string>& output) const {
-    if (!node) {
-        return;
     }
-    output.push_back(tokenToString(node->token));
-    collectPrefix(node->left, output);
-    collectPrefix(node->right, output);
+    out += '\n';
+    drain(out, os, 0);
+    os.flush();
 }
 
 } // namespace edacal
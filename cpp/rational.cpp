@@ -0,0 +1,167 @@
+#include "rational.hpp"
+
+#include "errors.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <utility>
+
+namespace edacal {
+
+Rational::Rational() : numerator_(0), denominator_(1) {}
+
+Rational::Rational(std::int64_t value) : numerator_(value), denominator_(1) {}
+
+Rational::Rational(const BigInt& numerator, const BigInt& denominator)
+    : numerator_(numerator), denominator_(denominator) {
+    if (denominator_.isZero()) {
+        throw EdaError("division por cero");
+    }
+    normalize();
+}
+
+void Rational::normalize() {
+    if (denominator_.isNegative()) {
+        numerator_ = -numerator_;
+        denominator_ = -denominator_;
+    }
+    if (numerator_.isZero()) {
+        denominator_ = BigInt(1);
+        return;
+    }
+    BigInt divisor = BigInt::gcd(numerator_, denominator_);
+    if (divisor != BigInt(1)) {
+        numerator_ = numerator_ / divisor;
+        denominator_ = denominator_ / divisor;
+    }
+}
+
+Rational Rational::reduced(const BigInt& numerator, const BigInt& denominator) {
+    Rational result;
+    result.numerator_ = numerator;
+    result.denominator_ = denominator;
+    return result;
+}
+
+Rational Rational::parseDecimal(const std::string& text) {
+    std::string digits;
+    std::size_t decimals = 0;
+    bool dotSeen = false;
+    for (char c : text) {
+        if (c == '.' && !dotSeen) {
+            dotSeen = true;
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            digits += c;
+            decimals += dotSeen ? 1 : 0;
+        } else {
+            throw EdaError("numero invalido: " + text);
+        }
+    }
+    if (digits.empty()) {
+        throw EdaError("numero invalido: " + text);
+    }
+    return Rational(BigInt::parse(digits), BigInt::parse("1" + std::string(decimals, '0')));
+}
+
+Rational Rational::fromDouble(double value) {
+    if (!std::isfinite(value)) {
+        throw EdaError("valor no finito en modo racional");
+    }
+    int exponent = 0;
+    double mantissa = std::frexp(value, &exponent);
+    // value = mantissa * 2^exponent con |mantissa| en [0.5, 1): 53 bits enteros.
+    std::int64_t integer = static_cast<std::int64_t>(std::ldexp(mantissa, 53));
+    exponent -= 53;
+    if (exponent >= 0) {
+        return Rational(BigInt(integer) * BigInt::powerOfTwo(static_cast<unsigned>(exponent)), BigInt(1));
+    }
+    return Rational(BigInt(integer), BigInt::powerOfTwo(static_cast<unsigned>(-exponent)));
+}
+
+int Rational::compare(const Rational& other) const {
+    if (denominator_ == other.denominator_) {
+        return numerator_.compare(other.numerator_);
+    }
+    return (numerator_ * other.denominator_).compare(other.numerator_ * denominator_);
+}
+
+Rational Rational::operator-() const {
+    Rational result = *this;
+    result.numerator_ = -numerator_;
+    return result;
+}
+
+Rational operator+(const Rational& a, const Rational& b) {
+    if (a.denominator_ == b.denominator_) {
+        return Rational(a.numerator_ + b.numerator_, a.denominator_);
+    }
+    return Rational(a.numerator_ * b.denominator_ + b.numerator_ * a.denominator_, a.denominator_ * b.denominator_);
+}
+
+Rational operator-(const Rational& a, const Rational& b) {
+    return a + (-b);
+}
+
+Rational operator*(const Rational& a, const Rational& b) {
+    return Rational(a.numerator_ * b.numerator_, a.denominator_ * b.denominator_);
+}
+
+Rational operator/(const Rational& a, const Rational& b) {
+    if (b.isZero()) {
+        throw EdaError("division por cero");
+    }
+    return Rational(a.numerator_ * b.denominator_, a.denominator_ * b.numerator_);
+}
+
+// Si n/d es irreducible tambien lo es n^k/d^k: no hace falta ningun mcd.
+Rational Rational::pow(long exponent) const {
+    if (exponent < 0 && isZero()) {
+        throw EdaError("division por cero");
+    }
+    unsigned long remaining = exponent < 0 ? 0UL - static_cast<unsigned long>(exponent)
+                                           : static_cast<unsigned long>(exponent);
+    BigInt numerator(1);
+    BigInt denominator(1);
+    BigInt baseNumerator = numerator_;
+    BigInt baseDenominator = denominator_;
+    while (remaining) {
+        if (remaining & 1UL) {
+            numerator = numerator * baseNumerator;
+            denominator = denominator * baseDenominator;
+        }
+        remaining >>= 1;
+        if (remaining) {
+            baseNumerator = baseNumerator * baseNumerator;
+            baseDenominator = baseDenominator * baseDenominator;
+        }
+    }
+    if (exponent < 0) {
+        std::swap(numerator, denominator);
+        if (denominator.isNegative()) {
+            numerator = -numerator;
+            denominator = -denominator;
+        }
+    }
+    return reduced(numerator, denominator);
+}
+
+// Con operandos grandes se divide n * 2^k entre d para quedarse con unos 64
+// bits significativos y no dividir inf entre inf.
+double Rational::toDouble() const {
+    if (numerator_.isSmall() && denominator_.isSmall()) {
+        return numerator_.toDouble() / denominator_.toDouble();
+    }
+    long shift = 64 - (static_cast<long>(numerator_.bitLength()) - static_cast<long>(denominator_.bitLength()));
+    BigInt scaled = shift >= 0 ? numerator_ * BigInt::powerOfTwo(static_cast<unsigned>(shift)) : numerator_;
+    BigInt divisor = shift >= 0 ? denominator_ : denominator_ * BigInt::powerOfTwo(static_cast<unsigned>(-shift));
+    return std::ldexp((scaled / divisor).toDouble(), static_cast<int>(-shift));
+}
+
+std::string Rational::toString() const {
+    if (isInteger()) {
+        return numerator_.toString();
+    }
+    return numerator_.toString() + "/" + denominator_.toString();
+}
+
+} // namespace edacal
@@ -0,0 +1,397 @@
+#include "register_vm.hpp"
+
+#include "evaluator.hpp"
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__)
+#define EDACAL_THREADED_DISPATCH 1
+#endif
+
+namespace edacal {
+
+namespace {
+
+// Durante la compilacion los operandos llevan su zona en los dos bits altos;
+// al terminar se traducen a posiciones del arreglo de valores, que tiene
+// primero las constantes, despues las variables y al final los temporales.
+enum Zone : std::uint32_t {
+    kConstant = 0,
+    kVariable = 1,
+    kTemporary = 2
+};
+
+const std::uint32_t kZoneShift = 30;
+const std::uint32_t kIndexMask = (1u << kZoneShift) - 1;
+
+std::uint32_t operand(Zone zone, std::size_t index) {
+    return (static_cast<std::uint32_t>(zone) << kZoneShift) | static_cast<std::uint32_t>(index);
+}
+
+std::uint32_t resolve(std::uint32_t tagged, std::size_t variableBase, std::size_t temporaryBase) {
+    std::size_t index = tagged & kIndexMask;
+    switch (tagged >> kZoneShift) {
+        case kVariable:
+            return static_cast<std::uint32_t>(variableBase + index);
+        case kTemporary:
+            return static_cast<std::uint32_t>(temporaryBase + index);
+        default:
+            return static_cast<std::uint32_t>(index);
+    }
+}
+
+} // namespace
+
+RegisterVM::RegisterVM(const TokenList& postfix) : postfix_(postfix), compiled_(false), slots_(0), result_(0) {
+    compiled_ = compile(postfix_);
+    if (!compiled_) {
+        code_.clear();
+        constants_.clear();
+        variables_.clear();
+    }
+}
+
+bool RegisterVM::compile(const TokenList& postfix) {
+    std::vector<std::uint32_t> stack;
+    std::size_t temporaries = 0;
+
+    auto emit = [&](Opcode op, std::size_t operands, long exponent, const Function* function) {
+        Instruction instruction = {op, 0, 0, 0, 0, exponent, function};
+        if (operands == 3) {
+            instruction.c = stack.back();
+            stack.pop_back();
+        }
+        if (operands >= 2) {
+            instruction.b = stack.back();
+            stack.pop_back();
+        }
+        instruction.a = stack.back();
+        stack.pop_back();
+        // El resultado queda en el temporal de la altura de pila que ocupa,
+        // que ya no usa ningun operando pendiente.
+        instruction.dst = operand(kTemporary, stack.size());
+        temporaries = std::max(temporaries, stack.size() + 1);
+        stack.push_back(instruction.dst);
+        code_.push_back(instruction);
+    };
+
+    for (const Token& token : postfix) {
+        if (token.type == TokenType::END) {
+            break;
+        }
+        std::size_t operands = 0;
+        switch (token.type) {
+            case TokenType::UNARY_MINUS:
+            case TokenType::POWI:
+                operands = 1;
+                break;
+            case TokenType::PLUS:
+            case TokenType::MINUS:
+            case TokenType::MUL:
+            case TokenType::DIV:
+            case TokenType::POW:
+            case TokenType::LESS:
+            case TokenType::LESS_EQUAL:
+            case TokenType::GREATER:
+            case TokenType::GREATER_EQUAL:
+            case TokenType::EQUAL:
+                operands = 2;
+                break;
+            case TokenType::SELECT:
+                operands = 3;
+                break;
+            case TokenType::FUNCTION:
+                operands = token.function->arity;
+                break;
+            default:
+                break;
+        }
+        if (stack.size() < operands) {
+            return false;
+        }
+
+        switch (token.type) {
+            case TokenType::NUMBER:
+                stack.push_back(operand(kConstant, constants_.size()));
+                constants_.push_back(token.value);
+                break;
+            case TokenType::ANS:
+            case TokenType::IDENT: {
+                static const std::string kAns("ans");
+                const std::string& name = token.type == TokenType::ANS ? kAns : token.lexeme;
+                std::size_t index =
+                    std::find(variables_.begin(), variables_.end(), name) - variables_.begin();
+                if (index == variables_.size()) {
+                    variables_.push_back(name);
+                }
+                stack.push_back(operand(kVariable, index));
+                break;
+            }
+            case TokenType::UNARY_MINUS:
+                emit(NEG, 1, 0, nullptr);
+                break;
+            case TokenType::POWI: {
+                long exponent = static_cast<long>(token.value);
+                emit(exponent == 2 ? SQUARE : POWI, 1, exponent, nullptr);
+                break;
+            }
+            case TokenType::PLUS:
+                if (sumMark(token) != SumMark::NONE) {
+                    return false;
+                }
+                emit(ADD, 2, 0, nullptr);
+                break;
+            case TokenType::MINUS:
+                emit(SUB, 2, 0, nullptr);
+                break;
+            case TokenType::MUL:
+                emit(MUL, 2, 0, nullptr);
+                break;
+            case TokenType::DIV:
+                emit(DIV, 2, 0, nullptr);
+                break;
+            case TokenType::POW:
+                emit(POW, 2, 0, nullptr);
+                break;
+            case TokenType::LESS:
+                emit(LT, 2, 0, nullptr);
+                break;
+            case TokenType::LESS_EQUAL:
+                emit(LE, 2, 0, nullptr);
+                break;
+            case TokenType::GREATER:
+                emit(GT, 2, 0, nullptr);
+                break;
+            case TokenType::GREATER_EQUAL:
+                emit(GE, 2, 0, nullptr);
+                break;
+            case TokenType::EQUAL:
+                emit(EQ, 2, 0, nullptr);
+                break;
+            case TokenType::SELECT:
+                emit(SELECT, 3, 0, nullptr);
+                break;
+            case TokenType::FUNCTION:
+                if (operands == 1) {
+                    emit(CALL1, 1, 0, token.function);
+                } else if (operands == 2) {
+                    emit(CALL2, 2, 0, token.function);
+                } else {
+                    return false;
+                }
+                break;
+            default:
+                // sum/prod, indices y tokens que Evaluator rechaza.
+                return false;
+        }
+    }
+    if (stack.size() != 1 || constants_.size() + variables_.size() + temporaries > kIndexMask) {
+        return false;
+    }
+
+    std::size_t variableBase = constants_.size();
+    std::size_t temporaryBase = variableBase + variables_.size();
+    for (Instruction& instruction : code_) {
+        instruction.dst = resolve(instruction.dst, variableBase, temporaryBase);
+        instruction.a = resolve(instruction.a, variableBase, temporaryBase);
+        instruction.b = resolve(instruction.b, variableBase, temporaryBase);
+        instruction.c = resolve(instruction.c, variableBase, temporaryBase);
+    }
+    Instruction halt = {HALT, 0, 0, 0, 0, 0, nullptr};
+    code_.push_back(halt);
+    slots_ = temporaryBase + temporaries;
+    result_ = resolve(stack.back(), variableBase, temporaryBase);
+    return true;
+}
+
+double RegisterVM::evaluate(const SymbolTable& symbols) const {
+    double result;
+    Error error;
+    if (!evaluate(symbols, result, error)) {
+        throw EdaError(error);
+    }
+    return result;
+}
+
+bool RegisterVM::evaluate(const SymbolTable& symbols, double& result, Error& error) const {
+    if (!compiled_) {
+        return fallback(symbols, result, error);
+    }
+    double inlineSlots[kInlineSlots];
+    std::vector<double> heapSlots;
+    double* slots = inlineSlots;
+    if (slots_ > kInlineSlots) {
+        heapSlots.resize(slots_);
+        slots = heapSlots.data();
+    }
+    std::copy(constants_.begin(), constants_.end(), slots);
+    double* variables = slots + constants_.size();
+    for (std::size_t i = 0; i < variables_.size(); ++i) {
+        if (!symbols.find(variables_[i], variables[i])) {
+            return fallback(symbols, result, error);
+        }
+    }
+    return execute(slots, result) || fallback(symbols, result, error);
+}
+
+bool RegisterVM::evaluate(const double* values, double& result) const {
+    if (!compiled_) {
+        return false;
+    }
+    double inlineSlots[kInlineSlots];
+    std::vector<double> heapSlots;
+    double* slots = inlineSlots;
+    if (slots_ > kInlineSlots) {
+        heapSlots.resize(slots_);
+        slots = heapSlots.data();
+    }
+    std::copy(constants_.begin(), constants_.end(), slots);
+    std::copy(values, values + variables_.size(), slots + constants_.size());
+    return execute(slots, result);
+}
+
+bool RegisterVM::execute(double* slots, double& result) const {
+    bool ok;
+    try {
+        ok = run(slots);
+    } catch (const EdaError&) {
+        ok = false;
+    }
+    if (ok) {
+        result = slots[result_];
+    }
+    return ok;
+}
+
+bool RegisterVM::fallback(const SymbolTable& symbols, double& result, Error& error) const {
+    SymbolTable copy(symbols);
+    return Evaluator().evalPostfix(postfix_, copy, result, error);
+}
+
+#if defined(EDACAL_THREADED_DISPATCH)
+// Las direcciones de etiquetas (&&etiqueta) son una extension de GNU.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define VM_DISPATCH() goto* kLabels[ip->op]
+#define VM_CASE(name) op_##name:
+#define VM_NEXT()                                                                                                \
+    ++ip;                                                                                                        \
+    VM_DISPATCH()
+#else
+#define VM_CASE(name) case name:
+#define VM_NEXT()                                                                                                \
+    ++ip;                                                                                                        \
+    break
+#endif
+
+bool RegisterVM::run(double* v) const {
+    const Instruction* ip = code_.data();
+#if defined(EDACAL_THREADED_DISPATCH)
+    // En el mismo orden que Opcode.
+    static const void* const kLabels[] = {&&op_ADD,   &&op_SUB,   &&op_MUL, &&op_DIV,    &&op_POW,
+                                          &&op_POWI,  &&op_SQUARE, &&op_NEG, &&op_CALL1,  &&op_CALL2,
+                                          &&op_LT,    &&op_LE,    &&op_GT,  &&op_GE,     &&op_EQ,
+                                          &&op_SELECT, &&op_HALT};
+    VM_DISPATCH();
+#else
+    for (;;) {
+        switch (ip->op) {
+#endif
+    VM_CASE(ADD) {
+        v[ip->dst] = v[ip->a] + v[ip->b];
+        VM_NEXT();
+    }
+    VM_CASE(SUB) {
+        v[ip->dst] = v[ip->a] - v[ip->b];
+        VM_NEXT();
+    }
+    VM_CASE(MUL) {
+        v[ip->dst] = v[ip->a] * v[ip->b];
+        VM_NEXT();
+    }
+    VM_CASE(DIV) {
+        if (v[ip->b] == 0.0) {
+            return false;
+        }
+        v[ip->dst] = v[ip->a] / v[ip->b];
+        VM_NEXT();
+    }
+    VM_CASE(POW) {
+        v[ip->dst] = std::pow(v[ip->a], v[ip->b]);
+        VM_NEXT();
+    }
+    VM_CASE(POWI) {
+        v[ip->dst] = vecmath::powi(v[ip->a], ip->exponent);
+        VM_NEXT();
+    }
+    VM_CASE(SQUARE) {
+        // vecmath::powi(x, 2) calcula 1.0 * (x * x), que es exactamente x * x.
+        v[ip->dst] = v[ip->a] * v[ip->a];
+        VM_NEXT();
+    }
+    VM_CASE(NEG) {
+        v[ip->dst] = -v[ip->a];
+        VM_NEXT();
+    }
+    VM_CASE(CALL1) {
+        const Function* fn = ip->function;
+        double args[1] = {v[ip->a]};
+        if (fn->domain && !fn->domain(args)) {
+            return false;
+        }
+        v[ip->dst] = fn->impl(args);
+        VM_NEXT();
+    }
+    VM_CASE(CALL2) {
+        const Function* fn = ip->function;
+        double args[2] = {v[ip->a], v[ip->b]};
+        if (fn->domain && !fn->domain(args)) {
+            return false;
+        }
+        v[ip->dst] = fn->impl(args);
+        VM_NEXT();
+    }
+    VM_CASE(LT) {
+        v[ip->dst] = v[ip->a] < v[ip->b] ? 1.0 : 0.0;
+        VM_NEXT();
+    }
+    VM_CASE(LE) {
+        v[ip->dst] = v[ip->a] <= v[ip->b] ? 1.0 : 0.0;
+        VM_NEXT();
+    }
+    VM_CASE(GT) {
+        v[ip->dst] = v[ip->a] > v[ip->b] ? 1.0 : 0.0;
+        VM_NEXT();
+    }
+    VM_CASE(GE) {
+        v[ip->dst] = v[ip->a] >= v[ip->b] ? 1.0 : 0.0;
+        VM_NEXT();
+    }
+    VM_CASE(EQ) {
+        v[ip->dst] = v[ip->a] == v[ip->b] ? 1.0 : 0.0;
+        VM_NEXT();
+    }
+    VM_CASE(SELECT) {
+        // Las dos ramas ya estan calculadas: el compilador lo baja a cmov.
+        v[ip->dst] = v[ip->a] != 0.0 ? v[ip->b] : v[ip->c];
+        VM_NEXT();
+    }
+    VM_CASE(HALT) {
+        return true;
+    }
+#if !defined(EDACAL_THREADED_DISPATCH)
+        }
+    }
+#endif
+}
+
+#undef VM_CASE
+#undef VM_NEXT
+#if defined(EDACAL_THREADED_DISPATCH)
+#undef VM_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace edacal
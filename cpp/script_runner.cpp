@@ -0,0 +1,198 @@
+#include "script_runner.hpp"
+
+#include "bounded_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace edacal {
+
+namespace {
+
+// Tamano de los bloques de salida que el evaluador pasa al escritor; un
+// bloque se entrega antes si el evaluador tiene que esperar.
+const std::size_t kOutputBlock = 1 << 12;
+
+struct SourceLine {
+    std::size_t seq;
+    std::string text;
+};
+
+// Celda del buffer de reorden. `sequence` vale seq mientras espera la
+// linea seq y seq + 1 cuando esta compilada; el evaluador la libera para
+// seq + kWindow al aplicarla.
+struct Slot {
+    std::atomic<std::size_t> sequence;
+    Session::CompiledLine line;
+    std::exception_ptr failure;
+};
+
+} // namespace
+
+struct ScriptRunner::Pipeline {
+    Pipeline() : lines(kWindow), slots(kWindow), output(64), total(0), readerDone(false), evaluatorDone(false),
+                 stop(false) {
+        for (std::size_t i = 0; i < kWindow; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue<SourceLine> lines;
+    std::vector<Slot> slots;
+    BoundedQueue<std::string> output;
+    std::atomic<std::size_t> total;
+    std::atomic<bool> readerDone;
+    std::atomic<bool> evaluatorDone;
+    std::atomic<bool> stop;
+};
+
+ScriptRunner::ScriptRunner(Session& session, std::size_t workers) : session_(session), workers_(workers) {
+    if (workers_ == 0) {
+        workers_ = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+}
+
+bool ScriptRunner::run(std::istream& in, std::ostream& out) {
+    Pipeline pipeline;
+    std::thread reader(&ScriptRunner::readLines, std::ref(pipeline), std::ref(in));
+    std::vector<std::thread> compilers;
+    for (std::size_t i = 0; i < workers_; ++i) {
+        compilers.push_back(std::thread(&ScriptRunner::compileLines, std::ref(pipeline), std::cref(session_)));
+    }
+    std::thread writer(&ScriptRunner::writeOutput, std::ref(pipeline), std::ref(out));
+
+    std::ostringstream buffer;
+    auto flush = [&] {
+        std::string block = buffer.str();
+        if (block.empty()) {
+            return;
+        }
+        while (!pipeline.output.try_push(std::move(block))) {
+            std::this_thread::yield();
+        }
+        buffer.str(std::string());
+    };
+
+    bool keepGoing = true;
+    std::exception_ptr failure;
+    for (std::size_t seq = 0;; ++seq) {
+        Slot& slot = pipeline.slots[seq % kWindow];
+        bool finished = false;
+        while (slot.sequence.load(std::memory_order_acquire) != seq + 1) {
+            if (pipeline.readerDone.load(std::memory_order_acquire) &&
+                pipeline.total.load(std::memory_order_relaxed) == seq) {
+                finished = true;
+                break;
+            }
+            flush();
+            std::this_thread::yield();
+        }
+        // Cada linea, y el final de la entrada, van precedidos del prompt
+        // como en el bucle del REPL.
+        buffer << ">> ";
+        if (finished) {
+            break;
+        }
+        if (slot.failure) {
+            failure = slot.failure;
+            break;
+        }
+        try {
+            keepGoing = session_.apply(slot.line, buffer);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        slot.line = Session::CompiledLine();
+        slot.sequence.store(seq + kWindow, std::memory_order_release);
+        if (!keepGoing || failure) {
+            break;
+        }
+        if (static_cast<std::size_t>(buffer.tellp()) >= kOutputBlock) {
+            flush();
+        }
+    }
+    flush();
+
+    pipeline.stop.store(true, std::memory_order_release);
+    pipeline.evaluatorDone.store(true, std::memory_order_release);
+    reader.join();
+    for (std::thread& compiler : compilers) {
+        compiler.join();
+    }
+    writer.join();
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    return keepGoing;
+}
+
+void ScriptRunner::readLines(Pipeline& pipeline, std::istream& in) {
+    std::size_t seq = 0;
+    std::string text;
+    while (!pipeline.stop.load(std::memory_order_acquire) && std::getline(in, text)) {
+        SourceLine line = {seq, std::move(text)};
+        while (!pipeline.lines.try_push(std::move(line))) {
+            if (pipeline.stop.load(std::memory_order_acquire)) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        ++seq;
+    }
+    pipeline.total.store(seq, std::memory_order_relaxed);
+    pipeline.readerDone.store(true, std::memory_order_release);
+}
+
+void ScriptRunner::compileLines(Pipeline& pipeline, const Session& session) {
+    SourceLine line;
+    for (;;) {
+        bool readerDone = pipeline.readerDone.load(std::memory_order_acquire);
+        if (!pipeline.lines.try_pop(line)) {
+            if (readerDone || pipeline.stop.load(std::memory_order_acquire)) {
+                return;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        Slot& slot = pipeline.slots[line.seq % kWindow];
+        while (slot.sequence.load(std::memory_order_acquire) != line.seq) {
+            if (pipeline.stop.load(std::memory_order_acquire)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        try {
+            slot.line = session.compile(line.text);
+        } catch (...) {
+            slot.failure = std::current_exception();
+        }
+        slot.sequence.store(line.seq + 1, std::memory_order_release);
+    }
+}
+
+void ScriptRunner::writeOutput(Pipeline& pipeline, std::ostream& out) {
+    std::string block;
+    for (;;) {
+        bool evaluatorDone = pipeline.evaluatorDone.load(std::memory_order_acquire);
+        if (pipeline.output.try_pop(block)) {
+            out << block;
+            continue;
+        }
+        if (evaluatorDone) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    out.flush();
+}
+
+} // namespace edacal
@@ -0,0 +1,256 @@
+#include "server.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace edacal {
+
+namespace {
+
+const int kMaxEvents = 64;
+const std::size_t kReadChunk = 4096;
+const char* const kWelcome = "Bienvenido a EdaCal\n>> ";
+const char* const kPrompt = ">> ";
+
+void setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+EdaError systemError(const std::string& what) {
+    return EdaError(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+struct Server::Connection {
+    int fd;
+    Session session;
+    std::string input;
+    std::string output;
+    bool closing;
+
+    // Sin save/load: un cliente no elige archivos del usuario del servidor.
+    Connection(int socket, SharedSymbols* shared) : fd(socket), session(shared, false), closing(false) {}
+};
+
+Server::Server(const std::string& socketPath, std::size_t threads)
+    : path_(socketPath), threads_(threads ? threads : 1), listenFd_(-1), epollFd_(-1), wakeFd_(-1), stopping_(false) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        throw EdaError("ruta de socket demasiado larga: " + path_);
+    }
+    std::memcpy(addr.sun_path, path_.c_str(), path_.size() + 1);
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        throw systemError("no se pudo crear el socket");
+    }
+    ::unlink(path_.c_str());
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listenFd_, SOMAXCONN) != 0) {
+        EdaError err = systemError("no se pudo escuchar en " + path_);
+        ::close(listenFd_);
+        throw err;
+    }
+    setNonBlocking(listenFd_);
+
+    epollFd_ = ::epoll_create1(0);
+    wakeFd_ = ::eventfd(0, EFD_NONBLOCK);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        EdaError err = systemError("no se pudo crear epoll");
+        ::close(listenFd_);
+        ::unlink(path_.c_str());
+        throw err;
+    }
+
+    epoll_event listenEvent;
+    listenEvent.events = EPOLLIN | EPOLLONESHOT;
+    listenEvent.data.ptr = nullptr;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &listenEvent);
+
+    epoll_event wakeEvent;
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.ptr = &wakeFd_;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent);
+}
+
+Server::~Server() {
+    for (Connection* conn : connections_) {
+        ::close(conn->fd);
+        delete conn;
+    }
+    ::close(wakeFd_);
+    ::close(epollFd_);
+    ::close(listenFd_);
+    ::unlink(path_.c_str());
+}
+
+void Server::run() {
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads_; ++i) {
+        workers.push_back(std::thread(&Server::workerLoop, this));
+    }
+    workerLoop();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void Server::stop() {
+    stopping_ = true;
+    std::uint64_t one = 1;
+    ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void Server::workerLoop() {
+    epoll_event events[kMaxEvents];
+    while (!stopping_) {
+        int ready = ::epoll_wait(epollFd_, events, kMaxEvents, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            void* data = events[i].data.ptr;
+            if (data == &wakeFd_) {
+                continue;
+            }
+            if (data == nullptr) {
+                acceptClients();
+                continue;
+            }
+            serviceClient(static_cast<Connection*>(data), events[i].events);
+        }
+    }
+}
+
+void Server::acceptClients() {
+    while (true) {
+        int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            break;
+        }
+        setNonBlocking(fd);
+        Connection* conn = new Connection(fd, &shared_);
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            connections_.insert(conn);
+        }
+        conn->output = kWelcome;
+        flush(conn);
+
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLONESHOT | (conn->output.empty() ? 0u : static_cast<std::uint32_t>(EPOLLOUT));
+        event.data.ptr = conn;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            closeClient(conn);
+        }
+    }
+    rearm(listenFd_, nullptr, EPOLLIN);
+}
+
+void Server::serviceClient(Connection* conn, std::uint32_t events) {
+    bool broken = (events & EPOLLERR) != 0;
+    bool endOfInput = false;
+
+    if (events & (EPOLLIN | EPOLLHUP)) {
+        char buffer[kReadChunk];
+        while (true) {
+            ssize_t received = ::recv(conn->fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                conn->input.append(buffer, static_cast<std::size_t>(received));
+            } else if (received == 0) {
+                endOfInput = true;
+                break;
+            } else if (errno != EINTR) {
+                broken = errno != EAGAIN && errno != EWOULDBLOCK;
+                break;
+            }
+        }
+
+        std::size_t start = 0;
+        std::size_t newline;
+        std::ostringstream response;
+        while (!conn->closing && (newline = conn->input.find('\n', start)) != std::string::npos) {
+            std::string line = conn->input.substr(start, newline - start);
+            start = newline + 1;
+            if (conn->session.handleLine(line, response)) {
+                response << kPrompt;
+            } else {
+                conn->closing = true;
+            }
+        }
+        conn->input.erase(0, start);
+        if (endOfInput) {
+            if (!conn->closing && !conn->input.empty()) {
+                conn->session.handleLine(conn->input, response);
+            }
+            conn->closing = true;
+        }
+        conn->output += response.str();
+    }
+
+    if (!flush(conn) || broken || (conn->closing && conn->output.empty())) {
+        closeClient(conn);
+        return;
+    }
+    std::uint32_t interest = conn->closing ? 0u : static_cast<std::uint32_t>(EPOLLIN);
+    if (!conn->output.empty()) {
+        interest |= EPOLLOUT;
+    }
+    rearm(conn->fd, conn, interest);
+}
+
+// Envia lo que se pueda sin bloquear; devuelve false si la conexion fallo.
+bool Server::flush(Connection* conn) {
+    while (!conn->output.empty()) {
+        ssize_t sent = ::send(conn->fd, conn->output.data(), conn->output.size(), MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn->output.erase(0, static_cast<std::size_t>(sent));
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        conn->output.clear();
+        return false;
+    }
+    return true;
+}
+
+void Server::rearm(int fd, void* data, std::uint32_t events) {
+    epoll_event event;
+    event.events = events | EPOLLONESHOT;
+    event.data.ptr = data;
+    ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &event);
+}
+
+void Server::closeClient(Connection* conn) {
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        connections_.erase(conn);
+    }
+    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+    ::close(conn->fd);
+    delete conn;
+}
+
+} // namespace edacal
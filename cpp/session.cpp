@@ -0,0 +1,598 @@
+#include "session.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+namespace edacal {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    std::size_t start = 0;
+    while (start < text.size() && std::isspace(static_cast<unsigned char>(text[start]))) {
+        ++start;
+    }
+    std::size_t end = text.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    return text.substr(start, end - start);
+}
+
+// Mensaje de un error de la expresion. Si el Error senala un fragmento de la
+// linea se agrega su columna (desde 0, contando los espacios iniciales que
+// `trim` quito).
+std::string describeError(const EdaError& err, std::size_t indent) {
+    const Error& error = err.error();
+    if (error.length == 0) {
+        return err.what();
+    }
+    return std::string(err.what()) + " (columna " + std::to_string(error.column + indent) + ")";
+}
+
+// El racional del decimal mas corto que vuelve a dar `value` (0.1 da 1/10,
+// no el valor binario exacto del double).
+Rational decimalRational(double value) {
+    char buffer[32];
+    for (int digits = 1; digits <= 17; ++digits) {
+        std::snprintf(buffer, sizeof(buffer), "%.*e", digits - 1, value);
+        if (std::strtod(buffer, nullptr) == value) {
+            break;
+        }
+    }
+    std::string text(buffer);
+    bool negative = text[0] == '-';
+    std::size_t exponentAt = text.find('e');
+    long exponent = std::strtol(text.c_str() + exponentAt + 1, nullptr, 10);
+    std::string mantissa = text.substr(negative ? 1 : 0, exponentAt - (negative ? 1 : 0));
+    std::string digits;
+    for (char c : mantissa) {
+        if (c != '.') {
+            digits += c;
+        }
+    }
+    Rational result = Rational(BigInt::parse(digits), BigInt(1)) *
+                      Rational(10).pow(exponent - static_cast<long>(digits.size() - 1));
+    return negative ? -result : result;
+}
+
+template <typename T>
+std::uint64_t latestVersion(const BasicSymbolTable<T>& symbols) {
+    std::uint64_t latest = 0;
+    T value;
+    std::uint64_t version = 0;
+    for (const auto& entry : symbols) {
+        if (symbols.find(entry.first, value, version) && version > latest) {
+            latest = version;
+        }
+    }
+    return latest;
+}
+
+} // namespace
+
+Session::Session()
+    : shared_(nullptr), files_(true), hasLast_(false), treeBuilt_(false), memo_(false), memoTotals_{0, 0, 0},
+      reassociate_(false), exact_(false), doubleSynced_(0), exactSynced_(0) {}
+
+Session::Session(SharedSymbols* shared, bool files)
+    : shared_(shared), files_(files), symbols_(shared), hasLast_(false), treeBuilt_(false), memo_(false),
+      memoTotals_{0, 0, 0}, reassociate_(false), exact_(false), exactSymbols_(shared), doubleSynced_(0),
+      exactSynced_(0) {}
+
+void Session::loadSnapshot(const std::string& path) {
+    formulas_.load(path, symbols_);
+    if (formulas_.hasLast()) {
+        setLast(formulas_.last());
+    }
+}
+
+const Tree& Session::lastTree() {
+    if (!treeBuilt_) {
+        lastTree_ = parser_.buildTreeFromPostfix(lastPostfix_);
+        treeBuilt_ = true;
+    }
+    return lastTree_;
+}
+
+void Session::setLast(TokenList&& postfix) {
+    lastPostfix_ = std::move(postfix);
+    hasLast_ = true;
+    lastTree_.clear();
+    treeBuilt_ = false;
+}
+
+// Los valores no finitos (inf, nan) no tienen racional y no se copian.
+void Session::syncToExact() {
+    for (const auto& entry : symbols_) {
+        double value = 0.0;
+        std::uint64_t version = 0;
+        symbols_.find(entry.first, value, version);
+        if (version > doubleSynced_ && std::isfinite(value)) {
+            exactSymbols_.set(entry.first, decimalRational(value));
+        }
+    }
+    doubleSynced_ = latestVersion(symbols_);
+    exactSynced_ = latestVersion(exactSymbols_);
+}
+
+void Session::syncToDouble() {
+    for (const auto& entry : exactSymbols_) {
+        Rational value;
+        std::uint64_t version = 0;
+        exactSymbols_.find(entry.first, value, version);
+        if (version > exactSynced_) {
+            symbols_.set(entry.first, value.toDouble());
+        }
+    }
+    doubleSynced_ = latestVersion(symbols_);
+    exactSynced_ = latestVersion(exactSymbols_);
+}
+
+// `bounds x 0.1` fija la tolerancia absoluta de x; `bounds` evalua la ultima
+// expresion con cada variable en [valor - tol, valor + tol].
+void Session::handleBounds(std::istream& args, std::ostream& out) {
+    try {
+        std::string var;
+        if (args >> var) {
+            double tolerance;
+            if (!(args >> tolerance) || !(tolerance >= 0.0) || std::isinf(tolerance)) {
+                throw EdaError("tolerancia invalida");
+            }
+            symbols_.get(var);
+            tolerances_[var] = tolerance;
+            out << ">> " << var << " +- " << formatNumber(tolerance) << std::endl;
+            return;
+        }
+        if (!hasLast_) {
+            throw EdaError("no hay expresion evaluada");
+        }
+        IntervalEvaluator::Inputs inputs;
+        for (auto it = tolerances_.begin(); it != tolerances_.end(); ++it) {
+            if (symbols_.has(it->first)) {
+                double value = symbols_.get(it->first);
+                inputs[it->first] = Interval{value - it->second, value + it->second};
+            }
+        }
+        Interval result = intervals_.evalPostfix(lastPostfix_, symbols_, inputs);
+        std::ostringstream radius;
+        radius << result.radius();
+        out << ">> [" << formatNumber(result.lo) << ", " << formatNumber(result.hi) << "], radio "
+            << radius.str() << std::endl;
+    } catch (const EdaError& err) {
+        out << ">> error: " << err.what() << std::endl;
+    }
+}
+
+// `grad x y` da las parciales de la ultima expresion respecto a x e y (modo
+// inverso, un solo barrido); sin argumentos, respecto a todas sus variables.
+void Session::handleGrad(std::istream& args, std::ostream& out) {
+    try {
+        if (!hasLast_) {
+            throw EdaError("no hay expresion evaluada");
+        }
+        const Tree& tree = lastTree();
+        std::vector<std::string> variables;
+        std::string var;
+        while (args >> var) {
+            variables.push_back(var);
+        }
+        if (variables.empty()) {
+            variables = gradients_.variablesOf(tree);
+        }
+        if (variables.empty()) {
+            throw EdaError("la expresion no tiene variables");
+        }
+        GradientEvaluator::Result gradient = gradients_.evaluate(tree, symbols_, variables);
+        out << ">> ";
+        for (std::size_t i = 0; i < variables.size(); ++i) {
+            out << (i ? ", " : "") << "d/d" << variables[i] << " -> " << formatNumber(gradient.partials[i]);
+        }
+        out << std::endl;
+    } catch (const EdaError& err) {
+        out << ">> error: " << err.what() << std::endl;
+    }
+}
+
+// `deriv x` reemplaza la ultima expresion por su derivada simbolica respecto
+// a x (asi `tree`, `prefix`, `grad` o `bounds` trabajan sobre ella) y muestra
+// su valor con las variables actuales.
+void Session::handleDeriv(std::istream& args, std::ostream& out) {
+    try {
+        std::string var;
+        if (!(args >> var)) {
+            throw EdaError("falta nombre de variable");
+        }
+        if (!hasLast_) {
+            throw EdaError("no hay expresion evaluada");
+        }
+        Tree derivative = differentiator_.differentiate(lastTree(), var);
+        TokenList postfix = optimizer_.toPostfix(derivative);
+        double value = evaluator_.evalPostfix(postfix, symbols_);
+        setLast(std::move(postfix));
+        lastTree_ = std::move(derivative);
+        treeBuilt_ = true;
+        out << ">> d/d" << var << " -> " << formatNumber(value) << std::endl;
+    } catch (const EdaError& err) {
+        out << ">> error: " << err.what() << std::endl;
+    }
+}
+
+// `memo on|off` activa o desactiva la evaluacion incremental; `memo` sola
+// muestra cuantos nodos se tomaron de evaluaciones anteriores.
+void Session::handleMemo(std::istream& args, std::ostream& out) {
+    std::string mode;
+    if (args >> mode) {
+        if (mode != "on" && mode != "off") {
+            out << ">> error: se esperaba 'on' u 'off'" << std::endl;
+            return;
+        }
+        memo_ = mode == "on";
+        if (!memo_) {
+            clearMemos();
+        }
+        out << ">> memo " << mode << std::endl;
+        return;
+    }
+    MemoEvaluator::Stats totals = memoTotals_;
+    for (auto it = memos_.begin(); it != memos_.end(); ++it) {
+        totals.evaluations += it->second.stats().evaluations;
+        totals.reused += it->second.stats().reused;
+        totals.recomputed += it->second.stats().recomputed;
+    }
+    std::ostringstream rate;
+    rate << std::fixed << std::setprecision(1) << 100.0 * totals.hitRate();
+    out << ">> memo " << (memo_ ? "on" : "off") << ": " << memos_.size() << " formulas, "
+        << totals.evaluations << " evaluaciones, " << totals.reused << " nodos reutilizados, "
+        << totals.recomputed << " recalculados, aciertos " << rate.str() << "%" << std::endl;
+}
+
+// `reasoc on|off` activa o desactiva la reasociacion de cadenas de `+` y `*`
+// al compilar; `reasoc` sola muestra el estado.
+void Session::handleReassociate(std::istream& args, std::ostream& out) {
+    std::string mode;
+    if (args >> mode) {
+        if (mode != "on" && mode != "off") {
+            out << ">> error: se esperaba 'on' u 'off'" << std::endl;
+            return;
+        }
+        bool reassociate = mode == "on";
+        if (reassociate != reassociate_.load(std::memory_order_relaxed)) {
+            // Los arboles memorizados se armaron con el otro valor.
+            clearMemos();
+            reassociate_.store(reassociate, std::memory_order_relaxed);
+        }
+    }
+    out << ">> reasoc " << (reassociate_.load(std::memory_order_relaxed) ? "on" : "off") << std::endl;
+}
+
+// La clave es la posfija como se escribio: las constantes plegadas se
+// imprimen redondeadas y dos expresiones distintas podrian coincidir.
+double Session::evaluateMemo(const TokenList& postfix, const TokenList& optimized) {
+    std::string key;
+    for (const Token& token : postfix) {
+        if (token.type == TokenType::END) {
+            break;
+        }
+        key += token.lexeme;
+        key += ' ';
+    }
+    auto it = memos_.find(key);
+    if (it == memos_.end()) {
+        Tree tree;
+        try {
+            tree = parser_.buildTreeFromPostfix(optimized);
+        } catch (const EdaError&) {
+            // sum/prod no tienen arbol: se evaluan sin memo.
+            return evaluator_.evalPostfix(optimized, symbols_);
+        }
+        if (memos_.size() >= kMaxMemos) {
+            clearMemos();
+        }
+        it = memos_.insert(std::make_pair(key, MemoEvaluator(tree))).first;
+    }
+    return it->second.evaluate(symbols_);
+}
+
+// Descarta los arboles guardados conservando sus contadores.
+void Session::clearMemos() {
+    for (auto it = memos_.begin(); it != memos_.end(); ++it) {
+        memoTotals_.evaluations += it->second.stats().evaluations;
+        memoTotals_.reused += it->second.stats().reused;
+        memoTotals_.recomputed += it->second.stats().recomputed;
+    }
+    memos_.clear();
+}
+
+bool Session::handleLine(const std::string& line, std::ostream& out) {
+    CompiledLine compiled = compile(line);
+    return apply(compiled, out);
+}
+
+Session::CompiledLine Session::compile(const std::string& line) const {
+    CompiledLine compiled;
+    compiled.kind = CompiledLine::Kind::EMPTY;
+    compiled.indent = 0;
+    compiled.reassociated = false;
+    std::string trimmed = trim(line);
+    if (trimmed.empty()) {
+        return compiled;
+    }
+    compiled.indent = line.find(trimmed[0]);
+
+    std::istringstream iss(trimmed);
+    std::string command;
+    iss >> command;
+    // `save = 3` asigna a la variable save: una palabra seguida de `=` nunca
+    // es un comando, asi que las asignaciones no quedan tapadas.
+    char next = '\0';
+    bool assigns = (iss >> next) && next == '=';
+    if (!assigns && isCommand(command)) {
+        compiled.kind = CompiledLine::Kind::COMMAND;
+        compiled.text = trimmed;
+        return compiled;
+    }
+
+    try {
+        TokenList tokens = tokenizer_.tokenize(trimmed);
+
+        auto it = tokens.begin();
+        if (it != tokens.end() && it->type == TokenType::IDENT) {
+            auto nextIt = it;
+            ++nextIt;
+            if (nextIt != tokens.end() && nextIt->type == TokenType::ASSIGN) {
+                compiled.target = it->lexeme;
+                tokens.pop_front(); // remove identifier
+                tokens.pop_front(); // remove assignment
+            }
+        }
+
+        bool hasContent = false;
+        for (auto checkIt = tokens.begin(); checkIt != tokens.end(); ++checkIt) {
+            if (checkIt->type != TokenType::END) {
+                hasContent = true;
+                break;
+            }
+        }
+        if (!hasContent) {
+            throw EdaError("expresion vacia");
+        }
+
+        bool hasEnd = false;
+        for (auto expIt = tokens.begin(); expIt != tokens.end(); ++expIt) {
+            if (expIt->type == TokenType::END) {
+                hasEnd = true;
+                break;
+            }
+        }
+        if (!hasEnd) {
+            tokens.push_back(Token(TokenType::END, ""));
+        }
+
+        compiled.postfix = parser_.toPostfix(tokens);
+        compiled.reassociated = reassociate_.load(std::memory_order_relaxed);
+        compiled.optimized = optimizer_.optimize(compiled.postfix, compiled.reassociated);
+        compiled.kind = CompiledLine::Kind::EXPRESSION;
+    } catch (const EdaError& err) {
+        compiled.kind = CompiledLine::Kind::ERROR;
+        compiled.text = describeError(err, compiled.indent);
+    }
+    return compiled;
+}
+
+bool Session::apply(CompiledLine& line, std::ostream& out) {
+    switch (line.kind) {
+        case CompiledLine::Kind::EMPTY:
+            return true;
+        case CompiledLine::Kind::COMMAND:
+            return handleCommand(line.text, out);
+        case CompiledLine::Kind::ERROR:
+            out << ">> error: " << line.text << std::endl;
+            return true;
+        case CompiledLine::Kind::EXPRESSION:
+            break;
+    }
+
+    bool isAssignment = !line.target.empty();
+    const std::string& targetVariable = line.target;
+    TokenList& postfix = line.postfix;
+    try {
+        bool reassociate = reassociate_.load(std::memory_order_relaxed);
+        if (!exact_ && line.reassociated != reassociate) {
+            line.optimized = optimizer_.optimize(postfix, reassociate);
+            line.reassociated = reassociate;
+        }
+        std::string text;
+        if (exact_) {
+            Rational result = exactEvaluator_.evalPostfix(postfix, exactSymbols_);
+            exactSymbols_.set("ans", result);
+            if (isAssignment) {
+                exactSymbols_.set(targetVariable, result);
+            }
+            text = result.toString();
+        } else {
+            double result = memo_ ? evaluateMemo(postfix, line.optimized)
+                                  : evaluator_.evalPostfix(line.optimized, symbols_);
+            symbols_.set("ans", result);
+            if (isAssignment) {
+                symbols_.set(targetVariable, result);
+            }
+            text = formatNumber(result);
+        }
+
+        if (isAssignment) {
+            formulas_.define(targetVariable, postfix);
+            out << ">> " << targetVariable << " -> " << text << std::endl;
+        } else {
+            out << ">> ans -> " << text << std::endl;
+        }
+
+        setLast(std::move(postfix));
+    } catch (const EdaError& err) {
+        out << ">> error: " << describeError(err, line.indent) << std::endl;
+    }
+
+    return true;
+}
+
+bool Session::isCommand(const std::string& word) {
+    static const char* const commands[] = {"exit",   "show",    "global", "modo", "deriv", "grad",
+                                           "bounds", "save",    "load",   "tree", "posfix", "postfix",
+                                           "prefix", "memo",    "reasoc", "formula"};
+    for (const char* command : commands) {
+        if (word == command) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Session::handleCommand(const std::string& trimmed, std::ostream& out) {
+    std::istringstream iss(trimmed);
+    std::string command;
+    iss >> command;
+
+    if (command == "exit") {
+        return false;
+    } else if (command == "show") {
+        std::string var;
+        if (!(iss >> var)) {
+            out << ">> error: falta nombre de variable" << std::endl;
+            return true;
+        }
+        try {
+            std::string value = exact_ ? exactSymbols_.get(var).toString() : formatNumber(symbols_.get(var));
+            out << ">> " << var << " -> " << value << std::endl;
+        } catch (const EdaError& err) {
+            out << ">> error: " << err.what() << std::endl;
+        }
+        return true;
+    } else if (command == "formula") {
+        std::string var;
+        if (!(iss >> var)) {
+            out << ">> error: falta nombre de variable" << std::endl;
+            return true;
+        }
+        try {
+            TokenList postfix = formulas_.get(var);
+            out << ">> " << var << " = ";
+            printer_.printPostfix(postfix, out);
+        } catch (const EdaError& err) {
+            out << ">> error: " << err.what() << std::endl;
+        }
+        return true;
+    } else if (command == "global") {
+        std::string var;
+        if (!(iss >> var)) {
+            out << ">> error: falta nombre de variable" << std::endl;
+            return true;
+        }
+        try {
+            if (!shared_) {
+                throw EdaError("no hay variables compartidas en esta sesion");
+            }
+            double value = symbols_.get(var);
+            shared_->set(var, value);
+            out << ">> global " << var << " -> " << formatNumber(value) << std::endl;
+        } catch (const EdaError& err) {
+            out << ">> error: " << err.what() << std::endl;
+        }
+        return true;
+    } else if (command == "modo") {
+        std::string mode;
+        if (!(iss >> mode)) {
+            out << ">> error: falta nombre de modo" << std::endl;
+        } else if (mode == "racional" || mode == "double") {
+            bool exact = mode == "racional";
+            if (exact && !exact_) {
+                syncToExact();
+            } else if (!exact && exact_) {
+                syncToDouble();
+            }
+            exact_ = exact;
+            out << ">> modo " << mode << std::endl;
+        } else {
+            out << ">> error: modo desconocido: " << mode << std::endl;
+        }
+        return true;
+    } else if (command == "deriv") {
+        handleDeriv(iss, out);
+        return true;
+    } else if (command == "grad") {
+        handleGrad(iss, out);
+        return true;
+    } else if (command == "bounds") {
+        handleBounds(iss, out);
+        return true;
+    } else if (command == "memo") {
+        handleMemo(iss, out);
+        return true;
+    } else if (command == "reasoc") {
+        handleReassociate(iss, out);
+        return true;
+    } else if (command == "save" || command == "load") {
+        std::string path;
+        if (!files_) {
+            out << ">> error: " << command << " no esta disponible en esta sesion" << std::endl;
+            return true;
+        }
+        if (!(iss >> path)) {
+            out << ">> error: falta nombre de archivo" << std::endl;
+            return true;
+        }
+        try {
+            if (command == "save") {
+                if (hasLast_) {
+                    formulas_.setLast(lastPostfix_);
+                }
+                formulas_.save(path, symbols_);
+                out << ">> snapshot guardado: " << path << std::endl;
+            } else {
+                loadSnapshot(path);
+                out << ">> snapshot cargado: " << path << std::endl;
+            }
+        } catch (const EdaError& err) {
+            out << ">> error: " << err.what() << std::endl;
+        }
+        return true;
+    } else if (command == "tree") {
+        if (!hasLast_) {
+            out << ">> error: no hay expresion evaluada" << std::endl;
+        } else {
+            try {
+                printer_.printTree(lastTree(), out);
+            } catch (const EdaError& err) {
+                out << ">> error: " << err.what() << std::endl;
+            }
+        }
+        return true;
+    } else if (command == "posfix" || command == "postfix") {
+        if (!hasLast_) {
+            out << ">> error: no hay expresion evaluada" << std::endl;
+        } else {
+            printer_.printPostfix(lastPostfix_, out);
+        }
+        return true;
+    } else if (command == "prefix") {
+        if (!hasLast_) {
+            out << ">> error: no hay expresion evaluada" << std::endl;
+        } else {
+            try {
+                printer_.printPrefix(lastTree(), out);
+            } catch (const EdaError& err) {
+                out << ">> error: " << err.what() << std::endl;
+            }
+        }
+        return true;
+    }
+
+    return true;
+}
+
+} // namespace edacal
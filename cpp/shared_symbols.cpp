@@ -0,0 +1,109 @@
+#include "shared_symbols.hpp"
+
+#include <cstring>
+#include <functional>
+
+namespace edacal {
+
+namespace {
+
+const std::size_t kInitialCapacity = 64;
+
+std::uint64_t toBits(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+SharedSymbols::SharedSymbols() : table_(makeTable(kInitialCapacity)), count_(0) {}
+
+SharedSymbols::~SharedSymbols() {
+    retired_.push_back(table_.load());
+    for (Table* table : retired_) {
+        delete[] table->slots;
+        delete table;
+    }
+}
+
+SharedSymbols::Table* SharedSymbols::makeTable(std::size_t capacity) {
+    Table* table = new Table;
+    table->mask = capacity - 1;
+    table->slots = new Slot[capacity];
+    for (std::size_t i = 0; i < capacity; ++i) {
+        table->slots[i].name.store(nullptr, std::memory_order_relaxed);
+        table->slots[i].bits.store(0, std::memory_order_relaxed);
+    }
+    return table;
+}
+
+// Devuelve el slot con ese nombre o el primer slot libre de su secuencia.
+SharedSymbols::Slot* SharedSymbols::probe(const Table* table, const std::string& name,
+                                          const std::string*& current) {
+    std::size_t index = std::hash<std::string>()(name) & table->mask;
+    while (true) {
+        Slot* slot = &table->slots[index];
+        current = slot->name.load(std::memory_order_acquire);
+        if (current == nullptr || *current == name) {
+            return slot;
+        }
+        index = (index + 1) & table->mask;
+    }
+}
+
+bool SharedSymbols::lookup(const std::string& name, double& value) const {
+    const Table* table = table_.load(std::memory_order_acquire);
+    const std::string* current;
+    const Slot* slot = probe(table, name, current);
+    if (current == nullptr) {
+        return false;
+    }
+    value = fromBits(slot->bits.load(std::memory_order_acquire));
+    return true;
+}
+
+void SharedSymbols::set(const std::string& name, double value) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    Table* table = table_.load(std::memory_order_relaxed);
+    const std::string* current;
+    Slot* slot = probe(table, name, current);
+    if (current != nullptr) {
+        slot->bits.store(toBits(value), std::memory_order_release);
+        return;
+    }
+
+    std::size_t count = count_.load(std::memory_order_relaxed) + 1;
+    if (2 * count > table->mask + 1) {
+        Table* grown = makeTable(2 * (table->mask + 1));
+        for (std::size_t i = 0; i <= table->mask; ++i) {
+            const std::string* existing = table->slots[i].name.load(std::memory_order_relaxed);
+            if (existing != nullptr) {
+                Slot* target = probe(grown, *existing, current);
+                target->bits.store(table->slots[i].bits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                target->name.store(existing, std::memory_order_relaxed);
+            }
+        }
+        table_.store(grown, std::memory_order_release);
+        retired_.push_back(table);
+        table = grown;
+        slot = probe(table, name, current);
+    }
+
+    names_.push_back(name);
+    slot->bits.store(toBits(value), std::memory_order_relaxed);
+    slot->name.store(&names_.back(), std::memory_order_release);
+    count_.store(count, std::memory_order_relaxed);
+}
+
+std::size_t SharedSymbols::size() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+} // namespace edacal
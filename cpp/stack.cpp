@@ -2,10 +2,14 @@
 #include "token.hpp"
 #include "tree.hpp"
 
+#include <cstddef>
+
 namespace edacal {
 
 template class Stack<Token>;
 template class Stack<Tree::Node*>;
 template class Stack<double>;
+template class Stack<bool>;
+template class Stack<std::size_t>;
 
 } // namespace edacal
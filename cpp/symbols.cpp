@@ -1,25 +1,80 @@
 #include "symbols.hpp"
 
+#include "numeric.hpp"
+#include "rational.hpp"
+#include "shared_symbols.hpp"
+
 namespace edacal {
 
-SymbolTable::SymbolTable() {
-    symbols_["ans"] = 0.0;
+template <typename T>
+BasicSymbolTable<T>::BasicSymbolTable() : clock_(0), shared_(nullptr) {
+    set("ans", T());
+}
+
+template <typename T>
+BasicSymbolTable<T>::BasicSymbolTable(const SharedSymbols* shared) : clock_(0), shared_(shared) {
+    set("ans", T());
+}
+
+template <typename T>
+bool BasicSymbolTable<T>::has(const std::string& name) const {
+    double value;
+    return symbols_.find(name) != symbols_.end() || (shared_ && shared_->lookup(name, value));
 }
 
-bool SymbolTable::has(const std::string& name) const {
-    return symbols_.find(name) != symbols_.end();
+template <typename T>
+T BasicSymbolTable<T>::get(const std::string& name) const {
+    T value;
+    if (!find(name, value)) {
+        throw EdaError(Error(ErrorKind::UNDEFINED_VARIABLE, 0, name.size(), name));
+    }
+    return value;
 }
 
-double SymbolTable::get(const std::string& name) const {
+template <typename T>
+bool BasicSymbolTable<T>::find(const std::string& name, T& value) const {
     auto it = symbols_.find(name);
     if (it == symbols_.end()) {
-        throw EdaError("variable no definida: " + name);
+        double shared;
+        if (shared_ && shared_->lookup(name, shared)) {
+            value = NumericTraits<T>::fromDouble(shared);
+            return true;
+        }
+        return false;
     }
-    return it->second;
+    value = it->second;
+    return true;
+}
+
+template <typename T>
+bool BasicSymbolTable<T>::find(const std::string& name, T& value, std::uint64_t& version) const {
+    auto it = versions_.find(name);
+    version = it == versions_.end() ? 0 : it->second;
+    return find(name, value);
 }
 
-void SymbolTable::set(const std::string& name, double value) {
+template <typename T>
+void BasicSymbolTable<T>::set(const std::string& name, const T& value) {
     symbols_[name] = value;
+    versions_[name] = ++clock_;
 }
 
+template <typename T>
+std::size_t BasicSymbolTable<T>::size() const {
+    return symbols_.size();
+}
+
+template <typename T>
+typename BasicSymbolTable<T>::const_iterator BasicSymbolTable<T>::begin() const {
+    return symbols_.begin();
+}
+
+template <typename T>
+typename BasicSymbolTable<T>::const_iterator BasicSymbolTable<T>::end() const {
+    return symbols_.end();
+}
+
+template class BasicSymbolTable<double>;
+template class BasicSymbolTable<Rational>;
+
 } // namespace edacal
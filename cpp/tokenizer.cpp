@@ -1,108 +1,193 @@
 #include "tokenizer.hpp"
 
-#include <cctype>
-#include <stdexcept>
+#include "char_scan.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
 
 namespace edacal {
 
-LinkedList<Token> Tokenizer::tokenize(const std::string& input) const {
-    LinkedList<Token> tokens;
+namespace {
+
+void push(TokenList& tokens, Token token, std::size_t column) {
+    token.column = column;
+    tokens.push_back(std::move(token));
+}
+
+// Camino rapido de Clinger para literales cortos: con a lo sumo 15 cifras
+// significativas la mantisa entera es exacta en double, y con a lo sumo 22
+// decimales tambien 10^k, asi que una sola division redondeada da el mismo
+// double que strtod. Devuelve false si hay que llamar a strtod.
+bool parseShortDecimal(const char* text, std::size_t length, double& value) {
+    static const double kPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                          1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                          1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (length > 16) {
+        return false;
+    }
+    std::uint64_t mantissa = 0;
+    std::size_t digits = 0;
+    std::size_t decimals = 0;
+    bool afterDot = false;
+    for (std::size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        if (c == '.') {
+            afterDot = true;
+            continue;
+        }
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(c - '0');
+        ++digits;
+        decimals += afterDot;
+    }
+    if (digits == 0 || digits > 15) {
+        return false;
+    }
+    value = static_cast<double>(mantissa) / kPowersOfTen[decimals];
+    return true;
+}
+
+} // namespace
+
+Tokenizer::Tokenizer() : functions_(&FunctionRegistry::builtins()) {}
+
+Tokenizer::Tokenizer(const FunctionRegistry& functions) : functions_(&functions) {}
+
+TokenList Tokenizer::tokenize(const std::string& input) const {
+    TokenList tokens;
+    Error error;
+    if (!tokenize(input, tokens, error)) {
+        throw EdaError(error);
+    }
+    return tokens;
+}
+
+// Las clases de caracteres salen de la tabla de char_scan.hpp y las
+// corridas de espacios y de digitos se saltan por bloques (SSE2/AVX2).
+bool Tokenizer::tokenize(const std::string& input, TokenList& tokens, Error& error) const {
+    const char* text = input.data();
+    const std::size_t size = input.size();
     std::size_t i = 0;
 
-    while (i < input.size()) {
-        char c = input[i];
-        if (std::isspace(static_cast<unsigned char>(c))) {
-            ++i;
+    while (i < size) {
+        char c = text[i];
+        if (scan::isSpace(c)) {
+            i = scan::skipSpaces(text, i + 1, size);
             continue;
         }
 
-        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+        if (scan::isDigit(c) || c == '.') {
             std::size_t start = i;
-            bool dotSeen = (c == '.');
-            ++i;
-            while (i < input.size()) {
-                char nc = input[i];
-                if (std::isdigit(static_cast<unsigned char>(nc))) {
-                    ++i;
-                } else if (nc == '.' && !dotSeen) {
-                    dotSeen = true;
-                    ++i;
-                } else {
-                    break;
-                }
+            i = scan::skipDigits(text, i + 1, size);
+            if (c != '.' && i < size && text[i] == '.') {
+                i = scan::skipDigits(text, i + 1, size);
             }
-            const std::string lexeme = input.substr(start, i - start);
-            try {
-                double value = std::stod(lexeme);
-                tokens.push_back(Token(TokenType::NUMBER, lexeme, value));
-            } catch (const std::exception&) {
-                throw EdaError("numero invalido: " + lexeme);
+            std::string lexeme = input.substr(start, i - start);
+            double value;
+            if (!parseShortDecimal(lexeme.data(), lexeme.size(), value)) {
+                char* end = nullptr;
+                errno = 0;
+                value = std::strtod(lexeme.c_str(), &end);
+                if (end != lexeme.c_str() + lexeme.size() || errno == ERANGE) {
+                    error = Error(ErrorKind::INVALID_NUMBER, start, lexeme.size(), lexeme);
+                    return false;
+                }
             }
+            push(tokens, Token(TokenType::NUMBER, std::move(lexeme), value), start);
             continue;
         }
 
-        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+        if (scan::isLetter(c)) {
             std::size_t start = i;
             ++i;
-            while (i < input.size()) {
-                char nc = input[i];
-                if (std::isalnum(static_cast<unsigned char>(nc)) || nc == '_') {
-                    ++i;
-                } else {
-                    break;
-                }
+            while (i < size && scan::isWordChar(text[i])) {
+                ++i;
             }
             const std::string lexeme = input.substr(start, i - start);
-            if (lexeme == "sqrt") {
-                tokens.push_back(Token(TokenType::SQRT, lexeme));
-            } else if (lexeme == "ans") {
-                tokens.push_back(Token(TokenType::ANS, lexeme));
+            if (lexeme == "ans") {
+                push(tokens, Token(TokenType::ANS, lexeme), start);
+            } else if (lexeme == "sum") {
+                push(tokens, Token(TokenType::SUM, lexeme), start);
+            } else if (lexeme == "prod") {
+                push(tokens, Token(TokenType::PROD, lexeme), start);
+            } else if (lexeme == "select") {
+                push(tokens, Token(TokenType::SELECT, lexeme), start);
+            } else if (const Function* fn = functions_->find(lexeme)) {
+                push(tokens, Token(fn, lexeme), start);
             } else {
-                tokens.push_back(Token(TokenType::IDENT, lexeme));
+                push(tokens, Token(TokenType::IDENT, lexeme), start);
             }
             continue;
         }
 
         switch (c) {
             case '+':
-                tokens.push_back(Token(TokenType::PLUS, "+"));
+                push(tokens, Token(TokenType::PLUS, "+"), i);
                 ++i;
                 break;
             case '-':
-                tokens.push_back(Token(TokenType::MINUS, "-"));
+                push(tokens, Token(TokenType::MINUS, "-"), i);
                 ++i;
                 break;
             case '*':
-                tokens.push_back(Token(TokenType::MUL, "*"));
+                push(tokens, Token(TokenType::MUL, "*"), i);
                 ++i;
                 break;
             case '/':
-                tokens.push_back(Token(TokenType::DIV, "/"));
+                push(tokens, Token(TokenType::DIV, "/"), i);
                 ++i;
                 break;
             case '^':
-                tokens.push_back(Token(TokenType::POW, "^"));
+                push(tokens, Token(TokenType::POW, "^"), i);
                 ++i;
                 break;
             case '(':
-                tokens.push_back(Token(TokenType::LPAREN, "("));
+                push(tokens, Token(TokenType::LPAREN, "("), i);
                 ++i;
                 break;
             case ')':
-                tokens.push_back(Token(TokenType::RPAREN, ")"));
+                push(tokens, Token(TokenType::RPAREN, ")"), i);
                 ++i;
                 break;
-            case '=':
-                tokens.push_back(Token(TokenType::ASSIGN, "="));
+            case ',':
+                push(tokens, Token(TokenType::COMMA, ","), i);
                 ++i;
                 break;
+            case '=':
+                if (i + 1 < size && text[i + 1] == '=') {
+                    push(tokens, Token(TokenType::EQUAL, "=="), i);
+                    i += 2;
+                } else {
+                    push(tokens, Token(TokenType::ASSIGN, "="), i);
+                    ++i;
+                }
+                break;
+            case '<':
+                if (i + 1 < size && text[i + 1] == '=') {
+                    push(tokens, Token(TokenType::LESS_EQUAL, "<="), i);
+                    i += 2;
+                } else {
+                    push(tokens, Token(TokenType::LESS, "<"), i);
+                    ++i;
+                }
+                break;
+            case '>':
+                if (i + 1 < size && text[i + 1] == '=') {
+                    push(tokens, Token(TokenType::GREATER_EQUAL, ">="), i);
+                    i += 2;
+                } else {
+                    push(tokens, Token(TokenType::GREATER, ">"), i);
+                    ++i;
+                }
+                break;
             default:
-                throw EdaError(std::string("token no reconocido: ") + c);
+                error = Error(ErrorKind::UNKNOWN_TOKEN, i, 1, std::string(1, c));
+                return false;
         }
     }
 
-    tokens.push_back(Token(TokenType::END, ""));
-    return tokens;
+    push(tokens, Token(TokenType::END, ""), input.size());
+    return true;
 }
 
 } // namespace edacal
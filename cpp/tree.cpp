@@ -31,6 +31,12 @@ void Tree::setRoot(Node* node) {
     root_ = node;
 }
 
+Tree::Node* Tree::release() {
+    Node* root = root_;
+    root_ = nullptr;
+    return root;
+}
+
 bool Tree::empty() const {
     return root_ == nullptr;
 }
@@ -40,13 +46,22 @@ void Tree::clear() {
     root_ = nullptr;
 }
 
+// Iterativo: los arboles de sumas largas son peines de millones de niveles.
+// Cada nodo con hijo izquierdo se rota hacia la derecha hasta quedar sin el,
+// asi el recorrido no necesita pila.
 void Tree::deleteSubtree(Node* node) {
-    if (!node) {
-        return;
+    while (node) {
+        if (node->left) {
+            Node* left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            Node* right = node->right;
+            delete node;
+            node = right;
+        }
     }
-    deleteSubtree(node->left);
-    deleteSubtree(node->right);
-    delete node;
 }
 
 } // namespace edacal
@@ -0,0 +1,725 @@
+#include "vecmath.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace edacal {
+namespace vecmath {
+
+namespace {
+
+const std::size_t kChunk = 256;
+
+// exp: x = k*ln2 + r con |r| <= ln2/2, e^r por Taylor de grado 13 (Estrin) y
+// 2^k sumado directamente al exponente. Fuera de |x| <= 707 el resultado no
+// es normal y se delega en std::exp.
+const double kExpLimit = 707.0;
+const double kLog2e = 1.4426950408889634074;
+const double kLn2Hi = 6.93147180369123816490e-01;
+const double kLn2Lo = 1.90821492927058770002e-10;
+const double kRoundShift = 6755399441055744.0; // 1.5 * 2^52
+const double kExpC[] = {
+    1.0, 1.0, 1.0 / 2.0, 1.0 / 6.0, 1.0 / 24.0, 1.0 / 120.0, 1.0 / 720.0,
+    1.0 / 5040.0, 1.0 / 40320.0, 1.0 / 362880.0, 1.0 / 3628800.0,
+    1.0 / 39916800.0, 1.0 / 479001600.0, 1.0 / 6227020800.0
+};
+
+// log: x = m * 2^k con m en [sqrt(1/2), sqrt(2)) y el polinomio de fdlibm
+// para log(1 + f). Ceros, negativos, subnormales, inf y NaN van a std::log.
+const std::uint64_t kSqrtHalfBits = 0x3fe6a09e667f3bcdULL;
+const std::uint64_t kExponentMask = 0xfff0000000000000ULL;
+const std::uint64_t kSignBit = 0x8000000000000000ULL;
+const double kTwo52 = 4503599627370496.0;
+const double kLg1 = 6.666666666666735130e-01;
+const double kLg2 = 3.999999999940941908e-01;
+const double kLg3 = 2.857142874366239149e-01;
+const double kLg4 = 2.222219843214978396e-01;
+const double kLg5 = 1.818357216161805012e-01;
+const double kLg6 = 1.531383769920937332e-01;
+const double kLg7 = 1.479819860511658591e-01;
+
+// Versiones en float de ambos kernels: mismos algoritmos con constantes de
+// precision simple (fdlibm expf/logf) y polinomios mas cortos.
+const float kExpLimitF = 87.0f;
+const float kLog2eF = 1.44269504f;
+const float kLn2HiExpF = 6.9314575195e-01f;
+const float kLn2LoExpF = 1.4286067653e-06f;
+const float kRoundShiftF = 12582912.0f; // 1.5 * 2^23
+const float kExpCF[] = {
+    1.0f, 1.0f, 1.0f / 2.0f, 1.0f / 6.0f, 1.0f / 24.0f, 1.0f / 120.0f, 1.0f / 720.0f, 1.0f / 5040.0f
+};
+const std::uint32_t kSqrtHalfBitsF = 0x3f3504f3U;
+const std::uint32_t kExponentMaskF = 0xff800000U;
+const std::uint32_t kSignBitF = 0x80000000U;
+const float kTwo23 = 8388608.0f;
+const float kLn2HiLogF = 6.9313812256e-01f;
+const float kLn2LoLogF = 9.0580006145e-06f;
+const float kLg1F = 6.6666662693e-01f;
+const float kLg2F = 4.0000972152e-01f;
+const float kLg3F = 2.8498786688e-01f;
+const float kLg4F = 2.4279078841e-01f;
+
+// Operaciones basicas para escribir cada kernel una sola vez y obtener la
+// version escalar y la SSE2 con la misma secuencia de operaciones IEEE
+// (g++ define + - * / sobre __m128d).
+typedef std::uint64_t Bits;
+
+inline double splat(double value, double) { return value; }
+inline Bits splatBits(std::uint64_t value, double) { return value; }
+inline Bits asBits(double value) {
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+inline double asDouble(Bits bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+inline Bits addBits(Bits a, Bits b) { return a + b; }
+inline Bits subBits(Bits a, Bits b) { return a - b; }
+inline Bits andBits(Bits a, Bits b) { return a & b; }
+inline Bits orBits(Bits a, Bits b) { return a | b; }
+inline Bits xorBits(Bits a, Bits b) { return a ^ b; }
+inline Bits shiftLeft52(Bits a) { return a << 52; }
+inline Bits shiftRight52(Bits a) { return a >> 52; }
+
+typedef std::uint32_t Bits32;
+
+inline float splat(float value, float) { return value; }
+inline Bits32 splatBits32(std::uint32_t value, float) { return value; }
+inline Bits32 asBits32(float value) {
+    Bits32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+inline float asFloat(Bits32 bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+inline Bits32 add32(Bits32 a, Bits32 b) { return a + b; }
+inline Bits32 sub32(Bits32 a, Bits32 b) { return a - b; }
+inline Bits32 andBits(Bits32 a, Bits32 b) { return a & b; }
+inline Bits32 orBits(Bits32 a, Bits32 b) { return a | b; }
+inline Bits32 xorBits(Bits32 a, Bits32 b) { return a ^ b; }
+inline Bits32 shiftLeft23(Bits32 a) { return a << 23; }
+inline Bits32 shiftRight23(Bits32 a) { return a >> 23; }
+
+#if defined(__SSE2__)
+
+typedef __m128i Bits2;
+
+inline __m128d splat(double value, __m128d) { return _mm_set1_pd(value); }
+inline Bits2 splatBits(std::uint64_t value, __m128d) { return _mm_set1_epi64x(static_cast<long long>(value)); }
+inline Bits2 asBits(__m128d value) { return _mm_castpd_si128(value); }
+inline __m128d asDouble(Bits2 bits) { return _mm_castsi128_pd(bits); }
+inline Bits2 addBits(Bits2 a, Bits2 b) { return _mm_add_epi64(a, b); }
+inline Bits2 subBits(Bits2 a, Bits2 b) { return _mm_sub_epi64(a, b); }
+inline Bits2 andBits(Bits2 a, Bits2 b) { return _mm_and_si128(a, b); }
+inline Bits2 orBits(Bits2 a, Bits2 b) { return _mm_or_si128(a, b); }
+inline Bits2 xorBits(Bits2 a, Bits2 b) { return _mm_xor_si128(a, b); }
+inline Bits2 shiftLeft52(Bits2 a) { return _mm_slli_epi64(a, 52); }
+inline Bits2 shiftRight52(Bits2 a) { return _mm_srli_epi64(a, 52); }
+
+inline __m128 splat(float value, __m128) { return _mm_set1_ps(value); }
+inline Bits2 splatBits32(std::uint32_t value, __m128) { return _mm_set1_epi32(static_cast<int>(value)); }
+inline Bits2 asBits32(__m128 value) { return _mm_castps_si128(value); }
+inline __m128 asFloat(Bits2 bits) { return _mm_castsi128_ps(bits); }
+inline Bits2 add32(Bits2 a, Bits2 b) { return _mm_add_epi32(a, b); }
+inline Bits2 sub32(Bits2 a, Bits2 b) { return _mm_sub_epi32(a, b); }
+inline Bits2 shiftLeft23(Bits2 a) { return _mm_slli_epi32(a, 23); }
+inline Bits2 shiftRight23(Bits2 a) { return _mm_srli_epi32(a, 23); }
+
+#endif
+
+template <typename V>
+V expKernel(V x) {
+    const V shift = splat(kRoundShift, x);
+    V t = x * splat(kLog2e, x) + shift;
+    V k = t - shift;
+    V r = (x - k * splat(kLn2Hi, x)) - k * splat(kLn2Lo, x);
+
+    V r2 = r * r;
+    V r4 = r2 * r2;
+    V r8 = r4 * r4;
+    V p01 = splat(kExpC[0], x) + splat(kExpC[1], x) * r;
+    V p23 = splat(kExpC[2], x) + splat(kExpC[3], x) * r;
+    V p45 = splat(kExpC[4], x) + splat(kExpC[5], x) * r;
+    V p67 = splat(kExpC[6], x) + splat(kExpC[7], x) * r;
+    V p89 = splat(kExpC[8], x) + splat(kExpC[9], x) * r;
+    V p1011 = splat(kExpC[10], x) + splat(kExpC[11], x) * r;
+    V p1213 = splat(kExpC[12], x) + splat(kExpC[13], x) * r;
+    V low = (p01 + p23 * r2) + (p45 + p67 * r2) * r4;
+    V high = (p89 + p1011 * r2) + p1213 * r4;
+    V p = low + high * r8;
+
+    return asDouble(addBits(asBits(p), shiftLeft52(subBits(asBits(t), asBits(shift)))));
+}
+
+template <typename V>
+V logKernel(V x) {
+    auto bits = asBits(x);
+    auto tmp = subBits(bits, splatBits(kSqrtHalfBits, x));
+    V f = asDouble(subBits(bits, andBits(tmp, splatBits(kExponentMask, x)))) - splat(1.0, x);
+    auto biased = shiftRight52(xorBits(tmp, splatBits(kSignBit, x)));
+    V k = asDouble(orBits(biased, asBits(splat(kTwo52, x)))) - splat(kTwo52 + 2048.0, x);
+
+    V s = f / (splat(2.0, x) + f);
+    V z = s * s;
+    V w = z * z;
+    V t1 = w * (splat(kLg2, x) + w * (splat(kLg4, x) + w * splat(kLg6, x)));
+    V t2 = z * (splat(kLg1, x) + w * (splat(kLg3, x) + w * (splat(kLg5, x) + w * splat(kLg7, x))));
+    V r = t2 + t1;
+    V hfsq = splat(0.5, x) * f * f;
+    return k * splat(kLn2Hi, x) - ((hfsq - (s * (hfsq + r) + k * splat(kLn2Lo, x))) - f);
+}
+
+template <typename V>
+V expKernelF(V x) {
+    const V shift = splat(kRoundShiftF, x);
+    V t = x * splat(kLog2eF, x) + shift;
+    V k = t - shift;
+    V r = (x - k * splat(kLn2HiExpF, x)) - k * splat(kLn2LoExpF, x);
+
+    V r2 = r * r;
+    V r4 = r2 * r2;
+    V p01 = splat(kExpCF[0], x) + splat(kExpCF[1], x) * r;
+    V p23 = splat(kExpCF[2], x) + splat(kExpCF[3], x) * r;
+    V p45 = splat(kExpCF[4], x) + splat(kExpCF[5], x) * r;
+    V p67 = splat(kExpCF[6], x) + splat(kExpCF[7], x) * r;
+    V p = (p01 + p23 * r2) + (p45 + p67 * r2) * r4;
+
+    return asFloat(add32(asBits32(p), shiftLeft23(sub32(asBits32(t), asBits32(shift)))));
+}
+
+template <typename V>
+V logKernelF(V x) {
+    auto bits = asBits32(x);
+    auto tmp = sub32(bits, splatBits32(kSqrtHalfBitsF, x));
+    V f = asFloat(sub32(bits, andBits(tmp, splatBits32(kExponentMaskF, x)))) - splat(1.0f, x);
+    auto biased = shiftRight23(xorBits(tmp, splatBits32(kSignBitF, x)));
+    V k = asFloat(orBits(biased, asBits32(splat(kTwo23, x)))) - splat(kTwo23 + 256.0f, x);
+
+    V s = f / (splat(2.0f, x) + f);
+    V z = s * s;
+    V w = z * z;
+    V t1 = w * (splat(kLg2F, x) + w * splat(kLg4F, x));
+    V t2 = z * (splat(kLg1F, x) + w * splat(kLg3F, x));
+    V r = t2 + t1;
+    V hfsq = splat(0.5f, x) * f * f;
+    return k * splat(kLn2HiLogF, x) - ((hfsq - (s * (hfsq + r) + k * splat(kLn2LoLogF, x))) - f);
+}
+
+struct ExpOp {
+    template <typename V>
+    static V kernel(V x) { return expKernel(x); }
+    static bool inRange(double x) { return std::fabs(x) <= kExpLimit; }
+#if defined(__SSE2__)
+    static bool inRange(__m128d x) {
+        __m128d magnitude = _mm_andnot_pd(_mm_set1_pd(-0.0), x);
+        return _mm_movemask_pd(_mm_cmple_pd(magnitude, _mm_set1_pd(kExpLimit))) == 3;
+    }
+#endif
+    static double fallback(double x) { return std::exp(x); }
+};
+
+struct LogOp {
+    template <typename V>
+    static V kernel(V x) { return logKernel(x); }
+    static bool inRange(double x) { return x >= DBL_MIN && x <= DBL_MAX; }
+#if defined(__SSE2__)
+    static bool inRange(__m128d x) {
+        __m128d ok = _mm_and_pd(_mm_cmpge_pd(x, _mm_set1_pd(DBL_MIN)), _mm_cmple_pd(x, _mm_set1_pd(DBL_MAX)));
+        return _mm_movemask_pd(ok) == 3;
+    }
+#endif
+    static double fallback(double x) { return std::log(x); }
+};
+
+// El kernel se aplica sin ramas; las pocas entradas fuera de rango (cuyo
+// resultado no es normal) se corrigen con libm.
+template <typename Op>
+void applyKernel(const double* in, double* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= n; i += 4) {
+        __m128d a = _mm_loadu_pd(in + i);
+        __m128d b = _mm_loadu_pd(in + i + 2);
+        _mm_storeu_pd(out + i, Op::kernel(a));
+        _mm_storeu_pd(out + i + 2, Op::kernel(b));
+        if (!Op::inRange(a) || !Op::inRange(b)) {
+            for (std::size_t j = i; j < i + 4; ++j) {
+                if (!Op::inRange(in[j])) {
+                    out[j] = Op::fallback(in[j]);
+                }
+            }
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = Op::inRange(in[i]) ? Op::kernel(in[i]) : Op::fallback(in[i]);
+    }
+}
+
+struct ExpOpF {
+    template <typename V>
+    static V kernel(V x) { return expKernelF(x); }
+    static bool inRange(float x) { return std::fabs(x) <= kExpLimitF; }
+#if defined(__SSE2__)
+    static bool inRange(__m128 x) {
+        __m128 magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+        return _mm_movemask_ps(_mm_cmple_ps(magnitude, _mm_set1_ps(kExpLimitF))) == 15;
+    }
+#endif
+    static float fallback(float x) { return std::exp(x); }
+};
+
+struct LogOpF {
+    template <typename V>
+    static V kernel(V x) { return logKernelF(x); }
+    static bool inRange(float x) { return x >= FLT_MIN && x <= FLT_MAX; }
+#if defined(__SSE2__)
+    static bool inRange(__m128 x) {
+        __m128 ok = _mm_and_ps(_mm_cmpge_ps(x, _mm_set1_ps(FLT_MIN)), _mm_cmple_ps(x, _mm_set1_ps(FLT_MAX)));
+        return _mm_movemask_ps(ok) == 15;
+    }
+#endif
+    static float fallback(float x) { return std::log(x); }
+};
+
+template <typename Op>
+void applyKernel(const float* in, float* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_loadu_ps(in + i);
+        __m128 b = _mm_loadu_ps(in + i + 4);
+        _mm_storeu_ps(out + i, Op::kernel(a));
+        _mm_storeu_ps(out + i + 4, Op::kernel(b));
+        if (!Op::inRange(a) || !Op::inRange(b)) {
+            for (std::size_t j = i; j < i + 8; ++j) {
+                if (!Op::inRange(in[j])) {
+                    out[j] = Op::fallback(in[j]);
+                }
+            }
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = Op::inRange(in[i]) ? Op::kernel(in[i]) : Op::fallback(in[i]);
+    }
+}
+
+// Un registro SSE2 de double o de float, para escribir una sola vez los
+// kernels sin saltos de compare/select/min/max.
+#if defined(__SSE2__)
+template <typename T>
+struct Lanes;
+
+template <>
+struct Lanes<double> {
+    typedef __m128d Vector;
+    static const std::size_t kWidth = 2;
+    static Vector load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, Vector v) { _mm_storeu_pd(p, v); }
+    static Vector splat(double value) { return _mm_set1_pd(value); }
+    static Vector bitAnd(Vector a, Vector b) { return _mm_and_pd(a, b); }
+    static Vector less(Vector a, Vector b) { return _mm_cmplt_pd(a, b); }
+    static Vector lessEqual(Vector a, Vector b) { return _mm_cmple_pd(a, b); }
+    static Vector equal(Vector a, Vector b) { return _mm_cmpeq_pd(a, b); }
+    static Vector notEqual(Vector a, Vector b) { return _mm_cmpneq_pd(a, b); }
+    static Vector blend(Vector mask, Vector a, Vector b) {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+    // minpd/maxpd devuelven el segundo operando con NaN o con ceros iguales.
+    static Vector min(Vector a, Vector b) { return _mm_min_pd(a, b); }
+    static Vector max(Vector a, Vector b) { return _mm_max_pd(a, b); }
+};
+
+template <>
+struct Lanes<float> {
+    typedef __m128 Vector;
+    static const std::size_t kWidth = 4;
+    static Vector load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+    static Vector splat(float value) { return _mm_set1_ps(value); }
+    static Vector bitAnd(Vector a, Vector b) { return _mm_and_ps(a, b); }
+    static Vector less(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+    static Vector lessEqual(Vector a, Vector b) { return _mm_cmple_ps(a, b); }
+    static Vector equal(Vector a, Vector b) { return _mm_cmpeq_ps(a, b); }
+    static Vector notEqual(Vector a, Vector b) { return _mm_cmpneq_ps(a, b); }
+    static Vector blend(Vector mask, Vector a, Vector b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    static Vector min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+    static Vector max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+};
+#endif
+
+// a > b y a >= b son b < a y b <= a: SSE2 no tiene otra cosa.
+struct LessOp {
+    template <typename T>
+    static bool test(T a, T b) { return a < b; }
+#if defined(__SSE2__)
+    template <typename L>
+    static typename L::Vector mask(typename L::Vector a, typename L::Vector b) { return L::less(a, b); }
+#endif
+};
+
+struct LessEqualOp {
+    template <typename T>
+    static bool test(T a, T b) { return a <= b; }
+#if defined(__SSE2__)
+    template <typename L>
+    static typename L::Vector mask(typename L::Vector a, typename L::Vector b) { return L::lessEqual(a, b); }
+#endif
+};
+
+struct GreaterOp {
+    template <typename T>
+    static bool test(T a, T b) { return a > b; }
+#if defined(__SSE2__)
+    template <typename L>
+    static typename L::Vector mask(typename L::Vector a, typename L::Vector b) { return L::less(b, a); }
+#endif
+};
+
+struct GreaterEqualOp {
+    template <typename T>
+    static bool test(T a, T b) { return a >= b; }
+#if defined(__SSE2__)
+    template <typename L>
+    static typename L::Vector mask(typename L::Vector a, typename L::Vector b) { return L::lessEqual(b, a); }
+#endif
+};
+
+struct EqualOp {
+    template <typename T>
+    static bool test(T a, T b) { return a == b; }
+#if defined(__SSE2__)
+    template <typename L>
+    static typename L::Vector mask(typename L::Vector a, typename L::Vector b) { return L::equal(a, b); }
+#endif
+};
+
+// La mascara es todo unos o todo ceros: and con 1.0 da 1.0 o +0.0.
+template <typename Op, typename T>
+void compareKernel(const T* a, const T* b, T* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    typedef Lanes<T> L;
+    const typename L::Vector one = L::splat(T(1));
+    for (; i + L::kWidth <= n; i += L::kWidth) {
+        L::store(out + i, L::bitAnd(Op::template mask<L>(L::load(a + i), L::load(b + i)), one));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = Op::test(a[i], b[i]) ? T(1) : T(0);
+    }
+}
+
+template <typename T>
+void compareAny(Comparison op, const T* a, const T* b, T* out, std::size_t n) {
+    switch (op) {
+        case Comparison::Less:
+            compareKernel<LessOp>(a, b, out, n);
+            break;
+        case Comparison::LessEqual:
+            compareKernel<LessEqualOp>(a, b, out, n);
+            break;
+        case Comparison::Greater:
+            compareKernel<GreaterOp>(a, b, out, n);
+            break;
+        case Comparison::GreaterEqual:
+            compareKernel<GreaterEqualOp>(a, b, out, n);
+            break;
+        case Comparison::Equal:
+            compareKernel<EqualOp>(a, b, out, n);
+            break;
+    }
+}
+
+// cond != 0 tambien se cumple con NaN, igual que en Evaluator.
+template <typename T>
+void selectKernel(const T* cond, const T* a, const T* b, T* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    typedef Lanes<T> L;
+    const typename L::Vector zero = L::splat(T(0));
+    for (; i + L::kWidth <= n; i += L::kWidth) {
+        typename L::Vector mask = L::notEqual(L::load(cond + i), zero);
+        L::store(out + i, L::blend(mask, L::load(a + i), L::load(b + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = cond[i] != T(0) ? a[i] : b[i];
+    }
+}
+
+// std::min(a, b) es (b < a) ? b : a, que es minpd con los operandos al reves;
+// std::max(a, b) es (a < b) ? b : a, que es maxpd(b, a).
+template <typename T>
+void minKernel(const T* a, const T* b, T* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    typedef Lanes<T> L;
+    for (; i + L::kWidth <= n; i += L::kWidth) {
+        L::store(out + i, L::min(L::load(b + i), L::load(a + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = std::min(a[i], b[i]);
+    }
+}
+
+template <typename T>
+void maxKernel(const T* a, const T* b, T* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    typedef Lanes<T> L;
+    for (; i + L::kWidth <= n; i += L::kWidth) {
+        L::store(out + i, L::max(L::load(b + i), L::load(a + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = std::max(a[i], b[i]);
+    }
+}
+
+bool integerExponent(double exponent, long& result) {
+    if (!(std::fabs(exponent) <= static_cast<double>(kMaxIntegerExponent))) {
+        return false;
+    }
+    long candidate = static_cast<long>(exponent);
+    if (static_cast<double>(candidate) != exponent) {
+        return false;
+    }
+    result = candidate;
+    return true;
+}
+
+} // namespace
+
+double powi(double base, long exponent) {
+    unsigned long remaining = exponent < 0 ? 0UL - static_cast<unsigned long>(exponent)
+                                           : static_cast<unsigned long>(exponent);
+    double result = 1.0;
+    double factor = base;
+    while (remaining) {
+        if (remaining & 1UL) {
+            result *= factor;
+        }
+        remaining >>= 1;
+        if (remaining) {
+            factor *= factor;
+        }
+    }
+    if (exponent < 0 && !std::isnormal(result) && std::isfinite(base) && base != 0.0) {
+        // x^|n| se desbordo o perdio bits antes del reciproco, que si cabe.
+        return std::pow(base, static_cast<double>(exponent));
+    }
+    return exponent < 0 ? 1.0 / result : result;
+}
+
+void sqrt(const double* in, double* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_loadu_pd(in + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = std::sqrt(in[i]);
+    }
+}
+
+void exp(const double* in, double* out, std::size_t n, Mode mode) {
+    if (mode == Mode::Exact) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::exp(in[i]);
+        }
+        return;
+    }
+    applyKernel<ExpOp>(in, out, n);
+}
+
+void log(const double* in, double* out, std::size_t n, Mode mode) {
+    if (mode == Mode::Exact) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::log(in[i]);
+        }
+        return;
+    }
+    applyKernel<LogOp>(in, out, n);
+}
+
+void powi(const double* base, long exponent, double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = powi(base[i], exponent);
+    }
+}
+
+void pow(const double* base, const double* exponent, double* out, std::size_t n, Mode mode) {
+    if (mode == Mode::Exact) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::pow(base[i], exponent[i]);
+        }
+        return;
+    }
+
+    double scratch[kChunk];
+    for (std::size_t start = 0; start < n; start += kChunk) {
+        std::size_t count = n - start < kChunk ? n - start : kChunk;
+        const double* x = base + start;
+        const double* y = exponent + start;
+        double* result = out + start;
+
+        applyKernel<LogOp>(x, scratch, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            scratch[i] *= y[i];
+        }
+        applyKernel<ExpOp>(scratch, result, count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            long integer = 0;
+            if (integerExponent(y[i], integer)) {
+                result[i] = powi(x[i], integer);
+            } else if (!LogOp::inRange(x[i]) || !std::isfinite(y[i])) {
+                result[i] = std::pow(x[i], y[i]);
+            }
+        }
+    }
+}
+
+float powi(float base, long exponent) {
+    unsigned long remaining = exponent < 0 ? 0UL - static_cast<unsigned long>(exponent)
+                                           : static_cast<unsigned long>(exponent);
+    float result = 1.0f;
+    float factor = base;
+    while (remaining) {
+        if (remaining & 1UL) {
+            result *= factor;
+        }
+        remaining >>= 1;
+        if (remaining) {
+            factor *= factor;
+        }
+    }
+    if (exponent < 0 && !std::isnormal(result) && std::isfinite(base) && base != 0.0f) {
+        return std::pow(base, static_cast<float>(exponent));
+    }
+    return exponent < 0 ? 1.0f / result : result;
+}
+
+void sqrt(const float* in, float* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(_mm_loadu_ps(in + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = std::sqrt(in[i]);
+    }
+}
+
+void exp(const float* in, float* out, std::size_t n, Mode mode) {
+    if (mode == Mode::Exact) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::exp(in[i]);
+        }
+        return;
+    }
+    applyKernel<ExpOpF>(in, out, n);
+}
+
+void log(const float* in, float* out, std::size_t n, Mode mode) {
+    if (mode == Mode::Exact) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::log(in[i]);
+        }
+        return;
+    }
+    applyKernel<LogOpF>(in, out, n);
+}
+
+void powi(const float* base, long exponent, float* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = powi(base[i], exponent);
+    }
+}
+
+void pow(const float* base, const float* exponent, float* out, std::size_t n, Mode mode) {
+    if (mode == Mode::Exact) {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = std::pow(base[i], exponent[i]);
+        }
+        return;
+    }
+
+    float scratch[kChunk];
+    for (std::size_t start = 0; start < n; start += kChunk) {
+        std::size_t count = n - start < kChunk ? n - start : kChunk;
+        const float* x = base + start;
+        const float* y = exponent + start;
+        float* result = out + start;
+
+        applyKernel<LogOpF>(x, scratch, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            scratch[i] *= y[i];
+        }
+        applyKernel<ExpOpF>(scratch, result, count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            long integer = 0;
+            if (integerExponent(y[i], integer)) {
+                result[i] = powi(x[i], integer);
+            } else if (!LogOpF::inRange(x[i]) || !std::isfinite(y[i])) {
+                result[i] = std::pow(x[i], y[i]);
+            }
+        }
+    }
+}
+
+void compare(Comparison op, const double* a, const double* b, double* out, std::size_t n) {
+    compareAny(op, a, b, out, n);
+}
+
+void select(const double* cond, const double* a, const double* b, double* out, std::size_t n) {
+    selectKernel(cond, a, b, out, n);
+}
+
+void min(const double* a, const double* b, double* out, std::size_t n) {
+    minKernel(a, b, out, n);
+}
+
+void max(const double* a, const double* b, double* out, std::size_t n) {
+    maxKernel(a, b, out, n);
+}
+
+void compare(Comparison op, const float* a, const float* b, float* out, std::size_t n) {
+    compareAny(op, a, b, out, n);
+}
+
+void select(const float* cond, const float* a, const float* b, float* out, std::size_t n) {
+    selectKernel(cond, a, b, out, n);
+}
+
+void min(const float* a, const float* b, float* out, std::size_t n) {
+    minKernel(a, b, out, n);
+}
+
+void max(const float* a, const float* b, float* out, std::size_t n) {
+    maxKernel(a, b, out, n);
+}
+
+} // namespace vecmath
+} // namespace edacal
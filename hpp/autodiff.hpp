@@ -0,0 +1,59 @@
+#ifndef EDACAL_AUTODIFF_HPP
+#define EDACAL_AUTODIFF_HPP
+
+#include "errors.hpp"
+#include "functions.hpp"
+#include "symbols.hpp"
+#include "token.hpp"
+#include "tree.hpp"
+
+#include <string>
+#include <vector>
+
+namespace edacal {
+
+struct Dual {
+    double value;
+    double derivative;
+};
+
+// Evaluator en modo directo: cada valor lleva su derivada respecto a una
+// variable. Un gradiente de N variables cuesta N pasadas.
+class DualEvaluator {
+public:
+    DualEvaluator() = default;
+
+    Dual evalPostfix(const TokenList& postfix, SymbolTable& symbols, const std::string& variable) const;
+};
+
+// Modo inverso sobre el Tree: una pasada hacia adelante guarda el valor de
+// cada nodo y otra hacia atras acumula los adjuntos, asi que el valor y
+// todas las parciales salen en un solo barrido sea cual sea N.
+class GradientEvaluator {
+public:
+    struct Result {
+        double value;
+        std::vector<double> partials;
+    };
+
+    GradientEvaluator() = default;
+
+    Result evaluate(const Tree& tree, SymbolTable& symbols, const std::vector<std::string>& variables) const;
+
+    // Variables del arbol en orden de primera aparicion (incluye `ans`).
+    std::vector<std::string> variablesOf(const Tree& tree) const;
+
+private:
+    struct Entry {
+        const Tree::Node* node;
+        int left;
+        int right;
+        int variable;
+    };
+
+    void flatten(const Tree::Node* root, const std::vector<std::string>& variables, std::vector<Entry>& tape) const;
+};
+
+} // namespace edacal
+
+#endif
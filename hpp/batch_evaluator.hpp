@@ -0,0 +1,79 @@
+#ifndef EDACAL_BATCH_EVALUATOR_HPP
+#define EDACAL_BATCH_EVALUATOR_HPP
+
+#include "errors.hpp"
+#include "functions.hpp"
+#include "symbols.hpp"
+#include "token.hpp"
+#include "vecmath.hpp"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace edacal {
+
+// Evalua una misma posfija sobre muchas filas. Las variables presentes en
+// `columns` se leen por fila; el resto se toma de la SymbolTable una vez.
+// Las columnas float reducen a la mitad el trafico de memoria: Single calcula
+// en float y Mixed convierte cada bloque a double y calcula como la version
+// double, redondeando solo al escribir el resultado.
+//
+// Las comparaciones, select, min y max no saltan segun las filas: se
+// calculan con mascaras y mezclas de vecmath, y select ya tiene las dos ramas
+// calculadas en la pila (un error en cualquiera de ellas, en cualquier fila,
+// es un error, como en Evaluator).
+class BatchEvaluator {
+public:
+    typedef std::unordered_map<std::string, const double*> Columns;
+    typedef std::unordered_map<std::string, const float*> FloatColumns;
+
+    enum class Precision {
+        Single,
+        Mixed
+    };
+
+    static const std::size_t kBlockSize = 256;
+
+    explicit BatchEvaluator(vecmath::Mode mode = vecmath::Mode::Fast);
+
+    void evalPostfix(const TokenList& postfix, const Columns& columns, SymbolTable& symbols,
+                     double* out, std::size_t rows) const;
+    void evalPostfix(const TokenList& postfix, const FloatColumns& columns, SymbolTable& symbols,
+                     float* out, std::size_t rows, Precision precision = Precision::Mixed) const;
+
+private:
+    enum class Kernel {
+        NONE,
+        SQRT,
+        EXP,
+        LOG,
+        MIN,
+        MAX
+    };
+
+    template <typename Storage>
+    struct Step {
+        Token token;
+        const Storage* column;
+        Kernel kernel;
+    };
+
+    vecmath::Mode mode_;
+
+    template <typename Storage>
+    std::vector<Step<Storage>> compile(const TokenList& postfix,
+                                       const std::unordered_map<std::string, const Storage*>& columns,
+                                       SymbolTable& symbols, std::size_t& maxDepth) const;
+    template <typename Real, typename Storage>
+    void evalRows(const std::vector<Step<Storage>>& steps, std::size_t maxDepth, Storage* out,
+                  std::size_t rows) const;
+    template <typename Real, typename Storage>
+    void evalBlock(const std::vector<Step<Storage>>& steps, Real* stack, std::size_t offset, std::size_t count,
+                   Storage* out) const;
+};
+
+} // namespace edacal
+
+#endif
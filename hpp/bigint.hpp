@@ -0,0 +1,59 @@
+#ifndef EDACAL_BIGINT_HPP
+#define EDACAL_BIGINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace edacal {
+
+// Entero de precision arbitraria. Los valores que caben en un int64 (salvo
+// INT64_MIN) se guardan en linea y sus operaciones no reservan memoria; solo
+// al desbordar se pasa a una magnitud en limbs de 32 bits.
+class BigInt {
+public:
+    BigInt();
+    BigInt(std::int64_t value);
+
+    // Digitos decimales con signo opcional.
+    static BigInt parse(const std::string& text);
+    static BigInt powerOfTwo(unsigned exponent);
+    static BigInt gcd(const BigInt& a, const BigInt& b);
+    // Division truncada: a = q * b + r, con r del signo de a.
+    static void divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder);
+
+    bool isZero() const;
+    bool isNegative() const;
+    bool isSmall() const;
+    std::size_t bitLength() const;
+    int compare(const BigInt& other) const;
+
+    BigInt operator-() const;
+    BigInt abs() const;
+    friend BigInt operator+(const BigInt& a, const BigInt& b);
+    friend BigInt operator-(const BigInt& a, const BigInt& b);
+    friend BigInt operator*(const BigInt& a, const BigInt& b);
+    friend BigInt operator/(const BigInt& a, const BigInt& b);
+
+    bool operator==(const BigInt& other) const { return compare(other) == 0; }
+    bool operator!=(const BigInt& other) const { return compare(other) != 0; }
+    bool operator<(const BigInt& other) const { return compare(other) < 0; }
+
+    double toDouble() const;
+    std::string toString() const;
+
+private:
+    typedef std::vector<std::uint32_t> Magnitude;
+
+    std::int64_t small_;
+    bool negative_;
+    Magnitude limbs_; // vacio mientras el valor quepa en small_
+
+    Magnitude magnitude() const;
+    static BigInt fromMagnitude(Magnitude magnitude, bool negative);
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef EDACAL_CHAR_SCAN_HPP
+#define EDACAL_CHAR_SCAN_HPP
+
+#include <cstddef>
+
+namespace edacal {
+namespace scan {
+
+// Clases de caracteres por tabla, iguales a std::isspace, std::isdigit e
+// std::isalpha/isalnum en el locale "C" (el que usa EdaCal), sin llamadas
+// ni consultas al locale. `_` cuenta como letra para los identificadores.
+enum CharClass : unsigned char {
+    kSpace = 1,
+    kDigit = 2,
+    kLetter = 4
+};
+
+extern const unsigned char kCharClass[256];
+
+inline bool isSpace(char c) { return kCharClass[static_cast<unsigned char>(c)] & kSpace; }
+inline bool isDigit(char c) { return kCharClass[static_cast<unsigned char>(c)] & kDigit; }
+inline bool isLetter(char c) { return kCharClass[static_cast<unsigned char>(c)] & kLetter; }
+inline bool isWordChar(char c) { return kCharClass[static_cast<unsigned char>(c)] & (kLetter | kDigit); }
+
+// Primera posicion >= `pos` (o `size`) cuyo caracter no es espacio / no es
+// digito. Con AVX2 avanzan de a 32 bytes, con SSE2 de a 16 y si no, byte a
+// byte con la tabla.
+std::size_t skipSpaces(const char* text, std::size_t pos, std::size_t size);
+std::size_t skipDigits(const char* text, std::size_t pos, std::size_t size);
+
+// Las versiones byte a byte, para comparar en bench/tokenizer.cpp.
+std::size_t skipSpacesScalar(const char* text, std::size_t pos, std::size_t size);
+std::size_t skipDigitsScalar(const char* text, std::size_t pos, std::size_t size);
+
+// Nombre del camino vectorial compilado: "AVX2", "SSE2" o "escalar".
+const char* simdPath();
+
+} // namespace scan
+} // namespace edacal
+
+#endif
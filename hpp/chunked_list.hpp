@@ -0,0 +1,342 @@
+#ifndef EDACAL_CHUNKED_LIST_HPP
+#define EDACAL_CHUNKED_LIST_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace edacal {
+
+// Lista desenrollada: misma interfaz que LinkedList, pero cada nodo guarda
+// hasta ChunkSize elementos contiguos, asi que recorrerla salta de puntero
+// una vez por bloque y llenarla pide memoria una vez por bloque. Ademas
+// splice_back/append enlazan los bloques de otra lista en O(1) y reserve
+// deja bloques libres preparados.
+template <typename T, std::size_t ChunkSize = 16>
+class ChunkedList {
+    static_assert(ChunkSize > 0, "ChunkSize debe ser positivo");
+
+private:
+    // Los elementos vivos de un bloque son [begin, end); ningun bloque
+    // enlazado queda vacio.
+    struct Chunk {
+        Chunk* next;
+        std::size_t begin;
+        std::size_t end;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[ChunkSize];
+
+        explicit Chunk(std::size_t start) : next(nullptr), begin(start), end(start) {}
+
+        T* slot(std::size_t index) { return reinterpret_cast<T*>(&storage[index]); }
+        const T* slot(std::size_t index) const { return reinterpret_cast<const T*>(&storage[index]); }
+    };
+
+    Chunk* head_;
+    Chunk* tail_;
+    Chunk* spare_;
+    std::size_t size_;
+
+    Chunk* takeChunk(std::size_t start) {
+        if (spare_) {
+            Chunk* chunk = spare_;
+            spare_ = chunk->next;
+            chunk->next = nullptr;
+            chunk->begin = chunk->end = start;
+            return chunk;
+        }
+        return new Chunk(start);
+    }
+
+    void releaseChunk(Chunk* chunk) {
+        chunk->next = spare_;
+        spare_ = chunk;
+    }
+
+    static void destroyChunk(Chunk* chunk) {
+        for (std::size_t i = chunk->begin; i < chunk->end; ++i) {
+            chunk->slot(i)->~T();
+        }
+    }
+
+    // Devuelve un bloque al final con espacio libre, enlazando uno nuevo si hace falta.
+    Chunk* backChunk() {
+        if (!tail_ || tail_->end == ChunkSize) {
+            Chunk* chunk = takeChunk(0);
+            if (tail_) {
+                tail_->next = chunk;
+            } else {
+                head_ = chunk;
+            }
+            tail_ = chunk;
+        }
+        return tail_;
+    }
+
+    Chunk* frontChunk() {
+        if (!head_ || head_->begin == 0) {
+            Chunk* chunk = takeChunk(ChunkSize);
+            chunk->next = head_;
+            head_ = chunk;
+            if (!tail_) {
+                tail_ = chunk;
+            }
+        }
+        return head_;
+    }
+
+    void copyFrom(const ChunkedList& other) {
+        reserve(other.size_);
+        for (const auto& value : other) {
+            push_back(value);
+        }
+    }
+
+    void moveFrom(ChunkedList&& other) noexcept {
+        head_ = other.head_;
+        tail_ = other.tail_;
+        spare_ = other.spare_;
+        size_ = other.size_;
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.spare_ = nullptr;
+        other.size_ = 0;
+    }
+
+    void freeSpare() {
+        while (spare_) {
+            Chunk* next = spare_->next;
+            delete spare_;
+            spare_ = next;
+        }
+    }
+
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        Iterator(Chunk* chunk, std::size_t index) : chunk_(chunk), index_(index) {}
+
+        reference operator*() const { return *chunk_->slot(index_); }
+        pointer operator->() const { return chunk_->slot(index_); }
+
+        Iterator& operator++() {
+            if (chunk_ && ++index_ == chunk_->end) {
+                chunk_ = chunk_->next;
+                index_ = chunk_ ? chunk_->begin : 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const Iterator& other) const { return chunk_ == other.chunk_ && index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        Chunk* chunk_;
+        std::size_t index_;
+    };
+
+    class ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        ConstIterator(const Chunk* chunk, std::size_t index) : chunk_(chunk), index_(index) {}
+
+        reference operator*() const { return *chunk_->slot(index_); }
+        pointer operator->() const { return chunk_->slot(index_); }
+
+        ConstIterator& operator++() {
+            if (chunk_ && ++index_ == chunk_->end) {
+                chunk_ = chunk_->next;
+                index_ = chunk_ ? chunk_->begin : 0;
+            }
+            return *this;
+        }
+
+        ConstIterator operator++(int) {
+            ConstIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const ConstIterator& other) const {
+            return chunk_ == other.chunk_ && index_ == other.index_;
+        }
+        bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+
+    private:
+        const Chunk* chunk_;
+        std::size_t index_;
+    };
+
+    ChunkedList() : head_(nullptr), tail_(nullptr), spare_(nullptr), size_(0) {}
+
+    ChunkedList(const ChunkedList& other) : head_(nullptr), tail_(nullptr), spare_(nullptr), size_(0) {
+        copyFrom(other);
+    }
+
+    ChunkedList(ChunkedList&& other) noexcept : head_(nullptr), tail_(nullptr), spare_(nullptr), size_(0) {
+        moveFrom(std::move(other));
+    }
+
+    ChunkedList& operator=(const ChunkedList& other) {
+        if (this != &other) {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ChunkedList& operator=(ChunkedList&& other) noexcept {
+        if (this != &other) {
+            clear();
+            freeSpare();
+            moveFrom(std::move(other));
+        }
+        return *this;
+    }
+
+    ~ChunkedList() {
+        clear();
+        freeSpare();
+    }
+
+    void push_back(const T& value) {
+        Chunk* chunk = backChunk();
+        new (chunk->slot(chunk->end)) T(value);
+        ++chunk->end;
+        ++size_;
+    }
+
+    void push_back(T&& value) {
+        Chunk* chunk = backChunk();
+        new (chunk->slot(chunk->end)) T(std::move(value));
+        ++chunk->end;
+        ++size_;
+    }
+
+    void push_front(const T& value) {
+        Chunk* chunk = frontChunk();
+        new (chunk->slot(chunk->begin - 1)) T(value);
+        --chunk->begin;
+        ++size_;
+    }
+
+    void push_front(T&& value) {
+        Chunk* chunk = frontChunk();
+        new (chunk->slot(chunk->begin - 1)) T(std::move(value));
+        --chunk->begin;
+        ++size_;
+    }
+
+    void pop_front() {
+        if (!head_) {
+            throw std::out_of_range("ChunkedList::pop_front on empty list");
+        }
+        head_->slot(head_->begin)->~T();
+        ++head_->begin;
+        --size_;
+        if (head_->begin == head_->end) {
+            Chunk* old = head_;
+            head_ = head_->next;
+            if (!head_) {
+                tail_ = nullptr;
+            }
+            releaseChunk(old);
+        }
+    }
+
+    T& front() {
+        if (!head_) {
+            throw std::out_of_range("ChunkedList::front on empty list");
+        }
+        return *head_->slot(head_->begin);
+    }
+
+    const T& front() const {
+        if (!head_) {
+            throw std::out_of_range("ChunkedList::front on empty list");
+        }
+        return *head_->slot(head_->begin);
+    }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    // Deja bloques libres para que los siguientes `count` push_back no pidan memoria.
+    void reserve(std::size_t count) {
+        std::size_t available = tail_ ? ChunkSize - tail_->end : 0;
+        for (const Chunk* chunk = spare_; chunk; chunk = chunk->next) {
+            available += ChunkSize;
+        }
+        while (available < count) {
+            releaseChunk(new Chunk(0));
+            available += ChunkSize;
+        }
+    }
+
+    // Mueve todos los elementos de `other` al final en O(1): enlaza sus
+    // bloques sin copiar ni mover elementos. `other` queda vacia pero
+    // conserva sus bloques libres.
+    void splice_back(ChunkedList& other) {
+        if (this == &other || !other.head_) {
+            return;
+        }
+        if (tail_) {
+            tail_->next = other.head_;
+        } else {
+            head_ = other.head_;
+        }
+        tail_ = other.tail_;
+        size_ += other.size_;
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.size_ = 0;
+    }
+
+    void append(ChunkedList&& other) {
+        splice_back(other);
+    }
+
+    // Destruye los elementos; los bloques quedan libres para reutilizarse.
+    void clear() {
+        Chunk* current = head_;
+        while (current) {
+            Chunk* next = current->next;
+            destroyChunk(current);
+            releaseChunk(current);
+            current = next;
+        }
+        head_ = nullptr;
+        tail_ = nullptr;
+        size_ = 0;
+    }
+
+    Iterator begin() { return head_ ? Iterator(head_, head_->begin) : end(); }
+    Iterator end() { return Iterator(nullptr, 0); }
+    ConstIterator begin() const { return head_ ? ConstIterator(head_, head_->begin) : end(); }
+    ConstIterator end() const { return ConstIterator(nullptr, 0); }
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
+};
+
+} // namespace edacal
+
+#endif
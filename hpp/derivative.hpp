@@ -0,0 +1,37 @@
+#ifndef EDACAL_DERIVATIVE_HPP
+#define EDACAL_DERIVATIVE_HPP
+
+#include "errors.hpp"
+#include "functions.hpp"
+#include "token.hpp"
+#include "tree.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace edacal {
+
+// Derivada simbolica d/dx como transformacion de Tree a Tree. Internamente
+// el arbol y su derivada viven en un grafo con hash-consing (cada
+// subexpresion distinta existe una sola vez y se deriva una sola vez), y
+// cada nodo se simplifica al construirse: constantes plegadas, neutros
+// (0 + u, 1 * u, u ^ 1) y absorbentes (0 * u) eliminados, u - u = 0.
+class Differentiator {
+public:
+    struct Stats {
+        std::size_t graphNodes; // nodos distintos en el grafo (entrada + derivada)
+        std::size_t treeNodes;  // nodos del Tree devuelto
+    };
+
+    // Limite de nodos del Tree resultante; por encima se lanza EdaError.
+    static const std::size_t kMaxTreeNodes = 1000000;
+
+    Differentiator() = default;
+
+    Tree differentiate(const Tree& tree, const std::string& variable) const;
+    Tree differentiate(const Tree& tree, const std::string& variable, Stats& stats) const;
+};
+
+} // namespace edacal
+
+#endif
@@ -1,15 +1,63 @@
 #ifndef EDACAL_ERRORS_HPP
 #define EDACAL_ERRORS_HPP
 
+#include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace edacal {
 
+enum class ErrorKind {
+    NONE,
+    OTHER,
+    INVALID_NUMBER,
+    UNKNOWN_TOKEN,
+    EXPECTED_CALL,
+    OPERAND_EXPECTED,
+    EMPTY_ARGUMENT,
+    STRAY_COMMA,
+    UNBALANCED_PARENS,
+    ARGUMENT_COUNT,
+    UNEXPECTED_ASSIGN,
+    UNEXPECTED_TOKEN,
+    INCOMPLETE_EXPRESSION,
+    MISSING_OPERANDS,
+    INVALID_EXPRESSION,
+    DIVISION_BY_ZERO,
+    UNDEFINED_VARIABLE,
+    DOMAIN
+};
+
+// Error estructurado de Tokenizer, Parser y Evaluator. `column` y `length`
+// delimitan el fragmento de la entrada que lo causo; `detail` guarda el
+// lexema o nombre involucrado y `reason` un texto estatico (el dominio de una
+// funcion). El mensaje solo se arma al llamar a message().
+struct Error {
+    ErrorKind kind;
+    std::size_t column;
+    std::size_t length;
+    std::string detail;
+    const char* reason;
+
+    Error() : kind(ErrorKind::NONE), column(0), length(0), detail(), reason(nullptr) {}
+    Error(ErrorKind k, std::size_t col, std::size_t len, std::string det = std::string(), const char* why = nullptr)
+        : kind(k), column(col), length(len), detail(std::move(det)), reason(why) {}
+
+    std::string message() const;
+};
+
 class EdaError : public std::runtime_error {
 public:
     explicit EdaError(const std::string& message)
-        : std::runtime_error(message) {}
+        : std::runtime_error(message), error_(ErrorKind::OTHER, 0, 0, message) {}
+    explicit EdaError(const Error& error)
+        : std::runtime_error(error.message()), error_(error) {}
+
+    const Error& error() const { return error_; }
+
+private:
+    Error error_;
 };
 
 } // namespace edacal
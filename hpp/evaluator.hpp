@@ -2,20 +2,35 @@
 #define EDACAL_EVALUATOR_HPP
 
 #include "errors.hpp"
-#include "linked_list.hpp"
+#include "functions.hpp"
 #include "stack.hpp"
 #include "symbols.hpp"
 #include "token.hpp"
 
 namespace edacal {
 
-class Evaluator {
+// Evalua una posfija con el tipo numerico T (double o Rational, ver
+// NumericTraits). Evaluator es la version con double.
+template <typename T>
+class BasicEvaluator {
 public:
-    Evaluator() = default;
+    BasicEvaluator() = default;
 
-    double evalPostfix(const LinkedList<Token>& postfix, SymbolTable& symbols) const;
+    // Vueltas de cuerpo de sum/prod permitidas en una evaluacion, contando
+    // todas las de los bucles anidados; al pasarse se reporta un error de
+    // dominio en la columna del sum/prod que iba a superarlo.
+    static const unsigned long kMaxIterations = 10000000;
+
+    T evalPostfix(const TokenList& postfix, const BasicSymbolTable<T>& symbols) const;
+    // Sin excepciones en los errores comunes (division por cero, variable no
+    // definida, dominio de sqrt/log): devuelve false con el error y la
+    // columna del token. Lo que lance una funcion se captura y se reporta
+    // igual, con ErrorKind::OTHER si no era un error estructurado.
+    bool evalPostfix(const TokenList& postfix, const BasicSymbolTable<T>& symbols, T& result, Error& error) const;
 };
 
+typedef BasicEvaluator<double> Evaluator;
+
 } // namespace edacal
 
 #endif
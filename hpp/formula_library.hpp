@@ -0,0 +1,94 @@
+#ifndef EDACAL_FORMULA_LIBRARY_HPP
+#define EDACAL_FORMULA_LIBRARY_HPP
+
+#include "errors.hpp"
+#include "functions.hpp"
+#include "symbols.hpp"
+#include "token.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace edacal {
+
+// Formulas con nombre (la posfija que definio cada variable) y la ultima
+// expresion evaluada. save/load usan un snapshot binario versionado y con
+// checksum que incluye tambien la SymbolTable; load lo mapea en memoria y
+// solo decodifica una formula cuando se pide. load valida el archivo entero
+// antes de cambiar nada y mezcla: las variables y formulas del snapshot
+// reemplazan a las del mismo nombre y las demas se conservan.
+class FormulaLibrary {
+public:
+    static const std::uint32_t kSnapshotVersion = 1;
+
+    FormulaLibrary();
+    explicit FormulaLibrary(const FunctionRegistry& functions);
+    ~FormulaLibrary();
+
+    FormulaLibrary(const FormulaLibrary&) = delete;
+    FormulaLibrary& operator=(const FormulaLibrary&) = delete;
+
+    void define(const std::string& name, const TokenList& postfix);
+    bool has(const std::string& name) const;
+    TokenList get(const std::string& name) const;
+    std::size_t size() const;
+
+    void setLast(const TokenList& postfix);
+    bool hasLast() const;
+    TokenList last() const;
+
+    void save(const std::string& path, const SymbolTable& symbols) const;
+    void load(const std::string& path, SymbolTable& symbols);
+
+    // Registro de un token tal como queda en el archivo.
+    struct FlatToken {
+        std::uint32_t type;
+        std::uint32_t textOffset;
+        std::uint32_t textLength;
+        std::uint32_t reserved;
+        double value;
+    };
+
+private:
+    struct Code {
+        std::vector<FlatToken> tokens;
+        std::string text;
+    };
+
+    struct MappedFormula {
+        std::uint32_t nameOffset;
+        std::uint32_t nameLength;
+        std::uint32_t firstToken;
+        std::uint32_t tokenCount;
+    };
+
+    const FunctionRegistry* functions_;
+    std::unordered_map<std::string, Code> defined_;
+    Code last_;
+    bool hasLast_;
+
+    void* mapping_;
+    std::size_t mappingSize_;
+    const MappedFormula* mappedFormulas_;
+    std::size_t mappedCount_;
+    const FlatToken* mappedTokens_;
+    const char* mappedText_;
+    std::size_t mappedTextSize_;
+
+    static Code encode(const TokenList& postfix);
+    TokenList decode(const FlatToken* tokens, std::size_t count, const char* text,
+                             std::size_t textSize) const;
+    const MappedFormula* findMapped(const std::string& name) const;
+    // Busqueda binaria en una tabla de formulas ordenada por nombre.
+    static const MappedFormula* findIn(const MappedFormula* formulas, std::size_t count, const char* text,
+                                       const std::string& name);
+    std::string mappedName(const MappedFormula& formula) const;
+    void unmap();
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef EDACAL_FUNCTIONS_HPP
+#define EDACAL_FUNCTIONS_HPP
+
+#include "errors.hpp"
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+namespace edacal {
+
+struct Function {
+    // Tree::Node solo tiene hijos izquierdo y derecho.
+    static const std::size_t kMaxArity = 2;
+
+    typedef double (*Impl)(const double* args);
+    // Si existe, dice si `impl` acepta los argumentos; permite reportar el
+    // error de dominio sin que `impl` lance (ver Evaluator sin excepciones).
+    typedef bool (*Domain)(const double* args);
+
+    std::string name;
+    std::size_t arity;
+    bool pure;
+    Impl impl;
+    Domain domain;
+    const char* domainError;
+};
+
+class FunctionRegistry {
+public:
+    FunctionRegistry() = default;
+
+    // Registro compartido con sqrt, exp, log, sin, cos, abs, min, max e hypot.
+    static const FunctionRegistry& builtins();
+
+    void add(const std::string& name, std::size_t arity, bool pure, Function::Impl impl,
+             Function::Domain domain = nullptr, const char* domainError = nullptr);
+    const Function* find(const std::string& name) const;
+
+private:
+    std::unordered_map<std::string, Function> functions_;
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef EDACAL_INTERVAL_EVALUATOR_HPP
+#define EDACAL_INTERVAL_EVALUATOR_HPP
+
+#include "errors.hpp"
+#include "functions.hpp"
+#include "symbols.hpp"
+#include "token.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace edacal {
+
+struct Interval {
+    double lo;
+    double hi;
+
+    static Interval point(double value) { return Interval{value, value}; }
+    double mid() const { return 0.5 * lo + 0.5 * hi; }
+    double radius() const { return 0.5 * (hi - lo); }
+    bool contains(double value) const { return lo <= value && value <= hi; }
+};
+
+// Evalua la misma posfija que Evaluator propagando intervalos en una sola
+// pasada. + - * / sqrt usan redondeo dirigido exacto; exp, log, pow, sin,
+// cos, hypot y las potencias enteras se amplian hacia afuera segun su cota
+// de error en ULP. El resultado contiene el valor exacto para cualquier
+// entrada dentro de los intervalos. Las variables ausentes de `inputs` son puntos
+// tomados de la SymbolTable.
+class IntervalEvaluator {
+public:
+    typedef std::unordered_map<std::string, Interval> Inputs;
+
+    IntervalEvaluator() = default;
+
+    Interval evalPostfix(const TokenList& postfix, SymbolTable& symbols, const Inputs& inputs) const;
+
+private:
+    Interval applyFunction(const Function* fn, const Interval* args) const;
+};
+
+} // namespace edacal
+
+#endif
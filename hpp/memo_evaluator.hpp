@@ -0,0 +1,95 @@
+#ifndef EDACAL_MEMO_EVALUATOR_HPP
+#define EDACAL_MEMO_EVALUATOR_HPP
+
+#include "errors.hpp"
+#include "functions.hpp"
+#include "symbols.hpp"
+#include "token.hpp"
+#include "tree.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace edacal {
+
+// Evaluacion incremental de un mismo arbol: cada nodo guarda su ultimo
+// valor y, al reevaluar, solo se recalculan los nodos que estan sobre una
+// variable que cambio desde la evaluacion anterior (o sobre una funcion no
+// pura). Para saber que variables cambiaron se compara la version que les da
+// SymbolTable::set; las que vienen de SharedSymbols, sin version local, se
+// comparan por valor.
+//
+// Los nodos se recalculan en postorden con la misma aritmetica que
+// Evaluator, asi que el resultado es identico bit a bit al de evaluar la
+// posfija del arbol. Ante un error se evalua esa posfija con Evaluator para
+// reportar el mismo Error; los valores guardados siguen validos. Los arboles
+// con sumas compensadas (SumMark) se evaluan siempre enteros.
+class MemoEvaluator {
+public:
+    struct Stats {
+        std::size_t evaluations;
+        // Nodos cuyo valor se tomo de la evaluacion anterior y nodos recalculados.
+        std::size_t reused;
+        std::size_t recomputed;
+
+        double hitRate() const;
+    };
+
+    explicit MemoEvaluator(const Tree& tree);
+
+    double evaluate(const SymbolTable& symbols);
+    bool evaluate(const SymbolTable& symbols, double& result, Error& error);
+
+    const Stats& stats() const { return stats_; }
+    void resetStats();
+    std::size_t nodeCount() const { return nodes_.size(); }
+
+private:
+    static const std::uint32_t kNone = 0xffffffffu;
+
+    // Nodos en postorden: los hijos siempre antes que el padre. Solo lo que
+    // hace falta para recalcular; los tokens completos quedan en postfix_.
+    struct Node {
+        TokenType type;
+        std::uint32_t left;
+        std::uint32_t right;
+        std::uint32_t parent;
+        // Indice en variables_ de las hojas IDENT/ANS.
+        std::uint32_t variable;
+        // Valor de un NUMBER o exponente de un POWI.
+        double constant;
+        const Function* function;
+    };
+
+    struct Variable {
+        std::string name;
+        std::vector<std::uint32_t> leaves;
+        std::uint64_t version;
+        double value;
+        bool seen;
+    };
+
+    bool isDirty(std::uint32_t node) const { return (dirty_[node >> 6] >> (node & 63)) & 1u; }
+    void invalidate(std::uint32_t node);
+    bool recompute(std::uint32_t index);
+    bool fallback(const SymbolTable& symbols, double& result, Error& error) const;
+
+    std::vector<Node> nodes_;
+    std::vector<double> values_;
+    std::vector<Variable> variables_;
+    // Nodos con funciones no puras, que se recalculan siempre.
+    std::vector<std::uint32_t> impure_;
+    // Un bit por nodo: los que hay que recalcular. Si un nodo esta marcado,
+    // tambien lo estan todos sus ancestros.
+    std::vector<std::uint64_t> dirty_;
+    std::size_t dirtyCount_;
+    TokenList postfix_;
+    bool incremental_;
+    Stats stats_;
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef EDACAL_NUMERIC_HPP
+#define EDACAL_NUMERIC_HPP
+
+#include "functions.hpp"
+#include "printer.hpp"
+#include "rational.hpp"
+#include "token.hpp"
+#include "vecmath.hpp"
+
+#include <cmath>
+#include <string>
+
+namespace edacal {
+
+// Lo que el pipeline de evaluacion necesita de un tipo numerico. La
+// especializacion para double se reduce a las mismas llamadas que antes de
+// que Evaluator fuera una plantilla.
+template <typename T>
+struct NumericTraits;
+
+template <>
+struct NumericTraits<double> {
+    static constexpr double kMaxIndex = 9007199254740992.0; // 2^53
+    static double fromLiteral(const Token& token) { return token.value; }
+    static double fromDouble(double value) { return value; }
+    static bool isZero(double value) { return value == 0.0; }
+    // Limite de sum/prod: entero y representable sin perder unidades.
+    static bool toIndex(double value, long& index) {
+        if (!(std::fabs(value) <= kMaxIndex) || value != std::floor(value)) {
+            return false;
+        }
+        index = static_cast<long>(value);
+        return true;
+    }
+    static double pow(double base, double exponent) { return std::pow(base, exponent); }
+    static double powi(double base, long exponent) { return vecmath::powi(base, exponent); }
+    static double call(const Function* fn, const double* args) { return fn->impl(args); }
+    static std::string format(double value) { return formatNumber(value); }
+};
+
+// Aritmetica exacta: los literales se leen del lexema (0.1 es 1/10), las
+// potencias exigen exponente entero y de las funciones solo estan las que
+// tienen resultado racional (abs, min, max y sqrt de cuadrados perfectos).
+template <>
+struct NumericTraits<Rational> {
+    static const long kMaxExponent = 4096;
+
+    static Rational fromLiteral(const Token& token) { return Rational::parseDecimal(token.lexeme); }
+    static Rational fromDouble(double value) { return Rational::fromDouble(value); }
+    static bool isZero(const Rational& value) { return value.isZero(); }
+    static bool toIndex(const Rational& value, long& index) {
+        return value.isInteger() && NumericTraits<double>::toIndex(value.toDouble(), index);
+    }
+    static Rational pow(const Rational& base, const Rational& exponent);
+    static Rational powi(const Rational& base, long exponent) { return base.pow(exponent); }
+    static Rational call(const Function* fn, const Rational* args);
+    static std::string format(const Rational& value) { return value.toString(); }
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef EDACAL_OPTIMIZER_HPP
+#define EDACAL_OPTIMIZER_HPP
+
+#include "errors.hpp"
+#include "evaluator.hpp"
+#include "token.hpp"
+#include "tree.hpp"
+
+namespace edacal {
+
+class Optimizer {
+public:
+    Optimizer() = default;
+
+    // Reemplaza por NUMBER los subarboles cuyos operandos son constantes y
+    // cuyas funciones son puras. Los que fallarian (division por cero,
+    // sqrt negativo) se dejan intactos para que el error salga al evaluar.
+    void foldConstants(Tree& tree) const;
+
+    // Cambia `x ^ n` con n entero constante (|n| <= vecmath::kMaxIntegerExponent)
+    // por un nodo POWI que se evalua por cuadrados sucesivos; si n < 0 se toma
+    // el reciproco. El resultado difiere de std::pow en a lo sumo |n| ULP.
+    void lowerIntegerPowers(Tree& tree) const;
+
+    enum class Summation { Plain, Compensated };
+
+    // "fast-math", opcional: reemplaza cada cadena de `+` o de `*` de tres o
+    // mas operandos (a + b + c + ..., que el Parser arma como un peine
+    // izquierdo) por un arbol balanceado de profundidad O(log n) con los
+    // mismos operandos en el mismo orden. Cambia el redondeo: la suma queda
+    // en orden por pares. Con Summation::Compensated las sumas se marcan
+    // (SumMark) y Evaluator/ParallelEvaluator corrigen el error con Neumaier.
+    // Iterativo, apto para cadenas de millones de operandos.
+    void reassociate(Tree& tree, Summation summation = Summation::Plain) const;
+
+    // Recorre el arbol en postorden y devuelve la posfija equivalente.
+    TokenList toPostfix(const Tree& tree) const;
+
+    // Lo que se aplica a cada expresion al compilarla (Session::compile,
+    // edacal_compile): foldConstants y lowerIntegerPowers sobre el arbol de
+    // la posfija y, con `fastMath` (`reasoc on` en el REPL), reassociate.
+    // Devuelve la posfija sin cambios si no tiene arbol (sum/prod). Todas las
+    // pasadas son iterativas, asi que no hay limite de tamano.
+    TokenList optimize(const TokenList& postfix, bool fastMath = false) const;
+
+private:
+    void foldNode(Tree::Node* node) const;
+    void lowerNode(Tree::Node* node) const;
+    void collectPostfix(const Tree::Node* node, TokenList& output) const;
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef EDACAL_PARALLEL_EVALUATOR_HPP
+#define EDACAL_PARALLEL_EVALUATOR_HPP
+
+#include "errors.hpp"
+#include "symbols.hpp"
+#include "tree.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace edacal {
+
+// Evalua un arbol muy grande repartiendo subarboles independientes entre un
+// pool de hilos. Los cortes salen de Tree::Node::size: los subarboles de a
+// lo sumo `grain` nodos se evaluan en los hilos y los nodos de encima se
+// combinan en el hilo que llama, en el mismo orden posfijo que Evaluator.
+// Cada valor se calcula con las mismas operaciones que la evaluacion
+// secuencial, asi que el resultado y el primer error son identicos bit a
+// bit con cualquier numero de hilos.
+class ParallelEvaluator {
+public:
+    // Debajo de este tamano (por defecto) el arbol se evalua entero en el
+    // hilo que llama.
+    static const std::size_t kMinParallelNodes = 1 << 14;
+    // Tareas por hilo: mas tareas reparten mejor subarboles de costo desigual.
+    static const std::size_t kTasksPerThread = 8;
+
+    // `threads` cuenta el hilo que llama; 0 usa hardware_concurrency().
+    // `minNodes` chico reparte tambien arboles pequenos (bench/fuzz lo usa
+    // para comparar el camino paralelo con expresiones al azar).
+    explicit ParallelEvaluator(std::size_t threads = 0, std::size_t minNodes = kMinParallelNodes);
+    ~ParallelEvaluator();
+
+    ParallelEvaluator(const ParallelEvaluator&) = delete;
+    ParallelEvaluator& operator=(const ParallelEvaluator&) = delete;
+
+    double evaluate(const Tree& tree, const SymbolTable& symbols);
+    // Sin excepciones, con el mismo Error que daria Evaluator sobre la posfija.
+    bool evaluate(const Tree& tree, const SymbolTable& symbols, double& result, Error& error);
+
+    std::size_t threads() const { return workers_.size() + 1; }
+
+private:
+    struct Job;
+
+    void workerLoop();
+    static void runTasks(Job& job);
+
+    std::vector<std::thread> workers_;
+    std::size_t minNodes_;
+    std::mutex evaluateMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Job* job_;
+    std::size_t generation_;
+    std::size_t busy_;
+    bool stopping_;
+};
+
+} // namespace edacal
+
+#endif
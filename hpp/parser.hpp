@@ -1,11 +1,11 @@
 #ifndef EDACAL_PARSER_HPP
 #define EDACAL_PARSER_HPP
 
-#include "linked_list.hpp"
 #include "stack.hpp"
 #include "token.hpp"
 #include "tree.hpp"
 #include "errors.hpp"
+#include "functions.hpp"
 
 namespace edacal {
 
@@ -13,10 +13,16 @@ class Parser {
 public:
     Parser() = default;
 
-    LinkedList<Token> toPostfix(const LinkedList<Token>& tokens) const;
-    Tree buildTreeFromPostfix(const LinkedList<Token>& postfix) const;
+    TokenList toPostfix(const TokenList& tokens) const;
+    // Version sin excepciones de toPostfix: false y el error en `error`.
+    bool toPostfix(const TokenList& tokens, TokenList& output, Error& error) const;
+    Tree buildTreeFromPostfix(const TokenList& postfix) const;
 
 private:
+    // sum(...) y prod(...) desde el token de la palabra clave hasta su ')',
+    // que queda en `it`; ver TokenType::SUM para la forma de la salida.
+    bool reductionToPostfix(TokenList::ConstIterator& it, TokenList::ConstIterator end, TokenList& output,
+                            Error& error) const;
     static int precedence(TokenType type);
     static bool isRightAssociative(TokenType type);
     static bool isFunction(TokenType type);
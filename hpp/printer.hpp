@@ -1,7 +1,6 @@
 #ifndef EDACAL_PRINTER_HPP
 #define EDACAL_PRINTER_HPP
 
-#include "linked_list.hpp"
 #include "token.hpp"
 #include "tree.hpp"
 
@@ -17,13 +16,11 @@ class Printer {
 public:
     Printer() = default;
 
+    // Los tres recorren sin recursion, arman la salida en un buffer y vacian
+    // el stream una sola vez al final.
     void printTree(const Tree& tree, std::ostream& os) const;
-    void printPostfix(const LinkedList<Token>& tokens, std::ostream& os) const;
+    void printPostfix(const TokenList& tokens, std::ostream& os) const;
     void printPrefix(const Tree& tree, std::ostream& os) const;
-
-private:
-    void printTreeNode(const Tree::Node* node, const std::string& prefix, bool isLeft, std::ostream& os) const;
-    void collectPrefix(const Tree::Node* node, LinkedList<std::string>& output) const;
 };
 
 } // namespace edacal
@@ -0,0 +1,57 @@
+#ifndef EDACAL_RATIONAL_HPP
+#define EDACAL_RATIONAL_HPP
+
+#include "bigint.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace edacal {
+
+// Racional exacto siempre normalizado (fraccion irreducible, denominador
+// positivo). Con numerador y denominador pequenos no reserva memoria.
+class Rational {
+public:
+    Rational();
+    Rational(std::int64_t value);
+    Rational(const BigInt& numerator, const BigInt& denominator);
+
+    // Literal decimal como los que acepta el Tokenizer ("12", "0.1", ".5").
+    static Rational parseDecimal(const std::string& text);
+    // Valor exacto del double (todo double finito es un racional diadico).
+    static Rational fromDouble(double value);
+
+    const BigInt& numerator() const { return numerator_; }
+    const BigInt& denominator() const { return denominator_; }
+
+    bool isZero() const { return numerator_.isZero(); }
+    bool isInteger() const { return denominator_ == BigInt(1); }
+    bool isNegative() const { return numerator_.isNegative(); }
+    int compare(const Rational& other) const;
+
+    Rational operator-() const;
+    friend Rational operator+(const Rational& a, const Rational& b);
+    friend Rational operator-(const Rational& a, const Rational& b);
+    friend Rational operator*(const Rational& a, const Rational& b);
+    friend Rational operator/(const Rational& a, const Rational& b);
+    Rational pow(long exponent) const;
+
+    bool operator==(const Rational& other) const { return compare(other) == 0; }
+    bool operator<(const Rational& other) const { return compare(other) < 0; }
+
+    double toDouble() const;
+    // "n" si es entero, "n/d" si no.
+    std::string toString() const;
+
+private:
+    BigInt numerator_;
+    BigInt denominator_;
+
+    void normalize();
+    // Para fracciones que ya se sabe irreducibles (p. ej. potencias de una).
+    static Rational reduced(const BigInt& numerator, const BigInt& denominator);
+};
+
+} // namespace edacal
+
+#endif
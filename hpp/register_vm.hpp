@@ -0,0 +1,102 @@
+#ifndef EDACAL_REGISTER_VM_HPP
+#define EDACAL_REGISTER_VM_HPP
+
+#include "errors.hpp"
+#include "functions.hpp"
+#include "symbols.hpp"
+#include "token.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace edacal {
+
+// Compila una posfija una vez a codigo de registros y la evalua muchas
+// veces. Constantes, variables y resultados intermedios viven en un mismo
+// arreglo de valores y cada instruccion lee sus operandos de ahi
+// directamente, asi `x + 2`, `x * y` o `-x` son una sola instruccion sin
+// apilar ni desapilar. POWI 2 (ver Optimizer::lowerIntegerPowers) se
+// ejecuta como SQUARE y select es una sola instruccion SELECT, sin saltos
+// que dependan de la condicion. Con GCC/Clang el despacho es por goto computado y si
+// no, por switch.
+//
+// Las operaciones son las mismas y en el mismo orden que en Evaluator, asi
+// que el resultado es identico bit a bit. Ante cualquier error (variable no
+// definida, division por cero, dominio) la posfija se evalua con Evaluator
+// para reportar el mismo Error. sum/prod y las sumas compensadas no se
+// compilan: esas posfijas se evaluan siempre con Evaluator.
+class RegisterVM {
+public:
+    explicit RegisterVM(const TokenList& postfix);
+
+    double evaluate(const SymbolTable& symbols) const;
+    bool evaluate(const SymbolTable& symbols, double& result, Error& error) const;
+    // Con los valores de las variables ya resueltos, en el orden de
+    // variables(), sin buscar en una tabla. false ante cualquier error o si
+    // no esta compilada; el Error se obtiene evaluando con una SymbolTable.
+    bool evaluate(const double* values, double& result) const;
+
+    // Variables que lee la posfija compilada (vacio si no esta compilada).
+    const std::vector<std::string>& variables() const { return variables_; }
+
+    // false si la posfija se evalua con Evaluator (ver arriba).
+    bool compiled() const { return compiled_; }
+    std::size_t instructionCount() const { return code_.size(); }
+    // Constantes + variables + registros temporales.
+    std::size_t slotCount() const { return slots_; }
+
+private:
+    enum Opcode : std::uint8_t {
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        POW,
+        POWI,
+        SQUARE,
+        NEG,
+        CALL1,
+        CALL2,
+        LT,
+        LE,
+        GT,
+        GE,
+        EQ,
+        SELECT,
+        HALT
+    };
+
+    struct Instruction {
+        Opcode op;
+        std::uint32_t dst;
+        std::uint32_t a;
+        std::uint32_t b;
+        // Rama de select cuando la condicion `a` es 0 (la otra es `b`).
+        std::uint32_t c;
+        long exponent;
+        const Function* function;
+    };
+
+    // Valores locales de evaluate() que caben sin pedir memoria.
+    static const std::size_t kInlineSlots = 64;
+
+    bool compile(const TokenList& postfix);
+    bool run(double* slots) const;
+    // Corre el codigo sobre `slots`, con constantes y variables ya cargadas.
+    bool execute(double* slots, double& result) const;
+    bool fallback(const SymbolTable& symbols, double& result, Error& error) const;
+
+    TokenList postfix_;
+    bool compiled_;
+    std::vector<Instruction> code_;
+    std::vector<double> constants_;
+    std::vector<std::string> variables_;
+    std::size_t slots_;
+    std::uint32_t result_;
+};
+
+} // namespace edacal
+
+#endif
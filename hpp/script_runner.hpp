@@ -0,0 +1,52 @@
+#ifndef EDACAL_SCRIPT_RUNNER_HPP
+#define EDACAL_SCRIPT_RUNNER_HPP
+
+#include "session.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace edacal {
+
+// Ejecuta un script como tuberia de hilos: uno lee lineas, `workers` hilos
+// las tokenizan y pasan a posfija (Session::compile) por adelantado, el
+// hilo que llama las aplica en orden (Session::apply) y otro escribe la
+// salida. Las etapas se comunican por colas acotadas sin locks, asi que la
+// lectura y el analisis de las lineas siguientes se solapan con la
+// evaluacion. La salida es identica byte a byte a la del bucle del REPL
+// sobre la misma entrada, prompts incluidos.
+//
+// El lector se adelanta hasta kWindow lineas: tras `exit` se descarta lo
+// leido de mas, pero la entrada queda consumida hasta ese punto. Pensado
+// para archivos y tuberias, no para una terminal interactiva.
+class ScriptRunner {
+public:
+    // Lineas en vuelo entre el lector y el evaluador.
+    static const std::size_t kWindow = 1024;
+
+    // `workers` hilos de analisis; 0 usa hardware_concurrency().
+    explicit ScriptRunner(Session& session, std::size_t workers = 0);
+
+    ScriptRunner(const ScriptRunner&) = delete;
+    ScriptRunner& operator=(const ScriptRunner&) = delete;
+
+    // Procesa `in` hasta el final o hasta `exit`; devuelve false con `exit`.
+    // Una excepcion que no sea EdaError detiene la tuberia y se relanza aqui.
+    bool run(std::istream& in, std::ostream& out);
+
+    std::size_t workers() const { return workers_; }
+
+private:
+    struct Pipeline;
+
+    static void readLines(Pipeline& pipeline, std::istream& in);
+    static void compileLines(Pipeline& pipeline, const Session& session);
+    static void writeOutput(Pipeline& pipeline, std::ostream& out);
+
+    Session& session_;
+    std::size_t workers_;
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef EDACAL_SERVER_HPP
+#define EDACAL_SERVER_HPP
+
+#include "errors.hpp"
+#include "session.hpp"
+#include "shared_symbols.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace edacal {
+
+// Servidor sobre un socket Unix que habla el mismo protocolo de lineas que el
+// REPL (bienvenida, prompt ">> " tras cada respuesta). Cada conexion tiene su
+// propia Session. Un epoll compartido reparte las conexiones entre `threads`
+// hilos; EPOLLONESHOT garantiza que una conexion la atiende un hilo a la vez.
+// `global x` publica una variable de la sesion en `shared_`, visible para todas.
+class Server {
+public:
+    Server(const std::string& socketPath, std::size_t threads);
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // Bloquea hasta que se llama a stop() (desde otro hilo o un manejador de senales).
+    void run();
+    void stop();
+
+private:
+    struct Connection;
+
+    std::string path_;
+    std::size_t threads_;
+    int listenFd_;
+    int epollFd_;
+    int wakeFd_;
+    std::atomic<bool> stopping_;
+    SharedSymbols shared_;
+    std::mutex connectionsMutex_;
+    std::unordered_set<Connection*> connections_;
+
+    void workerLoop();
+    void acceptClients();
+    void serviceClient(Connection* conn, std::uint32_t events);
+    bool flush(Connection* conn);
+    void rearm(int fd, void* data, std::uint32_t events);
+    void closeClient(Connection* conn);
+};
+
+} // namespace edacal
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef EDACAL_SESSION_HPP
+#define EDACAL_SESSION_HPP
+
+#include "autodiff.hpp"
+#include "derivative.hpp"
+#include "evaluator.hpp"
+#include "formula_library.hpp"
+#include "interval_evaluator.hpp"
+#include "memo_evaluator.hpp"
+#include "optimizer.hpp"
+#include "parser.hpp"
+#include "printer.hpp"
+#include "rational.hpp"
+#include "shared_symbols.hpp"
+#include "symbols.hpp"
+#include "tokenizer.hpp"
+#include "tree.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+
+namespace edacal {
+
+// Estado de una sesion del REPL: variables, formulas y la ultima expresion.
+// La usan tanto la consola como cada conexion del servidor; en el servidor
+// las sesiones leen ademas las variables publicadas con `global`.
+class Session {
+public:
+    Session();
+    // Con `files` en false, save y load responden con un error: las sesiones
+    // del servidor no deben leer ni escribir archivos por pedido de un cliente.
+    explicit Session(SharedSymbols* shared, bool files = true);
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    // Linea preparada por compile(): los comandos quedan como texto y las
+    // expresiones ya tokenizadas y en posfija, o con su error de sintaxis.
+    struct CompiledLine {
+        enum class Kind { EMPTY, COMMAND, EXPRESSION, ERROR };
+        Kind kind;
+        std::string text;   // linea recortada (COMMAND) o mensaje (ERROR)
+        std::string target; // variable asignada; vacia si no hay asignacion
+        std::size_t indent; // espacios antes de la linea, para las columnas de error
+        // Como se escribio: la guarda la sesion para tree, postfix, prefix,
+        // deriv y bounds, y la evalua el modo racional.
+        TokenList postfix;
+        // La que se evalua con double, con Optimizer::optimize aplicado.
+        TokenList optimized;
+        // Si `optimized` se compilo con `reasoc on`.
+        bool reassociated;
+    };
+
+    // Procesa una linea y escribe la respuesta en `out`; devuelve false con `exit`.
+    // Equivale a apply(compile(line)).
+    bool handleLine(const std::string& line, std::ostream& out);
+
+    // Tokeniza y pasa a posfija sin tocar el estado de la sesion, asi que
+    // puede llamarse desde varios hilos a la vez mientras otro hilo aplica.
+    CompiledLine compile(const std::string& line) const;
+    // Ejecuta una linea compilada; las lineas deben aplicarse en orden.
+    bool apply(CompiledLine& line, std::ostream& out);
+
+    void loadSnapshot(const std::string& path);
+
+private:
+    static bool isCommand(const std::string& word);
+    bool handleCommand(const std::string& trimmed, std::ostream& out);
+    void handleBounds(std::istream& args, std::ostream& out);
+    void handleGrad(std::istream& args, std::ostream& out);
+    void handleDeriv(std::istream& args, std::ostream& out);
+    void handleMemo(std::istream& args, std::ostream& out);
+    void handleReassociate(std::istream& args, std::ostream& out);
+    double evaluateMemo(const TokenList& postfix, const TokenList& optimized);
+    void clearMemos();
+    const Tree& lastTree();
+    void setLast(TokenList&& postfix);
+    void syncToExact();
+    void syncToDouble();
+
+    Tokenizer tokenizer_;
+    Parser parser_;
+    Evaluator evaluator_;
+    IntervalEvaluator intervals_;
+    GradientEvaluator gradients_;
+    Differentiator differentiator_;
+    Optimizer optimizer_;
+    Printer printer_;
+    SharedSymbols* shared_;
+    bool files_;
+    SymbolTable symbols_;
+    FormulaLibrary formulas_;
+    std::unordered_map<std::string, double> tolerances_;
+
+    // La ultima expresion se guarda solo como posfija (movida, sin copiar);
+    // el arbol se construye cuando un comando lo pide y queda memorizado
+    // hasta la siguiente expresion.
+    TokenList lastPostfix_;
+    bool hasLast_;
+    Tree lastTree_;
+    bool treeBuilt_;
+
+    // `memo on`: cada expresion distinta (por su posfija) se evalua con un
+    // MemoEvaluator propio, que al repetirse la linea solo recalcula lo que
+    // depende de variables cambiadas. Se guardan a lo sumo kMaxMemos arboles.
+    static const std::size_t kMaxMemos = 256;
+    bool memo_;
+    std::unordered_map<std::string, MemoEvaluator> memos_;
+    MemoEvaluator::Stats memoTotals_;
+
+    // `reasoc on`: Optimizer::optimize aplica tambien reassociate. compile()
+    // puede correr por adelantado en otros hilos (ScriptRunner), asi que lee
+    // el valor vigente y apply() recompila las lineas que lo leyeron antes
+    // del cambio.
+    std::atomic<bool> reassociate_;
+
+    // `modo racional`: las expresiones se evaluan con aritmetica exacta sobre
+    // su propia tabla de variables. Al cambiar de modo se copian a la otra
+    // tabla las variables que cambiaron desde el ultimo cambio (version mayor
+    // que la registrada), asi un valor exacto no se redondea por ir y volver.
+    bool exact_;
+    BasicEvaluator<Rational> exactEvaluator_;
+    BasicSymbolTable<Rational> exactSymbols_;
+    std::uint64_t doubleSynced_;
+    std::uint64_t exactSynced_;
+};
+
+} // namespace edacal
+
+#endif
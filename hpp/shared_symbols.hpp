@@ -0,0 +1,58 @@
+#ifndef EDACAL_SHARED_SYMBOLS_HPP
+#define EDACAL_SHARED_SYMBOLS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace edacal {
+
+// Variables compartidas entre hilos para el caso de muchas lecturas y pocas
+// escrituras. Los lectores no toman ningun lock: buscan en una tabla de
+// direccionamiento abierto cuyos nombres y valores se publican de forma
+// atomica. Los escritores se serializan con un mutex; al crecer, la tabla
+// nueva se publica de una vez y la anterior se retira hasta la destruccion
+// (los nombres nunca se borran, asi que no hace falta mas reclamacion).
+class SharedSymbols {
+public:
+    SharedSymbols();
+    ~SharedSymbols();
+
+    SharedSymbols(const SharedSymbols&) = delete;
+    SharedSymbols& operator=(const SharedSymbols&) = delete;
+
+    bool lookup(const std::string& name, double& value) const;
+    void set(const std::string& name, double value);
+    std::size_t size() const;
+
+private:
+    struct Slot {
+        std::atomic<const std::string*> name;
+        std::atomic<std::uint64_t> bits;
+    };
+
+    struct Table {
+        std::size_t mask;
+        Slot* slots;
+    };
+
+    std::atomic<Table*> table_;
+    std::atomic<std::size_t> count_;
+    std::mutex writeMutex_;
+    std::deque<std::string> names_;
+    std::vector<Table*> retired_;
+
+    static Table* makeTable(std::size_t capacity);
+    // `current` es el nombre que se leyo en el slot devuelto: nullptr si esta
+    // libre o uno igual a `name`. Un lector debe usar esa lectura y no volver
+    // a cargar el nombre, que un escritor puede publicar entre medio.
+    static Slot* probe(const Table* table, const std::string& name, const std::string*& current);
+};
+
+} // namespace edacal
+
+#endif
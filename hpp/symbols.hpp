@@ -3,23 +3,54 @@
 
 #include "errors.hpp"
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 
 namespace edacal {
 
-class SymbolTable {
+class SharedSymbols;
+
+// Variables de una sesion. Con `shared`, las que no estan definidas
+// localmente se buscan ahi (sin lock); `set` siempre escribe en la tabla
+// local, asi `ans` y las asignaciones quedan privadas a la sesion.
+//
+// Cada `set` le da a la variable una version nueva (un contador de la tabla
+// que solo crece), asi MemoEvaluator sabe que valores cambiaron sin
+// compararlos. Las variables que vienen de `shared` no tienen version local.
+//
+// El tipo de los valores es el del pipeline (ver NumericTraits); SymbolTable
+// es la version con double.
+template <typename T>
+class BasicSymbolTable {
 public:
-    SymbolTable();
+    typedef typename std::unordered_map<std::string, T>::const_iterator const_iterator;
+
+    BasicSymbolTable();
+    explicit BasicSymbolTable(const SharedSymbols* shared);
 
     bool has(const std::string& name) const;
-    double get(const std::string& name) const;
-    void set(const std::string& name, double value);
+    T get(const std::string& name) const;
+    // Como get, pero devuelve false en vez de lanzar si no esta definida.
+    bool find(const std::string& name, T& value) const;
+    // Como find, y ademas la version de la variable; 0 si no esta definida
+    // en esta tabla (no existe o viene de `shared`).
+    bool find(const std::string& name, T& value, std::uint64_t& version) const;
+    void set(const std::string& name, const T& value);
+
+    std::size_t size() const;
+    const_iterator begin() const;
+    const_iterator end() const;
 
 private:
-    std::unordered_map<std::string, double> symbols_;
+    std::unordered_map<std::string, T> symbols_;
+    std::unordered_map<std::string, std::uint64_t> versions_;
+    std::uint64_t clock_;
+    const SharedSymbols* shared_;
 };
 
+typedef BasicSymbolTable<double> SymbolTable;
+
 } // namespace edacal
 
 #endif
@@ -1,11 +1,16 @@
 #ifndef EDACAL_TOKEN_HPP
 #define EDACAL_TOKEN_HPP
 
+#include "chunked_list.hpp"
+
+#include <cstddef>
 #include <string>
 #include <utility>
 
 namespace edacal {
 
+struct Function;
+
 enum class TokenType {
     NUMBER,
     IDENT,
@@ -16,23 +21,72 @@ enum class TokenType {
     POW,
     LPAREN,
     RPAREN,
-    SQRT,
+    COMMA,
+    FUNCTION,
     ASSIGN,
     ANS,
     END,
-    UNARY_MINUS
+    UNARY_MINUS,
+    POWI,
+    SUM,
+    PROD,
+    INDEX,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    EQUAL,
+    SELECT,
+    BRANCHES
 };
 
+// `column` es la posicion del token en la entrada (desde 0), para ubicar
+// los errores; los tokens creados fuera del Tokenizer quedan en 0.
 struct Token {
     TokenType type;
     std::string lexeme;
     double value;
+    const Function* function;
+    std::size_t column;
 
-    Token() : type(TokenType::END), lexeme(), value(0.0) {}
+    Token() : type(TokenType::END), lexeme(), value(0.0), function(nullptr), column(0) {}
     Token(TokenType t, std::string lex, double val = 0.0)
-        : type(t), lexeme(std::move(lex)), value(val) {}
+        : type(t), lexeme(std::move(lex)), value(val), function(nullptr), column(0) {}
+    Token(const Function* fn, std::string lex)
+        : type(TokenType::FUNCTION), lexeme(std::move(lex)), value(0.0), function(fn), column(0) {}
 };
 
+// sum(i, desde, hasta, cuerpo) y prod(...) quedan en la posfija como
+//     desde hasta SUM cuerpo
+// con `value` del SUM/PROD igual a la cantidad de tokens del cuerpo, que se
+// evalua una vez por cada i entero del rango sin expandirse. Dentro del
+// cuerpo las referencias al indice son tokens INDEX con `value` igual a la
+// profundidad del bucle (0 el mas externo de la expresion) y el nombre en
+// `lexeme`.
+
+// Las comparaciones dan 1 si se cumplen y 0 si no; con NaN no se cumple
+// ninguna. select(c, a, b) queda en la posfija como
+//     c a b SELECT
+// y vale a si c no es 0 y b si lo es. Las dos ramas se evaluan siempre (es
+// una mezcla, no un salto), asi que un error en cualquiera de ellas es un
+// error del select. Como el arbol es binario, en el Tree queda como
+//     SELECT(c, BRANCHES(a, b))
+// BRANCHES solo existe en el arbol: no tiene valor propio y no aparece en
+// la posfija (Optimizer::toPostfix lo omite).
+
+// Marca que Optimizer::reassociate deja en `value` de los PLUS de una cadena
+// rebalanceada con suma compensada, en el orden posfijo de la cadena: OPEN es
+// la primera suma que se ejecuta y CLOSE la raiz. Evaluator y ParallelEvaluator acumulan ahi el error de redondeo
+// (Neumaier) y lo suman al cerrar; los demas backends ven sumas normales.
+enum class SumMark { NONE = 0, OPEN = 1, INNER = 2, CLOSE = 3 };
+
+inline SumMark sumMark(const Token& token) {
+    return token.type == TokenType::PLUS ? static_cast<SumMark>(static_cast<int>(token.value)) : SumMark::NONE;
+}
+
+// Contenedor de tokens de todo el pipeline (Tokenizer, Parser, evaluadores).
+using TokenList = ChunkedList<Token>;
+
 inline bool isOperator(const Token& token) {
     switch (token.type) {
         case TokenType::PLUS:
@@ -41,12 +95,48 @@ inline bool isOperator(const Token& token) {
         case TokenType::DIV:
         case TokenType::POW:
         case TokenType::UNARY_MINUS:
+        case TokenType::POWI:
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+inline bool isComparison(TokenType type) {
+    switch (type) {
+        case TokenType::LESS:
+        case TokenType::LESS_EQUAL:
+        case TokenType::GREATER:
+        case TokenType::GREATER_EQUAL:
+        case TokenType::EQUAL:
             return true;
         default:
             return false;
     }
 }
 
+// Con solo < y == sirve para double, float y Rational por igual.
+template <typename T>
+bool compareValues(TokenType type, const T& left, const T& right) {
+    switch (type) {
+        case TokenType::LESS:
+            return left < right;
+        case TokenType::LESS_EQUAL:
+            return left < right || left == right;
+        case TokenType::GREATER:
+            return right < left;
+        case TokenType::GREATER_EQUAL:
+            return right < left || left == right;
+        default:
+            return left == right;
+    }
+}
+
 inline bool isValueToken(const Token& token) {
     switch (token.type) {
         case TokenType::NUMBER:
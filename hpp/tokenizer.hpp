@@ -2,7 +2,7 @@
 #define EDACAL_TOKENIZER_HPP
 
 #include "errors.hpp"
-#include "linked_list.hpp"
+#include "functions.hpp"
 #include "token.hpp"
 
 #include <string>
@@ -11,8 +11,16 @@ namespace edacal {
 
 class Tokenizer {
 public:
-    Tokenizer() = default;
-    LinkedList<Token> tokenize(const std::string& input) const;
+    Tokenizer();
+    explicit Tokenizer(const FunctionRegistry& functions);
+
+    TokenList tokenize(const std::string& input) const;
+    // Igual que tokenize, pero sin excepciones: devuelve false y deja en
+    // `error` el tipo y la columna del problema.
+    bool tokenize(const std::string& input, TokenList& tokens, Error& error) const;
+
+private:
+    const FunctionRegistry* functions_;
 };
 
 } // namespace edacal
@@ -3,6 +3,8 @@
 
 #include "token.hpp"
 
+#include <cstddef>
+
 namespace edacal {
 
 class Tree {
@@ -11,8 +13,11 @@ public:
         Token token;
         Node* left;
         Node* right;
+        // Nodos del subarbol (incluido este). Lo calcula Parser::buildTreeFromPostfix;
+        // en arboles armados o modificados por otras etapas es solo una estimacion.
+        std::size_t size;
 
-        explicit Node(const Token& tok) : token(tok), left(nullptr), right(nullptr) {}
+        explicit Node(const Token& tok) : token(tok), left(nullptr), right(nullptr), size(1) {}
     };
 
     Tree();
@@ -26,13 +31,15 @@ public:
 
     Node* getRoot() const;
     void setRoot(Node* node);
+    // Entrega la raiz sin liberar nada; el arbol queda vacio.
+    Node* release();
     bool empty() const;
     void clear();
 
 private:
     Node* root_;
 
-    void deleteSubtree(Node* node);
+    static void deleteSubtree(Node* node);
 };
 
 } // namespace edacal
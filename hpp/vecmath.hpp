@@ -0,0 +1,75 @@
+#ifndef EDACAL_VECMATH_HPP
+#define EDACAL_VECMATH_HPP
+
+#include <cstddef>
+
+namespace edacal {
+namespace vecmath {
+
+// Kernels sobre bloques de doubles. Las cotas se miden contra libm en
+// bench/vecmath.cpp (ULP = unidad en el ultimo lugar):
+//   sqrt            0 ULP en ambos modos (IEEE 754 la redondea correctamente).
+//   exp (Fast)      <= 2 ULP.
+//   log (Fast)      <= 1 ULP.
+//   powi(x, n)      <= |n| ULP: cada cuadrado duplica el error relativo. Con
+//                   n < 0, si x^|n| se sale del rango normal (se desborda o
+//                   queda subnormal) se usa std::pow, asi 1e155^-2 da 1e-310.
+//   pow (Fast)      exponente entero |n| <= 64: la cota de powi; en otro caso
+//                   <= 2 + 3|y * ln x| ULP, porque el error de log se amplifica por y.
+// Mode::Exact llama a std::exp/std::log/std::pow elemento a elemento y da
+// resultados identicos bit a bit a los del Evaluator escalar.
+enum class Mode {
+    Fast,
+    Exact
+};
+
+const long kMaxIntegerExponent = 64;
+
+double powi(double base, long exponent);
+
+void sqrt(const double* in, double* out, std::size_t n);
+void exp(const double* in, double* out, std::size_t n, Mode mode);
+void log(const double* in, double* out, std::size_t n, Mode mode);
+void powi(const double* base, long exponent, double* out, std::size_t n);
+void pow(const double* base, const double* exponent, double* out, std::size_t n, Mode mode);
+
+// Las mismas operaciones en float, con 4 carriles por registro SSE en vez de
+// 2. Cotas en ULP de float frente a libm en float: sqrt 0, exp (Fast) <= 2,
+// log (Fast) <= 2, powi <= |n| (con el mismo recurso a std::pow fuera del
+// rango normal), pow (Fast) <= 2 + 3|y * ln x|.
+float powi(float base, long exponent);
+
+void sqrt(const float* in, float* out, std::size_t n);
+void exp(const float* in, float* out, std::size_t n, Mode mode);
+void log(const float* in, float* out, std::size_t n, Mode mode);
+void powi(const float* base, long exponent, float* out, std::size_t n);
+void pow(const float* base, const float* exponent, float* out, std::size_t n, Mode mode);
+
+// Comparar, elegir y acotar sin saltos que dependan de los datos: cada
+// carril arma una mascara y se mezcla con and/andnot/or, asi el costo no
+// cambia con lo predecibles que sean las condiciones. compare deja 1 donde
+// se cumple y 0 donde no (con NaN no se cumple ninguna); select deja a[i]
+// donde cond[i] != 0 y b[i] donde no; min y max dan lo mismo que std::min y
+// std::max, tambien con NaN y ceros con signo. `out` puede ser una entrada.
+enum class Comparison {
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal
+};
+
+void compare(Comparison op, const double* a, const double* b, double* out, std::size_t n);
+void select(const double* cond, const double* a, const double* b, double* out, std::size_t n);
+void min(const double* a, const double* b, double* out, std::size_t n);
+void max(const double* a, const double* b, double* out, std::size_t n);
+
+void compare(Comparison op, const float* a, const float* b, float* out, std::size_t n);
+void select(const float* cond, const float* a, const float* b, float* out, std::size_t n);
+void min(const float* a, const float* b, float* out, std::size_t n);
+void max(const float* a, const float* b, float* out, std::size_t n);
+
+} // namespace vecmath
+} // namespace edacal
+
+#endif
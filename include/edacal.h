@@ -0,0 +1,100 @@
+/*
+ * API C de libedacal, para usar EdaCal dentro de otro proceso en vez de
+ * lanzar el binario y hablarle por su entrada estandar.
+ *
+ * Un contexto tiene su propia tabla de variables. Una expresion se compila
+ * una vez contra un contexto (a la maquina de registros, ver RegisterVM) y se
+ * evalua muchas veces: cada variable se lee de un puntero ligado con
+ * edacal_bind o, si no esta ligada, de la tabla del contexto en el momento
+ * de evaluar. Los resultados son identicos bit a bit a los del REPL.
+ *
+ * La biblioteca no tiene estado global: contextos distintos se pueden usar a
+ * la vez desde hilos distintos sin sincronizar nada. Un contexto y sus
+ * expresiones son de un solo hilo a la vez, y las expresiones se liberan
+ * antes que su contexto.
+ *
+ * Ninguna funcion lanza excepciones ni termina el proceso: los errores se
+ * devuelven como edacal_error_kind y, si se pasa un edacal_error, con la
+ * columna y el mensaje que daria el REPL.
+ */
+#ifndef EDACAL_H
+#define EDACAL_H
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define EDACAL_API __attribute__((visibility("default")))
+#else
+#define EDACAL_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct edacal_context edacal_context;
+typedef struct edacal_expr edacal_expr;
+
+/* En el mismo orden que edacal::ErrorKind. */
+typedef enum edacal_error_kind {
+    EDACAL_OK = 0,
+    EDACAL_ERROR_OTHER,
+    EDACAL_ERROR_INVALID_NUMBER,
+    EDACAL_ERROR_UNKNOWN_TOKEN,
+    EDACAL_ERROR_EXPECTED_CALL,
+    EDACAL_ERROR_OPERAND_EXPECTED,
+    EDACAL_ERROR_EMPTY_ARGUMENT,
+    EDACAL_ERROR_STRAY_COMMA,
+    EDACAL_ERROR_UNBALANCED_PARENS,
+    EDACAL_ERROR_ARGUMENT_COUNT,
+    EDACAL_ERROR_UNEXPECTED_ASSIGN,
+    EDACAL_ERROR_UNEXPECTED_TOKEN,
+    EDACAL_ERROR_INCOMPLETE_EXPRESSION,
+    EDACAL_ERROR_MISSING_OPERANDS,
+    EDACAL_ERROR_INVALID_EXPRESSION,
+    EDACAL_ERROR_DIVISION_BY_ZERO,
+    EDACAL_ERROR_UNDEFINED_VARIABLE,
+    EDACAL_ERROR_DOMAIN
+} edacal_error_kind;
+
+#define EDACAL_MESSAGE_SIZE 128
+
+/* `column` y `length` delimitan el fragmento de la expresion que causo el
+ * error; `message` es el texto del REPL, truncado a EDACAL_MESSAGE_SIZE - 1. */
+typedef struct edacal_error {
+    edacal_error_kind kind;
+    size_t column;
+    size_t length;
+    char message[EDACAL_MESSAGE_SIZE];
+} edacal_error;
+
+/* NULL si no hay memoria. */
+EDACAL_API edacal_context* edacal_context_new(void);
+EDACAL_API void edacal_context_free(edacal_context* context);
+
+/* Define o cambia una variable del contexto. Como en el REPL, `ans` empieza
+ * en 0. */
+EDACAL_API edacal_error_kind edacal_set(edacal_context* context, const char* name, double value);
+/* 1 y el valor en `value` si la variable esta definida, 0 si no. */
+EDACAL_API int edacal_get(const edacal_context* context, const char* name, double* value);
+
+/* Compila una expresion (sin asignacion) contra el contexto, con las mismas
+ * optimizaciones que el REPL. NULL si tiene un error de sintaxis, descripto
+ * en `error` si no es NULL. */
+EDACAL_API edacal_expr* edacal_compile(edacal_context* context, const char* text, edacal_error* error);
+EDACAL_API void edacal_expr_free(edacal_expr* expr);
+
+/* Liga la variable `name` de la expresion a `*value`, que se lee en cada
+ * edacal_eval; con `value` NULL vuelve a leerse de la tabla del contexto.
+ * Ligar un nombre que la expresion no usa no tiene efecto. */
+EDACAL_API edacal_error_kind edacal_bind(edacal_expr* expr, const char* name, const double* value);
+
+/* Evalua la expresion y deja el resultado en `result`. No cambia `ans` ni
+ * otras variables del contexto. */
+EDACAL_API edacal_error_kind edacal_eval(edacal_expr* expr, double* result, edacal_error* error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
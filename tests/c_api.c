@@ -0,0 +1,89 @@
+/*
+ * Prueba de la API C (include/edacal.h) desde un programa C enlazado contra
+ * libedacal.so: solo ve los simbolos exportados. No imprime nada si todo
+ * coincide; cada diferencia se reporta y el codigo de salida es 1.
+ */
+#include "edacal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void check(int condition, const char* what) {
+    if (!condition) {
+        printf("FALLA %s\n", what);
+        ++failures;
+    }
+}
+
+static void checkError(const edacal_error* error, edacal_error_kind kind, size_t column, const char* message,
+                       const char* what) {
+    if (error->kind != kind || error->column != column || strcmp(error->message, message) != 0) {
+        printf("FALLA %s: tipo %d, columna %lu, \"%s\"\n", what, (int)error->kind, (unsigned long)error->column,
+               error->message);
+        ++failures;
+    }
+}
+
+int main(void) {
+    edacal_context* context = edacal_context_new();
+    edacal_error error;
+    double value = 0.0;
+    double result = 0.0;
+    edacal_expr* expr;
+    edacal_expr* failing;
+
+    if (!context) {
+        printf("FALLA edacal_context_new\n");
+        return 1;
+    }
+
+    check(edacal_get(context, "ans", &value) == 1 && value == 0.0, "ans empieza en 0");
+    check(edacal_get(context, "x", &value) == 0, "x no definida");
+    check(edacal_set(context, "x", 3.0) == EDACAL_OK, "edacal_set");
+
+    expr = edacal_compile(context, "x ^ 2 + select(x > y, 1, 0)", &error);
+    check(expr != NULL && error.kind == EDACAL_OK, "edacal_compile");
+    if (expr) {
+        check(edacal_eval(expr, &result, &error) == EDACAL_ERROR_UNDEFINED_VARIABLE, "y sin definir");
+        checkError(&error, EDACAL_ERROR_UNDEFINED_VARIABLE, 19, "variable no definida: y", "y sin definir");
+
+        check(edacal_set(context, "y", 1.0) == EDACAL_OK, "edacal_set y");
+        check(edacal_eval(expr, &result, &error) == EDACAL_OK && result == 10.0, "valor desde la tabla");
+
+        value = 5.0;
+        check(edacal_bind(expr, "y", &value) == EDACAL_OK, "edacal_bind");
+        check(edacal_eval(expr, &result, &error) == EDACAL_OK && result == 9.0, "valor ligado");
+        value = -1.0;
+        check(edacal_eval(expr, &result, &error) == EDACAL_OK && result == 10.0, "valor ligado cambiado");
+        check(edacal_bind(expr, "y", NULL) == EDACAL_OK, "desligar");
+        check(edacal_eval(expr, &result, &error) == EDACAL_OK && result == 10.0, "valor tras desligar");
+        edacal_expr_free(expr);
+    }
+    check(edacal_get(context, "ans", &value) == 1 && value == 0.0, "edacal_eval no cambia ans");
+
+    failing = edacal_compile(context, "1 + (2 * x", &error);
+    check(failing == NULL, "error de sintaxis");
+    checkError(&error, EDACAL_ERROR_UNBALANCED_PARENS, 4, "parentesis desbalanceados", "error de sintaxis");
+
+    failing = edacal_compile(context, "x / (x - 3)", &error);
+    check(failing != NULL, "compilar division");
+    if (failing) {
+        check(edacal_eval(failing, &result, &error) == EDACAL_ERROR_DIVISION_BY_ZERO, "division por cero");
+        checkError(&error, EDACAL_ERROR_DIVISION_BY_ZERO, 2, "division por cero", "division por cero");
+        edacal_expr_free(failing);
+    }
+
+    failing = edacal_compile(context, "sum(i, 1, 10^15, i)", &error);
+    check(failing != NULL, "compilar sum");
+    if (failing) {
+        check(edacal_eval(failing, &result, &error) == EDACAL_ERROR_DOMAIN, "limite de iteraciones");
+        checkError(&error, EDACAL_ERROR_DOMAIN, 0, "sum excede el maximo de 10000000 iteraciones",
+                   "limite de iteraciones");
+        edacal_expr_free(failing);
+    }
+
+    edacal_context_free(context);
+    return failures ? 1 : 0;
+}